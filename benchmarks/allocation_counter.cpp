@@ -0,0 +1,66 @@
+#include "allocation_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+/// One per thread, never freed so the counts of exited threads are kept.
+struct ThreadCount {
+  std::atomic<uint64_t> count_ {0};
+  ThreadCount *next_ {nullptr};
+};
+
+std::atomic<ThreadCount *> gThreadCounts {nullptr};
+
+auto threadCount() noexcept -> ThreadCount & {
+  // Allocated with malloc, operator new would recurse into here.
+  thread_local ThreadCount *count = [] {
+    auto *created = new (std::malloc(sizeof(ThreadCount))) ThreadCount {};
+    created->next_ = gThreadCounts.load(std::memory_order::relaxed);
+    while (!gThreadCounts.compare_exchange_weak(created->next_, created, std::memory_order::release)) {}
+    return created;
+  }();
+  return *count;
+}
+
+auto allocate(std::size_t size, std::size_t alignment) -> void * {
+  auto &count = threadCount();
+  count.count_.store(count.count_.load(std::memory_order::relaxed) + 1, std::memory_order::relaxed);
+
+  size      = size == 0 ? 1 : size;
+  void *ptr = alignment <= alignof(std::max_align_t)
+                  ? std::malloc(size)
+                  : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+  if (ptr == nullptr) { throw std::bad_alloc {}; }
+  return ptr;
+}
+}  // namespace
+
+namespace coro::bench {
+auto allocations() noexcept -> uint64_t {
+  uint64_t total {0};
+  for (auto *count = gThreadCounts.load(std::memory_order::acquire); count != nullptr; count = count->next_) {
+    total += count->count_.load(std::memory_order::relaxed);
+  }
+  return total;
+}
+}  // namespace coro::bench
+
+auto operator new(std::size_t size) -> void * { return allocate(size, alignof(std::max_align_t)); }
+auto operator new[](std::size_t size) -> void * { return allocate(size, alignof(std::max_align_t)); }
+auto operator new(std::size_t size, std::align_val_t alignment) -> void * {
+  return allocate(size, static_cast<std::size_t>(alignment));
+}
+auto operator new[](std::size_t size, std::align_val_t alignment) -> void * {
+  return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+auto operator delete(void *ptr) noexcept -> void { std::free(ptr); }
+auto operator delete[](void *ptr) noexcept -> void { std::free(ptr); }
+auto operator delete(void *ptr, std::size_t) noexcept -> void { std::free(ptr); }
+auto operator delete[](void *ptr, std::size_t) noexcept -> void { std::free(ptr); }
+auto operator delete(void *ptr, std::align_val_t) noexcept -> void { std::free(ptr); }
+auto operator delete[](void *ptr, std::align_val_t) noexcept -> void { std::free(ptr); }
+auto operator delete(void *ptr, std::size_t, std::align_val_t) noexcept -> void { std::free(ptr); }
+auto operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept -> void { std::free(ptr); }
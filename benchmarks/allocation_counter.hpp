@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+namespace coro::bench {
+/**
+ * @return The number of global operator new calls so far, summed over all threads.  The coro_bench
+ *         executable replaces the global allocation functions to count them.
+ */
+auto allocations() noexcept -> uint64_t;
+
+/**
+ * Reports the allocations made between construction and destruction as the allocs/op counter.
+ *
+ * The count is process wide, so with several benchmark threads only the first one reports it and
+ * the counter covers the allocations of all of them.
+ */
+class AllocationCounter {
+public:
+  explicit AllocationCounter(benchmark::State &state) noexcept : state_(state), start_(allocations()) {}
+  AllocationCounter(const AllocationCounter &)                     = delete;
+  AllocationCounter(AllocationCounter &&)                          = delete;
+  auto operator=(const AllocationCounter &) -> AllocationCounter & = delete;
+  auto operator=(AllocationCounter &&) -> AllocationCounter &      = delete;
+  ~AllocationCounter() {
+    if (state_.thread_index() != 0) { return; }
+    state_.counters["allocs/op"] =
+        benchmark::Counter(static_cast<double>(allocations() - start_), benchmark::Counter::kAvgIterations);
+  }
+
+private:
+  benchmark::State &state_;
+  uint64_t start_;
+};
+}  // namespace coro::bench
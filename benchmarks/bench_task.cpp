@@ -0,0 +1,77 @@
+#include "allocation_counter.hpp"
+
+#include <coro/sync_wait.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/when_all.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+auto leaf(int value) -> coro::Task<int> { co_return value; }
+
+/**
+ * Creates, awaits and destroys one child task per iteration.
+ */
+auto awaitLeaves(benchmark::State &state) -> coro::Task<void> {
+  for (auto _ : state) {
+    auto value = co_await leaf(1);
+    benchmark::DoNotOptimize(value);
+  }
+}
+
+/**
+ * A complete tree of tasks, every inner node schedules its children onto the pool and joins them
+ * with when_all().
+ * @return The number of nodes in the tree.
+ */
+auto tree(coro::ThreadPool &tp, int64_t depth, int64_t width) -> coro::Task<uint64_t> {
+  co_await tp.schedule();
+  if (depth == 0) { co_return 1; }
+
+  std::vector<coro::Task<uint64_t>> children {};
+  children.reserve(static_cast<std::size_t>(width));
+  for (int64_t i = 0; i < width; ++i) { children.emplace_back(tree(tp, depth - 1, width)); }
+  auto counts = co_await coro::when_all(std::move(children));
+
+  uint64_t nodes {1};
+  for (auto count : counts) { nodes += count; }
+  co_return nodes;
+}
+}  // namespace
+
+static void BM_TaskCreateAwaitDestroy(benchmark::State &state) {
+  coro::bench::AllocationCounter allocations {state};
+  coro::sync_wait(awaitLeaves(state));
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TaskCreateAwaitDestroy);
+
+static void BM_TaskCreateDestroy(benchmark::State &state) {
+  coro::bench::AllocationCounter allocations {state};
+  for (auto _ : state) {
+    auto task = leaf(1);
+    benchmark::DoNotOptimize(task);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TaskCreateDestroy);
+
+/**
+ * Args: the depth of the tree, its width is 4.
+ */
+static void BM_FanOutFanIn(benchmark::State &state) {
+  auto tp = coro::ThreadPool::makeShared();
+  uint64_t nodes {0};
+  {
+    coro::bench::AllocationCounter allocations {state};
+    for (auto _ : state) { nodes = coro::sync_wait(tree(*tp, state.range(0), 4)); }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(nodes) * state.iterations());
+  state.counters["nodes"] = static_cast<double>(nodes);
+  tp->shutdown();
+}
+BENCHMARK(BM_FanOutFanIn)->DenseRange(1, 5, 2)->UseRealTime();
@@ -0,0 +1,198 @@
+#include "allocation_counter.hpp"
+
+#include <coro/channel.hpp>
+#include <coro/strand.hpp>
+#include <coro/sync_wait.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/when_all.hpp>
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+auto countDown(std::atomic<int64_t> &remaining) -> coro::Task<void> {
+  remaining.fetch_sub(1, std::memory_order::release);
+  co_return;
+}
+
+auto waitFor(const std::atomic<int64_t> &remaining) noexcept -> void {
+  while (remaining.load(std::memory_order::acquire) > 0) { std::this_thread::yield(); }
+}
+
+auto hop(coro::ThreadPool &tp) -> coro::Task<void> { co_await tp.schedule(); }
+
+auto yieldLoop(coro::ThreadPool &tp, int64_t count) -> coro::Task<void> {
+  co_await tp.schedule();
+  for (int64_t i = 0; i < count; ++i) { co_await tp.yield(); }
+}
+
+/**
+ * Sends count values to out and waits for each to come back on in.
+ */
+auto serve(coro::ThreadPool &tp, coro::Channel<int64_t> &out, coro::Channel<int64_t> &in, int64_t count)
+    -> coro::Task<void> {
+  co_await tp.schedule();
+  for (int64_t i = 0; i < count; ++i) {
+    co_await out.send(i);
+    co_await in.recv();
+  }
+}
+
+auto echo(coro::ThreadPool &tp, coro::Channel<int64_t> &in, coro::Channel<int64_t> &out, int64_t count)
+    -> coro::Task<void> {
+  co_await tp.schedule();
+  for (int64_t i = 0; i < count; ++i) { co_await out.send(*co_await in.recv()); }
+}
+
+auto strandHops(coro::ThreadPool &tp, coro::Strand &strand, int64_t count, std::atomic<int64_t> &remaining)
+    -> coro::Task<void> {
+  co_await tp.schedule();
+  for (int64_t i = 0; i < count; ++i) {
+    co_await strand.schedule();
+    co_await tp.schedule();
+  }
+  remaining.fetch_sub(1, std::memory_order::release);
+}
+
+/**
+ * Shared by the benchmark threads of BM_SpawnThroughput, outlives every run.
+ */
+auto spawnPool() -> coro::ThreadPool & {
+  static auto pool = coro::ThreadPool::makeShared();
+  return *pool;
+}
+}  // namespace
+
+/**
+ * From the benchmark thread onto an executor and back, through sync_wait().
+ */
+static void BM_ScheduleRoundTrip(benchmark::State &state) {
+  auto tp = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 1});
+  {
+    coro::bench::AllocationCounter allocations {state};
+    for (auto _ : state) { coro::sync_wait(hop(*tp)); }
+  }
+  state.SetItemsProcessed(state.iterations());
+  tp->shutdown();
+}
+BENCHMARK(BM_ScheduleRoundTrip)->UseRealTime();
+
+/**
+ * Every benchmark thread spawns tasks onto one shared pool and waits until its own ran.
+ */
+static void BM_SpawnThroughput(benchmark::State &state) {
+  auto &tp = spawnPool();
+  std::atomic<int64_t> remaining {0};
+  {
+    coro::bench::AllocationCounter allocations {state};
+    for (auto _ : state) {
+      remaining.fetch_add(1, std::memory_order::relaxed);
+      // The submission queue is bounded, a full one pushes back on the producers.
+      while (!tp.spawn(countDown(remaining))) { std::this_thread::yield(); }
+    }
+    waitFor(remaining);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SpawnThroughput)->ThreadRange(1, 8)->UseRealTime();
+
+/**
+ * Args: the number of handles resumed at once.  Creating the tasks is part of each iteration.
+ */
+static void BM_ResumeRange(benchmark::State &state) {
+  auto tp    = coro::ThreadPool::makeShared();
+  auto batch = state.range(0);
+  std::vector<coro::Task<void>> tasks {};
+  std::vector<std::coroutine_handle<>> handles {};
+  tasks.reserve(static_cast<std::size_t>(batch));
+  handles.reserve(static_cast<std::size_t>(batch));
+  {
+    coro::bench::AllocationCounter allocations {state};
+    std::atomic<int64_t> remaining {0};
+    for (auto _ : state) {
+      remaining.store(batch, std::memory_order::relaxed);
+      for (int64_t i = 0; i < batch; ++i) {
+        tasks.emplace_back(countDown(remaining));
+        handles.emplace_back(tasks.back().handle());
+      }
+      tp->resume(handles);
+      waitFor(remaining);
+      handles.clear();
+      tasks.clear();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+  tp->shutdown();
+}
+BENCHMARK(BM_ResumeRange)->RangeMultiplier(8)->Range(1, 4096)->UseRealTime();
+
+/**
+ * Two tasks on a single executor yielding to each other, an operation is one yield.
+ */
+static void BM_YieldPingPong(benchmark::State &state) {
+  constexpr int64_t batch = 10'000;
+  auto tp                 = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 1});
+  {
+    coro::bench::AllocationCounter allocations {state};
+    while (state.KeepRunningBatch(batch)) {
+      coro::sync_wait(coro::when_all(yieldLoop(*tp, batch / 2), yieldLoop(*tp, batch / 2)));
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  tp->shutdown();
+}
+BENCHMARK(BM_YieldPingPong)->UseRealTime();
+
+/**
+ * Args: Options::nextSlotBudget_.  Two tasks bouncing a value over a pair of channels on a pool of
+ * four, an operation is one round trip.  Each wakeup readies the peer from an executor.
+ */
+static void BM_ChannelPingPong(benchmark::State &state) {
+  constexpr int64_t batch = 10'000;
+  auto tp                 = coro::ThreadPool::makeShared(coro::ThreadPool::Options {
+                      .threadCount_ = 4, .nextSlotBudget_ = static_cast<uint32_t>(state.range(0))});
+  {
+    coro::bench::AllocationCounter allocations {state};
+    while (state.KeepRunningBatch(batch)) {
+      coro::Channel<int64_t> ping {*tp, 1};
+      coro::Channel<int64_t> pong {*tp, 1};
+      coro::sync_wait(coro::when_all(serve(*tp, ping, pong, batch), echo(*tp, ping, pong, batch)));
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  tp->shutdown();
+}
+BENCHMARK(BM_ChannelPingPong)->Arg(0)->Arg(3)->UseRealTime();
+
+/**
+ * Args: the strand's drain batch.  Sixteen tasks on a pool of four hop onto one strand and back
+ * off it, an operation is one hop onto the strand.
+ */
+static void BM_StrandSchedule(benchmark::State &state) {
+  constexpr int64_t taskCount = 16;
+  constexpr int64_t hopCount  = 1'000;
+  auto tp                     = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 4});
+  coro::Strand strand {*tp, static_cast<uint32_t>(state.range(0))};
+  std::vector<coro::Task<void>> tasks {};
+  {
+    coro::bench::AllocationCounter allocations {state};
+    std::atomic<int64_t> remaining {0};
+    while (state.KeepRunningBatch(taskCount * hopCount)) {
+      remaining.store(taskCount, std::memory_order::relaxed);
+      for (int64_t i = 0; i < taskCount; ++i) { tasks.emplace_back(strandHops(*tp, strand, hopCount, remaining)); }
+      for (auto &task : tasks) { task.resume(); }
+      waitFor(remaining);
+      tasks.clear();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  tp->shutdown();
+}
+BENCHMARK(BM_StrandSchedule)->Arg(1)->Arg(64)->UseRealTime();
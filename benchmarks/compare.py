@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Compares two coro_bench JSON recordings and flags regressions.
+
+Record with:
+    coro_bench --benchmark_out=baseline.json --benchmark_out_format=json
+
+Compare with:
+    compare.py baseline.json contender.json [--threshold 0.05] [--output diff.json]
+
+The diff is written as JSON, to stdout unless --output is given.  The exit status is 1 when a
+benchmark got slower by more than the threshold, or allocates more per operation than before.
+"""
+
+import argparse
+import json
+import sys
+
+NANOSECONDS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path):
+    """Returns {name: {"ns": time per op, "allocs": allocations per op or None}}.
+
+    With --benchmark_repetitions the mean aggregates are used, otherwise the single runs.
+    """
+    with open(path, encoding="utf-8") as f:
+        benchmarks = json.load(f)["benchmarks"]
+
+    has_means = any(b.get("aggregate_name") == "mean" for b in benchmarks)
+    results = {}
+    for b in benchmarks:
+        if b.get("error_occurred"):
+            continue
+        if has_means:
+            if b.get("aggregate_name") != "mean":
+                continue
+            name = b["run_name"]
+        else:
+            if b.get("run_type", "iteration") != "iteration":
+                continue
+            name = b["name"]
+        time = b["real_time"] if "real_time" in b.get("name", "") else b["cpu_time"]
+        results[name] = {
+            "ns": time * NANOSECONDS[b.get("time_unit", "ns")],
+            "allocs": b.get("allocs/op"),
+        }
+    return results
+
+
+def compare(baseline, contender, threshold):
+    rows = []
+    for name, base in baseline.items():
+        if name not in contender:
+            continue
+        cont = contender[name]
+        change = (cont["ns"] - base["ns"]) / base["ns"] if base["ns"] > 0 else 0.0
+        more_allocs = (
+            base["allocs"] is not None
+            and cont["allocs"] is not None
+            and cont["allocs"] > base["allocs"] + 1e-3
+        )
+        rows.append({
+            "name": name,
+            "baseline_ns": base["ns"],
+            "contender_ns": cont["ns"],
+            "change": change,
+            "baseline_allocs": base["allocs"],
+            "contender_allocs": cont["allocs"],
+            "regression": change > threshold or more_allocs,
+        })
+    return {
+        "threshold": threshold,
+        "benchmarks": rows,
+        "missing": sorted(set(baseline) - set(contender)),
+        "added": sorted(set(contender) - set(baseline)),
+        "regressions": [row["name"] for row in rows if row["regression"]],
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--threshold", type=float, default=0.05,
+                        help="relative slowdown tolerated before flagging a regression (default: 0.05)")
+    parser.add_argument("--output", help="write the diff to this file instead of stdout")
+    args = parser.parse_args()
+
+    diff = compare(load(args.baseline), load(args.contender), args.threshold)
+    text = json.dumps(diff, indent=2)
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            f.write(text + "\n")
+    else:
+        print(text)
+
+    for name in diff["regressions"]:
+        print(f"regression: {name}", file=sys.stderr)
+    return 1 if diff["regressions"] else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
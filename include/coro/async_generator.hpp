@@ -0,0 +1,180 @@
+#pragma once
+
+#include <concepts>
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <coro/task.hpp>
+
+namespace coro {
+template <typename yield_type>
+class AsyncGenerator;
+
+namespace detail {
+template <typename yield_type>
+class AsyncGeneratorPromise final : public PromiseBase {
+public:
+  using value_type     = std::remove_cvref_t<yield_type>;
+  using reference_type = std::conditional_t<std::is_reference_v<yield_type>, yield_type, yield_type &>;
+  using pointer_type   = std::add_pointer_t<reference_type>;
+
+  /**
+   * Suspends the generator at a co_yield and transfers to the consumer waiting for the value.
+   */
+  struct YieldOperation {
+    auto await_ready() const noexcept -> bool { return false; }
+    auto await_suspend(std::coroutine_handle<AsyncGeneratorPromise> coroutine) noexcept -> std::coroutine_handle<> {
+      return coroutine.promise().continuation_;
+    }
+    auto await_resume() const noexcept -> void {}
+  };
+
+  AsyncGeneratorPromise() noexcept = default;
+
+  auto get_return_object() noexcept -> AsyncGenerator<yield_type>;
+
+  /**
+   * Only stores the address of the value, a temporary lives until the generator is resumed.
+   */
+  auto yield_value(std::remove_reference_t<yield_type> &value) noexcept -> YieldOperation {
+    value_ = std::addressof(value);
+    return YieldOperation {};
+  }
+
+  auto yield_value(std::remove_reference_t<yield_type> &&value) noexcept -> YieldOperation {
+    value_ = std::addressof(value);
+    return YieldOperation {};
+  }
+
+  auto return_void() noexcept -> void {}
+
+  auto unhandled_exception() noexcept -> void { exception_ = std::current_exception(); }
+
+  auto value() const noexcept -> reference_type { return static_cast<reference_type>(*value_); }
+
+  auto rethrow_if_exception() -> void {
+    if (exception_) { std::rethrow_exception(std::exchange(exception_, nullptr)); }
+  }
+
+private:
+  pointer_type value_ {nullptr};
+  std::exception_ptr exception_ {nullptr};
+};
+}  // namespace detail
+
+/**
+ * A lazily evaluated sequence produced by a coroutine with co_yield that may co_await in between,
+ * consumed from another coroutine with
+ *
+ *   for (auto it = co_await generator.begin(); it != generator.end(); co_await ++it) { use(*it); }
+ *
+ * Awaiting begin() or an increment transfers to the generator, which transfers back once it
+ * yields the next value or completes, so neither side goes through a scheduler.  Values are
+ * yielded by reference like Generator's, the frame is allocated like a Task's and the generator
+ * inherits the consumer's stop token and deadline like an awaited Task does.  An exception
+ * escaping the coroutine is rethrown from the awaited begin() or increment that resumed it.
+ *
+ * @tparam yield_type The type yielded, iterating produces yield_type & unless it is a reference.
+ */
+template <typename yield_type>
+class [[nodiscard]] AsyncGenerator {
+public:
+  using promise_type     = detail::AsyncGeneratorPromise<yield_type>;
+  using coroutine_handle = std::coroutine_handle<promise_type>;
+
+  class Iterator;
+
+  /**
+    * The awaitable returned by begin() and the increment, resumes the generator up to its next
+    * co_yield.
+    */
+  class AdvanceOperation {
+  public:
+    explicit AdvanceOperation(coroutine_handle coroutine) noexcept : coroutine_(coroutine) {}
+
+    auto await_ready() const noexcept -> bool { return coroutine_ == nullptr || coroutine_.done(); }
+
+    template <typename awaiting_promise_type>
+    auto await_suspend(std::coroutine_handle<awaiting_promise_type> awaitingCoroutine) noexcept
+        -> std::coroutine_handle<> {
+      if constexpr (std::derived_from<awaiting_promise_type, detail::PromiseBase>) {
+        coroutine_.promise().inherit_cancellation(awaitingCoroutine.promise());
+      }
+      coroutine_.promise().continuation(awaitingCoroutine);
+      return coroutine_;
+    }
+
+    auto await_resume() -> Iterator {
+      if (coroutine_ != nullptr && coroutine_.done()) { coroutine_.promise().rethrow_if_exception(); }
+      return Iterator {coroutine_};
+    }
+
+  private:
+    coroutine_handle coroutine_;
+  };
+
+  class Iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using difference_type   = std::ptrdiff_t;
+    using value_type        = typename promise_type::value_type;
+    using reference         = typename promise_type::reference_type;
+    using pointer           = typename promise_type::pointer_type;
+
+    Iterator() noexcept = default;
+    explicit Iterator(coroutine_handle coroutine) noexcept : coroutine_(coroutine) {}
+
+    auto operator*() const noexcept -> reference { return coroutine_.promise().value(); }
+    auto operator->() const noexcept -> pointer { return std::addressof(coroutine_.promise().value()); }
+
+    /**
+      * Must be awaited, the iterator refers to the next value once it is.
+      */
+    [[nodiscard]] auto operator++() noexcept -> AdvanceOperation { return AdvanceOperation {coroutine_}; }
+
+    friend auto operator==(const Iterator &it, std::default_sentinel_t) noexcept -> bool {
+      return it.coroutine_ == nullptr || it.coroutine_.done();
+    }
+
+  private:
+    coroutine_handle coroutine_ {nullptr};
+  };
+
+  AsyncGenerator() noexcept = default;
+  explicit AsyncGenerator(coroutine_handle coroutine) noexcept : coroutine_(coroutine) {}
+  AsyncGenerator(const AsyncGenerator &) = delete;
+  AsyncGenerator(AsyncGenerator &&other) noexcept : coroutine_(std::exchange(other.coroutine_, nullptr)) {}
+  auto operator=(const AsyncGenerator &) -> AsyncGenerator & = delete;
+  auto operator=(AsyncGenerator &&other) noexcept -> AsyncGenerator & {
+    if (std::addressof(other) != this) {
+      if (coroutine_ != nullptr) { coroutine_.destroy(); }
+      coroutine_ = std::exchange(other.coroutine_, nullptr);
+    }
+    return *this;
+  }
+  ~AsyncGenerator() {
+    if (coroutine_ != nullptr) { coroutine_.destroy(); }
+  }
+
+  /**
+    * Must be awaited, runs the coroutine up to its first co_yield.
+    */
+  [[nodiscard]] auto begin() noexcept -> AdvanceOperation { return AdvanceOperation {coroutine_}; }
+
+  auto end() const noexcept -> std::default_sentinel_t { return std::default_sentinel; }
+
+private:
+  coroutine_handle coroutine_ {nullptr};
+};
+
+namespace detail {
+template <typename yield_type>
+inline auto AsyncGeneratorPromise<yield_type>::get_return_object() noexcept -> AsyncGenerator<yield_type> {
+  return AsyncGenerator<yield_type> {std::coroutine_handle<AsyncGeneratorPromise>::from_promise(*this)};
+}
+}  // namespace detail
+}  // namespace coro
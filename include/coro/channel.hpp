@@ -0,0 +1,417 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <coro/thread_pool.hpp>
+#include <coro/detail/waiter_list.hpp>
+
+namespace coro {
+/**
+ * A bounded multi-producer multi-consumer channel passing values between coroutines, e.g. the
+ * stages of a pipeline.  Sending to a full channel suspends the sender until a receiver made room
+ * and receiving from an empty one suspends the receiver until a value arrives, so a fast producer
+ * can never run ahead of its consumers by more than the capacity.
+ *
+ * The values live in a fixed ring buffer of cells that carry a sequence number each, Dmitry
+ * Vyukov's design like detail::BoundedMpmcQueue, so sending and receiving without waiting is
+ * lock-free and costs a single CAS on the shared position.  The send and receive positions live
+ * on their own cache lines.  Only coroutines that have to wait take an internal lock to queue
+ * their awaiter, the other side hands them a value or a free cell under that lock before they are
+ * resumed, in one ThreadPool::resume() batch when a thread pool is given at construction or
+ * inline otherwise.
+ *
+ * After close() sends fail, receivers still get the values that are buffered and then nullopt.
+ *
+ * @tparam value_type Must be nothrow move constructible, it is moved into a cell once reserved.
+ */
+template <typename value_type>
+  requires std::is_nothrow_move_constructible_v<value_type>
+class Channel {
+public:
+  /**
+    * The awaitable returned by send(), it produces false if the channel was closed and the value
+    * dropped.
+    */
+  class SendOperation : private detail::Waiter {
+    friend class Channel;
+
+  public:
+    SendOperation(Channel &channel, value_type &&value) noexcept
+        : channel_(channel), value_(std::move(value)) {}
+
+    auto await_ready() noexcept -> bool {
+      if (channel_.is_closed()) { return true; }
+      sent_ = channel_.try_send(std::move(value_));
+      return sent_;
+    }
+    auto await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool {
+      awaitingCoroutine_ = awaitingCoroutine;
+      return channel_.suspend(*this);
+    }
+    auto await_resume() const noexcept -> bool { return sent_; }
+
+  private:
+    Channel &channel_;
+    value_type value_;
+    bool sent_ {false};
+  };
+
+  /**
+    * The awaitable returned by recv(), it produces nullopt once the channel is closed and empty.
+    */
+  class RecvOperation : private detail::Waiter {
+    friend class Channel;
+
+  public:
+    explicit RecvOperation(Channel &channel) noexcept : channel_(channel) {}
+
+    auto await_ready() noexcept -> bool {
+      value_ = channel_.try_recv();
+      return value_.has_value();
+    }
+    auto await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool {
+      awaitingCoroutine_ = awaitingCoroutine;
+      return channel_.suspend(*this);
+    }
+    auto await_resume() noexcept -> std::optional<value_type> { return std::move(value_); }
+
+  private:
+    Channel &channel_;
+    std::optional<value_type> value_ {};
+  };
+
+  /**
+    * @param capacity The maximum number of buffered values, rounded up to the next power of two.
+    */
+  explicit Channel(std::size_t capacity)
+      : mask_(std::bit_ceil(capacity < 2 ? std::size_t {2} : capacity) - 1)
+      , buffer_(std::make_unique<Cell[]>(mask_ + 1)) {
+    for (std::size_t i = 0; i <= mask_; ++i) { buffer_[i].sequence_.store(i, std::memory_order::relaxed); }
+  }
+
+  /**
+    * @param threadPool Resumes the coroutines that waited, it must outlive the channel.
+    */
+  Channel(ThreadPool &threadPool, std::size_t capacity) : Channel(capacity) { threadPool_ = &threadPool; }
+  Channel(const Channel &)                     = delete;
+  Channel(Channel &&)                          = delete;
+  auto operator=(const Channel &) -> Channel & = delete;
+  auto operator=(Channel &&) -> Channel &      = delete;
+  ~Channel() {
+    std::optional<value_type> value {};
+    while (pop(value)) { value.reset(); }
+  }
+
+  /**
+    * Suspends the awaiting coroutine until the value is buffered or handed to a receiver.
+    */
+  [[nodiscard]] auto send(value_type value) noexcept -> SendOperation {
+    return SendOperation {*this, std::move(value)};
+  }
+
+  /**
+    * Suspends the awaiting coroutine until a value is available or the channel is closed.
+    */
+  [[nodiscard]] auto recv() noexcept -> RecvOperation { return RecvOperation {*this}; }
+
+  /**
+    * @return False if the channel is full or closed, the value is not moved from.
+    */
+  auto try_send(value_type &&value) noexcept -> bool {
+    if (is_closed() || !push(value)) { return false; }
+    notify(receiversWaiting_);
+    return true;
+  }
+
+  auto try_send(const value_type &value) -> bool { return try_send(value_type {value}); }
+
+  /**
+    * Sends a prefix of values, reserving all the cells it takes with a single CAS.
+    * @return The number of values sent and moved from, limited by the free capacity.
+    */
+  auto try_send_n(std::span<value_type> values) noexcept -> std::size_t {
+    if (values.empty() || is_closed()) { return 0; }
+
+    auto pos = enqueuePos_.load(std::memory_order::relaxed);
+    std::size_t reserved {0};
+    do {
+      // A stale receive position only underestimates the free cells.
+      auto dequeued = dequeuePos_.load(std::memory_order::acquire);
+      auto used     = pos > dequeued ? pos - dequeued : 0;
+      reserved      = used >= mask_ + 1 ? 0 : std::min(values.size(), mask_ + 1 - used);
+      if (reserved == 0) { return 0; }
+    } while (!enqueuePos_.compare_exchange_weak(pos, pos + reserved, std::memory_order::relaxed));
+
+    for (std::size_t i = 0; i < reserved; ++i) {
+      auto &cell = buffer_[(pos + i) & mask_];
+      // Every reserved cell has been claimed by a receiver, one may still be moving its value out.
+      while (cell.sequence_.load(std::memory_order::acquire) != pos + i) { std::this_thread::yield(); }
+      std::construct_at(cell.value(), std::move(values[i]));
+      cell.sequence_.store(pos + i + 1, std::memory_order::release);
+    }
+    notify(receiversWaiting_);
+    return reserved;
+  }
+
+  /**
+    * @return The oldest buffered value, nullopt if the channel is empty.
+    */
+  auto try_recv() noexcept -> std::optional<value_type> {
+    std::optional<value_type> value {};
+    if (pop(value)) { notify(sendersWaiting_); }
+    return value;
+  }
+
+  /**
+    * Receives up to values.size() values, reserving all the cells it takes with a single CAS.
+    * @return The number of values moved into the front of values.
+    */
+  auto try_recv_n(std::span<value_type> values) noexcept -> std::size_t {
+    if (values.empty()) { return 0; }
+
+    auto pos = dequeuePos_.load(std::memory_order::relaxed);
+    std::size_t reserved {0};
+    do {
+      auto enqueued = enqueuePos_.load(std::memory_order::acquire);
+      reserved      = enqueued > pos ? std::min(values.size(), enqueued - pos) : 0;
+      if (reserved == 0) { return 0; }
+    } while (!dequeuePos_.compare_exchange_weak(pos, pos + reserved, std::memory_order::relaxed));
+
+    for (std::size_t i = 0; i < reserved; ++i) {
+      auto &cell = buffer_[(pos + i) & mask_];
+      // Every reserved cell has been claimed by a sender, one may still be moving its value in.
+      while (cell.sequence_.load(std::memory_order::acquire) != pos + i + 1) { std::this_thread::yield(); }
+      values[i] = std::move(*cell.value());
+      std::destroy_at(cell.value());
+      cell.sequence_.store(pos + i + mask_ + 1, std::memory_order::release);
+    }
+    notify(sendersWaiting_);
+    return reserved;
+  }
+
+  /**
+    * Closes the channel, waiting senders fail and waiting receivers get nullopt once the buffered
+    * values are drained.  Does nothing if the channel is already closed.
+    */
+  auto close() noexcept -> void {
+    std::unique_lock lk {waitMutex_};
+    closed_.store(true, std::memory_order::release);
+    wake(lk);
+  }
+
+  [[nodiscard]] auto is_closed() const noexcept -> bool { return closed_.load(std::memory_order::acquire); }
+
+  /**
+    * @return An approximation of the number of buffered values.
+    */
+  [[nodiscard]] auto size() const noexcept -> std::size_t {
+    auto enqueued = enqueuePos_.load(std::memory_order::relaxed);
+    auto dequeued = dequeuePos_.load(std::memory_order::relaxed);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+  }
+
+  [[nodiscard]] auto empty() const noexcept -> bool { return size() == 0; }
+
+  [[nodiscard]] auto capacity() const noexcept -> std::size_t { return mask_ + 1; }
+
+private:
+  static constexpr std::size_t cacheLine_ = 64;
+
+  struct Cell {
+    std::atomic<std::size_t> sequence_;
+    alignas(value_type) std::byte storage_[sizeof(value_type)];
+
+    auto value() noexcept -> value_type * { return std::launder(reinterpret_cast<value_type *>(storage_)); }
+  };
+
+  alignas(cacheLine_) std::atomic<std::size_t> enqueuePos_ {0};
+  alignas(cacheLine_) std::atomic<std::size_t> dequeuePos_ {0};
+  alignas(cacheLine_) std::size_t mask_;
+  std::unique_ptr<Cell[]> buffer_;
+  ThreadPool *threadPool_ {nullptr};
+  std::atomic<bool> closed_ {false};
+
+  /// Guards the waiter queues, never held while a coroutine runs.
+  std::mutex waitMutex_;
+  /// The lengths of the queues, read without the lock after sending or receiving.
+  std::atomic<std::size_t> sendersWaiting_ {0};
+  std::atomic<std::size_t> receiversWaiting_ {0};
+  detail::Waiter *senders_ {nullptr};
+  detail::Waiter *sendersTail_ {nullptr};
+  detail::Waiter *receivers_ {nullptr};
+  detail::Waiter *receiversTail_ {nullptr};
+
+  /**
+    * Moves the value into a cell, it is not moved from if the channel is full.
+    */
+  auto push(value_type &value) noexcept -> bool {
+    auto pos = enqueuePos_.load(std::memory_order::relaxed);
+    Cell *cell;
+    while (true) {
+      cell      = &buffer_[pos & mask_];
+      auto seq  = cell->sequence_.load(std::memory_order::acquire);
+      auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order::relaxed)) { break; }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueuePos_.load(std::memory_order::relaxed);
+      }
+    }
+
+    std::construct_at(cell->value(), std::move(value));
+    cell->sequence_.store(pos + 1, std::memory_order::release);
+    return true;
+  }
+
+  /**
+    * Moves the oldest value into value, it is untouched if the channel is empty.
+    */
+  auto pop(std::optional<value_type> &value) noexcept -> bool {
+    auto pos = dequeuePos_.load(std::memory_order::relaxed);
+    Cell *cell;
+    while (true) {
+      cell      = &buffer_[pos & mask_];
+      auto seq  = cell->sequence_.load(std::memory_order::acquire);
+      auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order::relaxed)) { break; }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeuePos_.load(std::memory_order::relaxed);
+      }
+    }
+
+    value.emplace(std::move(*cell->value()));
+    std::destroy_at(cell->value());
+    cell->sequence_.store(pos + mask_ + 1, std::memory_order::release);
+    return true;
+  }
+
+  /**
+    * Called after sending or receiving, serves the other side's waiters if there are any.
+    */
+  auto notify(std::atomic<std::size_t> &waiting) noexcept -> void {
+    // Pairs with the fence in suspend(), either the waiter sees the cell or this sees the waiter.
+    std::atomic_thread_fence(std::memory_order::seq_cst);
+    if (waiting.load(std::memory_order::relaxed) == 0) { return; }
+
+    std::unique_lock lk {waitMutex_};
+    wake(lk);
+  }
+
+  /**
+    * Queues a sender once the channel is still full under the lock.
+    * @return False if it does not need to suspend.
+    */
+  auto suspend(SendOperation &op) noexcept -> bool {
+    std::unique_lock lk {waitMutex_};
+    sendersWaiting_.fetch_add(1, std::memory_order::relaxed);
+    std::atomic_thread_fence(std::memory_order::seq_cst);
+    if (is_closed()) {
+      sendersWaiting_.fetch_sub(1, std::memory_order::relaxed);
+      return false;
+    }
+    if (push(op.value_)) {
+      sendersWaiting_.fetch_sub(1, std::memory_order::relaxed);
+      op.sent_ = true;
+      wake(lk);
+      return false;
+    }
+
+    enqueue(senders_, sendersTail_, op);
+    return true;
+  }
+
+  /**
+    * Queues a receiver once the channel is still empty under the lock.
+    * @return False if it does not need to suspend.
+    */
+  auto suspend(RecvOperation &op) noexcept -> bool {
+    std::unique_lock lk {waitMutex_};
+    receiversWaiting_.fetch_add(1, std::memory_order::relaxed);
+    std::atomic_thread_fence(std::memory_order::seq_cst);
+    if (pop(op.value_)) {
+      receiversWaiting_.fetch_sub(1, std::memory_order::relaxed);
+      wake(lk);
+      return false;
+    }
+    if (is_closed()) {
+      receiversWaiting_.fetch_sub(1, std::memory_order::relaxed);
+      return false;
+    }
+
+    enqueue(receivers_, receiversTail_, op);
+    return true;
+  }
+
+  static auto enqueue(detail::Waiter *&head, detail::Waiter *&tail, detail::Waiter &waiter) noexcept -> void {
+    waiter.next_ = nullptr;
+    if (tail != nullptr) {
+      tail->next_ = &waiter;
+    } else {
+      head = &waiter;
+    }
+    tail = &waiter;
+  }
+
+  static auto dequeue(detail::Waiter *&head, detail::Waiter *&tail) noexcept -> detail::Waiter * {
+    auto *waiter = head;
+    head         = waiter->next_;
+    if (head == nullptr) { tail = nullptr; }
+    waiter->next_ = nullptr;
+    return waiter;
+  }
+
+  /**
+    * Hands values to the queued receivers and free cells to the queued senders for as long as
+    * either side makes progress, fails them all once closed and resumes the served ones after
+    * releasing the lock held by lk.
+    */
+  auto wake(std::unique_lock<std::mutex> &lk) noexcept -> void {
+    detail::Waiter *served {nullptr};
+    detail::Waiter *servedTail {nullptr};
+    auto serve = [&](detail::Waiter *&head, detail::Waiter *&tail, std::atomic<std::size_t> &waiting) {
+      waiting.fetch_sub(1, std::memory_order::relaxed);
+      enqueue(served, servedTail, *dequeue(head, tail));
+    };
+
+    auto progress = true;
+    while (progress) {
+      progress = false;
+      while (receivers_ != nullptr && pop(static_cast<RecvOperation *>(receivers_)->value_)) {
+        serve(receivers_, receiversTail_, receiversWaiting_);
+        progress = true;
+      }
+      while (senders_ != nullptr && !is_closed() && push(static_cast<SendOperation *>(senders_)->value_)) {
+        static_cast<SendOperation *>(senders_)->sent_ = true;
+        serve(senders_, sendersTail_, sendersWaiting_);
+        progress = true;
+      }
+    }
+
+    if (is_closed()) {
+      while (receivers_ != nullptr) { serve(receivers_, receiversTail_, receiversWaiting_); }
+      while (senders_ != nullptr) { serve(senders_, sendersTail_, sendersWaiting_); }
+    }
+
+    // The channel may be gone once a served coroutine resumed.
+    auto *threadPool = threadPool_;
+    lk.unlock();
+    detail::resumeWaiters(threadPool, served);
+  }
+};
+}  // namespace coro
@@ -12,4 +12,57 @@ namespace coro::concepts {
 
 template <typename type, typename... types>
 concept in_types = (std::same_as<type, types> || ...);
+
+/**
+ * Concept to require that the type can be used directly as the operand of co_await.
+ */
+template <typename type>
+concept awaiter = requires(type t, std::coroutine_handle<> c) {
+  { t.await_ready() } -> std::same_as<bool>;
+  requires in_types<decltype(t.await_suspend(c)), void, bool, std::coroutine_handle<>>;
+  { t.await_resume() };
+};
+
+/**
+ * Concept to require that the type provides a member operator co_await() returning an awaiter.
+ */
+template <typename type>
+concept member_co_await_awaitable = requires(type &&t) {
+  { static_cast<type &&>(t).operator co_await() } -> awaiter;
+};
+
+/**
+ * Concept to require that the type provides a free operator co_await() returning an awaiter.
+ */
+template <typename type>
+concept global_co_await_awaitable = requires(type &&t) {
+  { operator co_await(static_cast<type &&>(t)) } -> awaiter;
+};
+
+/**
+ * Concept to require that the type can be co_await'ed without an await_transform().
+ */
+template <typename type>
+concept awaitable = member_co_await_awaitable<type> || global_co_await_awaitable<type> || awaiter<type>;
+
+/**
+ * @return The awaiter co_await would use for value.
+ */
+template <awaitable type>
+auto get_awaiter(type &&value) -> decltype(auto) {
+  if constexpr (member_co_await_awaitable<type>) {
+    return static_cast<type &&>(value).operator co_await();
+  } else if constexpr (global_co_await_awaitable<type>) {
+    return operator co_await(static_cast<type &&>(value));
+  } else {
+    return static_cast<type &&>(value);
+  }
 }
+
+template <awaitable type>
+struct awaitable_traits {
+  using awaiter_type        = decltype(get_awaiter(std::declval<type>()));
+  using awaiter_return_type = decltype(std::declval<awaiter_type &>().await_resume());
+};
+
+}  // namespace coro::concepts
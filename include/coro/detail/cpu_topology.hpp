@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace coro::detail {
+/**
+ * The NUMA nodes of the machine with the cpus of each that the process may run on.
+ */
+struct CpuTopology {
+  /// The usable cpus of every node that has at least one, in node order.
+  std::vector<std::vector<uint32_t>> nodes_;
+
+  /**
+   * Reads /sys/devices/system/node restricted to the calling thread's affinity mask.  Machines
+   * without NUMA information, or platforms other than Linux, are reported as a single node.
+   */
+  static auto detect() -> CpuTopology;
+
+  /**
+   * Parses a sysfs cpu list, e.g. "0-3,8,10-11".  Malformed entries and entries reaching beyond
+   * CPU_SETSIZE are skipped.
+   */
+  static auto parseCpuList(std::string_view list) -> std::vector<uint32_t>;
+
+  /**
+   * @return The index of the first node containing cpu, nodes_.size() if there is none.
+   */
+  auto nodeOf(uint32_t cpu) const noexcept -> std::size_t;
+};
+
+/**
+ * Pins the calling thread to a single cpu.
+ * @return False if the platform does not support it or the cpu is not available to the process.
+ */
+auto pinCurrentThread(uint32_t cpu) noexcept -> bool;
+
+/**
+ * @return The cpu the calling thread is currently running on, -1 if unknown.
+ */
+auto currentCpu() noexcept -> int;
+}  // namespace coro::detail
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace coro::detail {
+/**
+ * Process wide counters of the RecyclingFrameAllocator, aggregated over all threads.
+ */
+struct FrameAllocatorStats {
+  /// The number of frames allocated.
+  uint64_t allocations_ {0};
+  /// The number of allocations served from a free list instead of the global heap.
+  uint64_t recycled_ {0};
+  /// The number of frames freed on a thread other than the one that allocated them.
+  uint64_t remoteFrees_ {0};
+  /// The bytes currently held in free lists, including remotely freed frames not yet reclaimed.
+  std::size_t bytesRetained_ {0};
+
+  /**
+   * @return The share of allocations served from a free list, 0 if nothing was allocated yet.
+   */
+  auto hitRate() const noexcept -> double {
+    return allocations_ == 0 ? 0.0 : static_cast<double>(recycled_) / static_cast<double>(allocations_);
+  }
+};
+
+/**
+ * Coroutine frame allocator with per-thread size-class free lists.
+ *
+ * Frames up to maxRecycledSize_ bytes are rounded up to a multiple of sizeClassGranularity_ and
+ * kept in a free list of the allocating thread when released.  A frame released on another thread
+ * is pushed onto a lock-free list of its owning thread and reclaimed by the owner the next time
+ * it misses its local free list, so no thread ever touches another thread's free lists.  Each free
+ * list keeps at most maxCachedPerClass_ frames, the rest goes back to the global heap.
+ *
+ * Used by detail::PromiseBase and detail::PromiseSelfDeleting when CORO_RECYCLE_FRAMES is defined.
+ */
+class RecyclingFrameAllocator {
+public:
+  static constexpr std::size_t sizeClassGranularity_ = 64;
+  static constexpr std::size_t maxRecycledSize_      = 2048;
+  static constexpr std::size_t maxCachedPerClass_    = 1024;
+
+  /**
+   * @return Storage for a coroutine frame of the given size, aligned to __STDCPP_DEFAULT_NEW_ALIGNMENT__.
+   * @throw std::bad_alloc If the global heap is exhausted.
+   */
+  static auto allocate(std::size_t size) -> void *;
+
+  /**
+   * Releases a frame returned by allocate(), may be called from any thread.
+   */
+  static auto deallocate(void *ptr, std::size_t size) noexcept -> void;
+
+  /**
+   * Aggregates the counters of all threads without synchronizing with them, the result is a
+   * consistent enough snapshot for monitoring.
+   */
+  static auto stats() noexcept -> FrameAllocatorStats;
+};
+}  // namespace coro::detail
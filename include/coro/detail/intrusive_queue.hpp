@@ -0,0 +1,78 @@
+#pragma once
+
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+
+namespace coro::detail {
+/**
+ * Concept to require a type that can link itself into an IntrusiveQueue.
+ */
+template <typename node_type>
+concept intrusive_node = requires(node_type node) {
+  { node.next_ } -> std::same_as<node_type *&>;
+};
+
+/**
+ * A ready coroutine embedded in storage that lives as long as it is suspended, e.g. its awaiter.
+ */
+struct ReadyNode {
+  ReadyNode *next_ {nullptr};
+  std::coroutine_handle<> handle_ {nullptr};
+#if defined(CORO_THREAD_POOL_METRICS)
+  /// When the coroutine was queued, see ThreadPool::metrics().
+  uint64_t enqueuedNs_ {0};
+#endif
+};
+
+/**
+ * Singly linked FIFO queue threaded through the nodes themselves, pushing and popping never
+ * allocates.  The nodes are not owned, each must stay alive and must not be moved while queued.
+ * Not thread safe, the user guards it.
+ */
+template <intrusive_node node_type>
+class IntrusiveQueue {
+public:
+  IntrusiveQueue() noexcept                                  = default;
+  IntrusiveQueue(const IntrusiveQueue &)                     = delete;
+  IntrusiveQueue(IntrusiveQueue &&)                          = delete;
+  auto operator=(const IntrusiveQueue &) -> IntrusiveQueue & = delete;
+  auto operator=(IntrusiveQueue &&) -> IntrusiveQueue &      = delete;
+  ~IntrusiveQueue()                                          = default;
+
+  auto push_back(node_type &node) noexcept -> void {
+    node.next_ = nullptr;
+    if (tail_ == nullptr) {
+      head_ = &node;
+    } else {
+      tail_->next_ = &node;
+    }
+    tail_ = &node;
+    ++size_;
+  }
+
+  /**
+   * @return The oldest node, nullptr if the queue is empty.
+   */
+  auto pop_front() noexcept -> node_type * {
+    auto *node = head_;
+    if (node == nullptr) { return nullptr; }
+
+    head_ = node->next_;
+    if (head_ == nullptr) { tail_ = nullptr; }
+    node->next_ = nullptr;
+    --size_;
+    return node;
+  }
+
+  auto empty() const noexcept -> bool { return head_ == nullptr; }
+
+  auto size() const noexcept -> std::size_t { return size_; }
+
+private:
+  node_type *head_ {nullptr};
+  node_type *tail_ {nullptr};
+  std::size_t size_ {0};
+};
+}  // namespace coro::detail
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+struct io_uring_sqe;
+
+namespace coro::detail {
+/**
+ * Minimal io_uring instance driven through the raw syscalls, Linux only.
+ *
+ * Not thread safe: the submission side (get_sqe(), submit()) and the completion side (reap())
+ * must each be guarded by the user.  Prepared entries are only handed to the kernel by submit(),
+ * so any number of them goes out with a single io_uring_enter().
+ */
+class IoUring {
+public:
+  /// A harvested completion queue entry.
+  struct Completion {
+    uint64_t userData_;
+    int32_t result_;
+  };
+
+  /**
+   * @param entries The submission queue size, rounded up to a power of two by the kernel.
+   * @return nullptr if the kernel lacks io_uring or it is disabled, errno tells why.
+   */
+  static auto create(uint32_t entries) -> std::unique_ptr<IoUring>;
+
+  IoUring(const IoUring &)                     = delete;
+  IoUring(IoUring &&)                          = delete;
+  auto operator=(const IoUring &) -> IoUring & = delete;
+  auto operator=(IoUring &&) -> IoUring &      = delete;
+  ~IoUring();
+
+  /**
+   * @return The ring's fd, readable while completions are waiting to be reaped.
+   */
+  auto fd() const noexcept -> int { return fd_; }
+
+  /**
+   * @return A zeroed submission queue entry, nullptr if the submission queue is full.
+   */
+  auto get_sqe() noexcept -> io_uring_sqe *;
+
+  /**
+   * @return The number of prepared entries the kernel has not consumed yet.
+   */
+  auto unsubmitted() const noexcept -> uint32_t;
+
+  /**
+   * Hands every prepared entry to the kernel.
+   * @param waitFor Blocks until at least this many completions are available.
+   * @return The number of entries consumed, or a negated errno value.
+   */
+  auto submit(uint32_t waitFor = 0) noexcept -> int;
+
+  /**
+   * Moves up to completions.size() completions out of the completion queue.
+   * @return The number of completions written.
+   */
+  auto reap(std::span<Completion> completions) noexcept -> std::size_t;
+
+  /**
+   * Registers buffers for the *_FIXED operations, replaces any previously registered ones.
+   * @return 0 or a negated errno value.
+   */
+  auto register_buffers(std::span<const std::span<std::byte>> buffers) noexcept -> int;
+
+  /**
+   * Registers files for IOSQE_FIXED_FILE, replaces any previously registered ones.
+   * @return 0 or a negated errno value.
+   */
+  auto register_files(std::span<const int> fds) noexcept -> int;
+
+private:
+  IoUring() = default;
+
+  int fd_ {-1};
+  uint32_t entries_ {0};
+  /// The tail of the prepared entries, published to the kernel by submit().
+  uint32_t sqTail_ {0};
+  bool buffersRegistered_ {false};
+  bool filesRegistered_ {false};
+
+  void *sqRing_ {nullptr};
+  std::size_t sqRingSize_ {0};
+  void *cqRing_ {nullptr};
+  std::size_t cqRingSize_ {0};
+  io_uring_sqe *sqes_ {nullptr};
+  std::size_t sqesSize_ {0};
+
+  uint32_t *sqHead_ {nullptr};
+  uint32_t *sqTailShared_ {nullptr};
+  uint32_t *sqFlags_ {nullptr};
+  uint32_t sqMask_ {0};
+  uint32_t *sqArray_ {nullptr};
+  uint32_t *cqHead_ {nullptr};
+  uint32_t *cqTail_ {nullptr};
+  uint32_t cqMask_ {0};
+  void *cqes_ {nullptr};
+};
+}  // namespace coro::detail
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+namespace coro::detail {
+/**
+ * Bounded lock-free multi-producer multi-consumer FIFO queue, Dmitry Vyukov's design.
+ *
+ * Every cell carries a sequence number that tells producers and consumers whether the cell is
+ * free for the current lap, so a push or pop costs a single CAS on the shared position plus
+ * one release store on the cell.  The producer and consumer positions live on their own cache
+ * lines so producers and consumers do not false share.
+ *
+ * @tparam value_type Must be trivially copyable, the cells are reused without destruction.
+ */
+template <typename value_type>
+  requires std::is_trivially_copyable_v<value_type>
+class BoundedMpmcQueue {
+public:
+  /**
+   * @param capacity The maximum number of elements, rounded up to the next power of two.
+   */
+  explicit BoundedMpmcQueue(std::size_t capacity)
+      : mask_(std::bit_ceil(capacity < 2 ? std::size_t {2} : capacity) - 1)
+      , buffer_(std::make_unique<Cell[]>(mask_ + 1)) {
+    for (std::size_t i = 0; i <= mask_; ++i) { buffer_[i].sequence_.store(i, std::memory_order::relaxed); }
+  }
+
+  BoundedMpmcQueue(const BoundedMpmcQueue &)                     = delete;
+  BoundedMpmcQueue(BoundedMpmcQueue &&)                          = delete;
+  auto operator=(const BoundedMpmcQueue &) -> BoundedMpmcQueue & = delete;
+  auto operator=(BoundedMpmcQueue &&) -> BoundedMpmcQueue &      = delete;
+  ~BoundedMpmcQueue()                                            = default;
+
+  /**
+   * @return False if the queue is full, the value was not pushed.
+   */
+  auto try_push(const value_type &value) noexcept -> bool {
+    auto pos = enqueuePos_.load(std::memory_order::relaxed);
+    Cell *cell;
+    while (true) {
+      cell      = &buffer_[pos & mask_];
+      auto seq  = cell->sequence_.load(std::memory_order::acquire);
+      auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order::relaxed)) { break; }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueuePos_.load(std::memory_order::relaxed);
+      }
+    }
+
+    cell->value_ = value;
+    cell->sequence_.store(pos + 1, std::memory_order::release);
+    return true;
+  }
+
+  /**
+   * Pushes a batch with a single CAS reserving consecutive cells, instead of one per value.
+   * @return The number of values pushed, a prefix of values limited by the free capacity.
+   */
+  auto try_push_bulk(const value_type *values, std::size_t count) noexcept -> std::size_t {
+    if (count == 0) { return 0; }
+
+    auto pos = enqueuePos_.load(std::memory_order::relaxed);
+    std::size_t reserved {0};
+    do {
+      // A stale dequeue position only underestimates the free cells.
+      auto dequeued = dequeuePos_.load(std::memory_order::acquire);
+      auto used     = pos > dequeued ? pos - dequeued : 0;
+      reserved      = used >= mask_ + 1 ? 0 : std::min(count, mask_ + 1 - used);
+      if (reserved == 0) { return 0; }
+    } while (!enqueuePos_.compare_exchange_weak(pos, pos + reserved, std::memory_order::relaxed));
+
+    for (std::size_t i = 0; i < reserved; ++i) {
+      auto &cell = buffer_[(pos + i) & mask_];
+      // Every reserved cell has been claimed by a consumer, one may still be copying its value out.
+      while (cell.sequence_.load(std::memory_order::acquire) != pos + i) { std::this_thread::yield(); }
+      cell.value_ = values[i];
+      cell.sequence_.store(pos + i + 1, std::memory_order::release);
+    }
+    return reserved;
+  }
+
+  /**
+   * @return False if the queue is empty, value is untouched.
+   */
+  auto try_pop(value_type &value) noexcept -> bool {
+    auto pos = dequeuePos_.load(std::memory_order::relaxed);
+    Cell *cell;
+    while (true) {
+      cell      = &buffer_[pos & mask_];
+      auto seq  = cell->sequence_.load(std::memory_order::acquire);
+      auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order::relaxed)) { break; }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeuePos_.load(std::memory_order::relaxed);
+      }
+    }
+
+    value = cell->value_;
+    cell->sequence_.store(pos + mask_ + 1, std::memory_order::release);
+    return true;
+  }
+
+  /**
+   * @return An approximation of the number of elements in the queue.
+   */
+  auto size() const noexcept -> std::size_t {
+    auto enqueued = enqueuePos_.load(std::memory_order::relaxed);
+    auto dequeued = dequeuePos_.load(std::memory_order::relaxed);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+  }
+
+  auto empty() const noexcept -> bool { return size() == 0; }
+
+  auto capacity() const noexcept -> std::size_t { return mask_ + 1; }
+
+private:
+  static constexpr std::size_t cacheLine_ = 64;
+
+  struct Cell {
+    std::atomic<std::size_t> sequence_;
+    value_type value_;
+  };
+
+  alignas(cacheLine_) std::atomic<std::size_t> enqueuePos_ {0};
+  alignas(cacheLine_) std::atomic<std::size_t> dequeuePos_ {0};
+  alignas(cacheLine_) std::size_t mask_;
+  std::unique_ptr<Cell[]> buffer_;
+};
+}  // namespace coro::detail
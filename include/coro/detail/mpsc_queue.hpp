@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+
+namespace coro::detail {
+/**
+ * Concept to require a type that can link itself into an IntrusiveMpscQueue.
+ */
+template <typename node_type>
+concept intrusive_mpsc_node = std::default_initializable<node_type> && requires(node_type node) {
+  { node.next_ } -> std::same_as<std::atomic<node_type *> &>;
+};
+
+/**
+ * Unbounded lock-free multi-producer single-consumer FIFO queue threaded through the nodes
+ * themselves, Dmitry Vyukov's intrusive design.
+ *
+ * A push is a single exchange on the tail followed by a release store linking the previous tail
+ * to the node, so producers never wait on each other or on the consumer.  The consumer follows
+ * the links from its private head, a stub node keeps the queue from ever becoming empty so the
+ * last node can be popped without racing the producers.  A push that exchanged the tail but did
+ * not link the node yet hides it and the nodes after it, pop() reports the queue empty then and
+ * the caller tries again later.  The nodes are not owned, each must stay alive and must not be
+ * moved while queued.
+ */
+template <intrusive_mpsc_node node_type>
+class IntrusiveMpscQueue {
+public:
+  IntrusiveMpscQueue() noexcept : tail_(&stub_), head_(&stub_) {}
+  IntrusiveMpscQueue(const IntrusiveMpscQueue &)                     = delete;
+  IntrusiveMpscQueue(IntrusiveMpscQueue &&)                          = delete;
+  auto operator=(const IntrusiveMpscQueue &) -> IntrusiveMpscQueue & = delete;
+  auto operator=(IntrusiveMpscQueue &&) -> IntrusiveMpscQueue &      = delete;
+  ~IntrusiveMpscQueue()                                              = default;
+
+  /**
+   * Safe to call from any thread.
+   */
+  auto push(node_type &node) noexcept -> void {
+    node.next_.store(nullptr, std::memory_order::relaxed);
+    auto *previous = tail_.exchange(&node, std::memory_order::acq_rel);
+    previous->next_.store(&node, std::memory_order::release);
+  }
+
+  /**
+   * Only called by the single consumer.
+   * @return The oldest node, nullptr if the queue is empty or its oldest node is still being linked.
+   */
+  auto pop() noexcept -> node_type * {
+    auto *head = head_;
+    auto *next = head->next_.load(std::memory_order::acquire);
+    if (head == &stub_) {
+      if (next == nullptr) { return nullptr; }
+      head_ = next;
+      head  = next;
+      next  = next->next_.load(std::memory_order::acquire);
+    }
+    if (next != nullptr) {
+      head_ = next;
+      return head;
+    }
+
+    // head is the last linked node, popping it would leave nothing to link the next push to.
+    if (head != tail_.load(std::memory_order::acquire)) { return nullptr; }
+    push(stub_);
+    next = head->next_.load(std::memory_order::acquire);
+    if (next == nullptr) { return nullptr; }
+    head_ = next;
+    return head;
+  }
+
+private:
+  /// The most recently pushed node, shared by the producers.
+  alignas(64) std::atomic<node_type *> tail_;
+  /// The oldest node, only touched by the consumer.
+  alignas(64) node_type *head_;
+  node_type stub_ {};
+};
+}  // namespace coro::detail
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+#if defined(CORO_RECYCLE_FRAMES)
+  #include <coro/detail/frame_allocator.hpp>
+#endif
+
+namespace coro::detail {
+/**
+ * Allocation functions for coroutine promise types.
+ *
+ * A coroutine whose parameter list starts with (std::allocator_arg_t, allocator) - after the
+ * object parameter for member functions and lambdas - has its frame allocated with that allocator.
+ * The allocator may be any Allocator or a std::pmr::memory_resource pointer, which is wrapped in a
+ * std::pmr::polymorphic_allocator.  Every other coroutine uses the global heap, or the
+ * RecyclingFrameAllocator when CORO_RECYCLE_FRAMES is defined.
+ *
+ * The promise's operator delete only receives the frame size, so every frame ends with a trailer
+ * holding the function that releases it, followed by a copy of the allocator if one was passed.
+ *
+ * GCC without optimizations does not match the operator new templates taking an allocator with the
+ * sized operator delete and warns with -Wmismatched-new-delete on every coroutine taking one.  The
+ * frames are always released correctly, translation units defining such coroutines may add
+ * -Wno-mismatched-new-delete.
+ */
+struct PromiseAllocator {
+  static auto operator new(std::size_t size) -> void * {
+    auto *frame = allocateDefault(trailerOffset(size) + sizeof(Deallocate));
+    new (static_cast<std::byte *>(frame) + trailerOffset(size)) Deallocate(&deallocateDefault);
+    return frame;
+  }
+
+  template <typename allocator_type, typename... args_type>
+  static auto operator new(std::size_t size, std::allocator_arg_t, const allocator_type &allocator, const args_type &...)
+      -> void * {
+    return allocateWith(size, allocator);
+  }
+
+  template <typename this_type, typename allocator_type, typename... args_type>
+  static auto operator new(
+      std::size_t size, const this_type &, std::allocator_arg_t, const allocator_type &allocator, const args_type &...)
+      -> void * {
+    return allocateWith(size, allocator);
+  }
+
+  static auto operator delete(void *frame, std::size_t size) noexcept -> void { trailer(frame, size)(frame, size); }
+
+private:
+  using Deallocate = void (*)(void *frame, std::size_t size) noexcept;
+
+  /// The unit frames are allocated in with a user allocator, keeps the default new alignment.
+  struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) Block {
+    std::byte bytes_[__STDCPP_DEFAULT_NEW_ALIGNMENT__];
+  };
+
+  /**
+   * @return The allocator rebound to Block, memory resources are wrapped in a polymorphic_allocator.
+   */
+  template <typename allocator_type>
+  static auto normalize(const allocator_type &allocator) {
+    if constexpr (std::is_convertible_v<allocator_type, std::pmr::memory_resource *>) {
+      return std::pmr::polymorphic_allocator<Block>(allocator);
+    } else {
+      return typename std::allocator_traits<allocator_type>::template rebind_alloc<Block>(allocator);
+    }
+  }
+
+  static constexpr auto alignUp(std::size_t size, std::size_t alignment) noexcept -> std::size_t {
+    return (size + alignment - 1) & ~(alignment - 1);
+  }
+
+  static constexpr auto trailerOffset(std::size_t size) noexcept -> std::size_t {
+    return alignUp(size, alignof(Deallocate));
+  }
+
+  template <typename allocator_type>
+  static constexpr auto allocatorOffset(std::size_t size) noexcept -> std::size_t {
+    return alignUp(trailerOffset(size) + sizeof(Deallocate), alignof(allocator_type));
+  }
+
+  template <typename allocator_type>
+  static constexpr auto blockCount(std::size_t size) noexcept -> std::size_t {
+    return (allocatorOffset<allocator_type>(size) + sizeof(allocator_type) + sizeof(Block) - 1) / sizeof(Block);
+  }
+
+  static auto trailer(void *frame, std::size_t size) noexcept -> Deallocate & {
+    return *std::launder(reinterpret_cast<Deallocate *>(static_cast<std::byte *>(frame) + trailerOffset(size)));
+  }
+
+  static auto allocateDefault(std::size_t bytes) -> void * {
+#if defined(CORO_RECYCLE_FRAMES)
+    return RecyclingFrameAllocator::allocate(bytes);
+#else
+    return ::operator new(bytes);
+#endif
+  }
+
+  static auto deallocateDefault(void *frame, std::size_t size) noexcept -> void {
+#if defined(CORO_RECYCLE_FRAMES)
+    RecyclingFrameAllocator::deallocate(frame, trailerOffset(size) + sizeof(Deallocate));
+#else
+    ::operator delete(frame, trailerOffset(size) + sizeof(Deallocate));
+#endif
+  }
+
+  template <typename allocator_type>
+  static auto allocateWith(std::size_t size, const allocator_type &allocator) -> void * {
+    auto stored       = normalize(allocator);
+    using stored_type = decltype(stored);
+    static_assert(alignof(stored_type) <= alignof(Block), "over-aligned allocators are not supported");
+
+    auto *frame = static_cast<void *>(std::allocator_traits<stored_type>::allocate(stored, blockCount<stored_type>(size)));
+    new (static_cast<std::byte *>(frame) + allocatorOffset<stored_type>(size)) stored_type(std::move(stored));
+    new (static_cast<std::byte *>(frame) + trailerOffset(size)) Deallocate(&deallocateWith<stored_type>);
+    return frame;
+  }
+
+  template <typename stored_type>
+  static auto deallocateWith(void *frame, std::size_t size) noexcept -> void {
+    auto *storedPtr =
+        std::launder(reinterpret_cast<stored_type *>(static_cast<std::byte *>(frame) + allocatorOffset<stored_type>(size)));
+    stored_type stored(std::move(*storedPtr));
+    storedPtr->~stored_type();
+    std::allocator_traits<stored_type>::deallocate(stored, static_cast<Block *>(frame), blockCount<stored_type>(size));
+  }
+};
+}  // namespace coro::detail
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <concepts>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <coro/task.hpp>
+
+namespace coro::detail {
+template <typename task_type>
+struct TaskTraits {};
+
+template <typename return_type>
+struct TaskTraits<Task<return_type>> {
+  using result_type = return_type;
+};
+
+/**
+ * Concept to require a range of coro::Task values, as taken by when_all() and when_any().
+ */
+template <typename range_type>
+concept task_range = std::ranges::range<range_type> &&
+                     requires { typename TaskTraits<std::ranges::range_value_t<range_type>>::result_type; };
+
+/**
+ * @return The tasks moved out of the range, a vector rvalue is taken over as is.
+ */
+template <task_range range_type>
+auto toTaskVector(range_type &&tasks) {
+  using task_type = std::ranges::range_value_t<range_type>;
+  if constexpr (std::same_as<std::remove_cvref_t<range_type>, std::vector<task_type>> &&
+                !std::is_lvalue_reference_v<range_type>) {
+    return std::move(tasks);
+  } else {
+    std::vector<task_type> owned {};
+    if constexpr (std::ranges::sized_range<range_type>) { owned.reserve(std::ranges::size(tasks)); }
+    for (auto &task : tasks) { owned.emplace_back(std::move(task)); }
+    return owned;
+  }
+}
+}  // namespace coro::detail
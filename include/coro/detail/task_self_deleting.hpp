@@ -2,11 +2,16 @@
 
 #include <atomic>
 #include <coro/task.hpp>
+#include <coro/detail/intrusive_queue.hpp>
+#include <coro/detail/promise_allocator.hpp>
+
+#include <memory>
+#include <memory_resource>
 
 namespace coro::detail {
 class TaskSelfDeleting;
 
-class PromiseSelfDeleting {
+class PromiseSelfDeleting : public PromiseAllocator {
 public:
   PromiseSelfDeleting();
   ~PromiseSelfDeleting();
@@ -23,11 +28,17 @@ public:
 
   auto executor_size(std::atomic<std::size_t> &taskContainerSize) -> void;
 
+  /**
+     * Queues the not yet started coroutine without allocating, see ThreadPool::enqueue().
+     */
+  auto ready_node() noexcept -> ReadyNode & { return readyNode_; }
+
 private:
   /**
      * The executor m_size member to decrement upon the coroutine completing.
      */
   std::atomic<std::size_t> *executorSize_ {nullptr};
+  ReadyNode readyNode_ {};
 };
 
 /**
@@ -67,4 +78,10 @@ private:
 };
 
 auto makeTaskSelfDeleting(coro::Task<void> userTask) -> TaskSelfDeleting;
+
+/**
+ * Same as above with the wrapper frame allocated from allocator.
+ */
+auto makeTaskSelfDeleting(std::allocator_arg_t, std::pmr::polymorphic_allocator<> allocator, coro::Task<void> userTask)
+    -> TaskSelfDeleting;
 };  // namespace coro::detail
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace coro::detail {
+/**
+ * A timer linked into a TimerWheel, embedded in its owner so arming a timer never allocates.
+ */
+struct TimerNode {
+  TimerNode *prev_ {nullptr};
+  TimerNode *next_ {nullptr};
+  /// The tick the timer expires at.
+  uint64_t expiry_ {0};
+  /// The wheel's list the timer is linked into.
+  uint16_t list_ {0};
+
+  auto linked() const noexcept -> bool { return next_ != nullptr; }
+};
+
+/**
+ * Hierarchical timing wheel, inserting and erasing a timer are O(1) and the timers expiring on
+ * the same tick are collected together.  Not thread safe.
+ *
+ * Each level has 64 slots covering 64 times the span of a slot of the level below.  A timer is
+ * linked into the level of the highest 6-bit group in which its expiry tick differs from the
+ * current tick, and moves down a level each time the wheel reaches its slot, until it expires from
+ * level 0.  A bitmap of the occupied slots per level lets advance() jump over idle stretches of
+ * any length in a few steps.  Timers beyond the top level wait in an overflow list that is
+ * reexamined each time the top level wraps around.
+ */
+class TimerWheel {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @param tick The resolution, deadlines are rounded up to the next tick.
+   * @param start The wheel's epoch.
+   */
+  explicit TimerWheel(Clock::duration tick, Clock::time_point start = Clock::now()) noexcept;
+  TimerWheel(const TimerWheel &)                     = delete;
+  TimerWheel(TimerWheel &&)                          = delete;
+  auto operator=(const TimerWheel &) -> TimerWheel & = delete;
+  auto operator=(TimerWheel &&) -> TimerWheel &      = delete;
+  ~TimerWheel()                                      = default;
+
+  /**
+   * Arms an unlinked timer, it expires from the first advance() past deadline.
+   */
+  auto insert(TimerNode &timer, Clock::time_point deadline) noexcept -> void;
+
+  /**
+   * Disarms a linked timer.
+   */
+  auto erase(TimerNode &timer) noexcept -> void;
+
+  /**
+   * Expires every timer whose deadline is before now and unlinks them.
+   * @param expired Receives the expired timers, by expiry tick.
+   */
+  auto advance(Clock::time_point now, std::vector<TimerNode *> &expired) -> void;
+
+  /**
+   * @return The earliest point at which advance() has work to do, an expiry or timers moving down
+   *         a level.  Clock::time_point::max() if the wheel is empty.
+   */
+  auto next_deadline() const noexcept -> Clock::time_point;
+
+  auto size() const noexcept -> std::size_t { return size_; }
+  auto empty() const noexcept -> bool { return size_ == 0; }
+
+private:
+  static constexpr unsigned slotBits_  = 6;
+  static constexpr std::size_t slots_  = std::size_t {1} << slotBits_;
+  static constexpr std::size_t levels_ = 4;
+  static constexpr uint16_t overflow_  = levels_ * slots_;
+  static constexpr uint16_t due_       = overflow_ + 1;
+
+  Clock::duration tick_;
+  Clock::time_point start_;
+  /// The last tick advance() processed.
+  uint64_t current_ {0};
+  std::size_t size_ {0};
+  /// A bit per occupied slot, per level.
+  std::array<uint64_t, levels_> occupied_ {};
+  /// The sentinels of the circular lists: the slots level by level, the overflow and the timers due.
+  std::array<TimerNode, levels_ * slots_ + 2> lists_ {};
+
+  /**
+   * Links the timer into the list its expiry belongs to relative to current_.
+   */
+  auto link(TimerNode &timer) noexcept -> void;
+
+  /**
+   * Unlinks every timer of a list.
+   * @return The first timer, chained through next_ up to nullptr.
+   */
+  auto take(uint16_t list) noexcept -> TimerNode *;
+
+  /**
+   * @return The earliest tick after current_ at which a timer expires or moves down a level.
+   */
+  auto next_tick() const noexcept -> uint64_t;
+
+  /**
+   * Moves the timers of every slot the wheel reaches at current_ down a level and the expiring ones
+   * into expired.
+   */
+  auto process(std::vector<TimerNode *> &expired) -> void;
+
+  /**
+   * Unlinks a chain returned by take() into expired.
+   */
+  auto expire(TimerNode *timer, std::vector<TimerNode *> &expired) -> void;
+};
+}  // namespace coro::detail
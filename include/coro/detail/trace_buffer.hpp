@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(CORO_TRACING)
+#include <chrono>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace coro::detail {
+/**
+ * What happened to a coroutine, see coro::trace.
+ */
+enum class TraceEvent : uint8_t {
+  /// Queued on a ThreadPool, other is the thread pool.
+  Schedule,
+  /// An executor started resuming the coroutine.
+  ResumeBegin,
+  /// The coroutine the executor resumed suspended or completed.
+  ResumeEnd,
+  /// The coroutine suspended to wait, other is what it waits on.
+  Suspend,
+  /// The coroutine completed and transfers to other, its continuation.
+  Continuation,
+  /// A detached task was created by ThreadPool::spawn().
+  Spawn,
+  /// A detached task completed and deletes itself.
+  SelfDelete,
+};
+
+#if defined(CORO_TRACING)
+/**
+ * A ring of the most recent events of one thread.  Only the owning thread records, the flushing
+ * thread copies the events out concurrently and discards the ones overwritten meanwhile, so once
+ * the ring is full the oldest events are lost rather than recording ever blocking.
+ */
+class TraceBuffer {
+public:
+  static constexpr std::size_t capacity_ = std::size_t {1} << 16;
+  /// The most buffers of exited threads kept until the next flush, the oldest one is dropped beyond.
+  static constexpr std::size_t maxRetired_ = 16;
+
+  /**
+   * @return The raw timestamp recorded with each event, converted to nanoseconds when flushing.
+   */
+  static auto ticks() noexcept -> uint64_t {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+#endif
+  }
+
+  explicit TraceBuffer(uint32_t threadId) noexcept : threadId_(threadId) {}
+
+  auto record(TraceEvent event, const void *coroutine, const void *other) noexcept -> void {
+    auto head = head_.load(std::memory_order::relaxed);
+    // Orders the previous head_ store before the slot stores, the seqlock writer side: a flush that
+    // reads any of them then reads head_ >= head after its acquire fence.
+    std::atomic_thread_fence(std::memory_order::release);
+    auto &slot = slots_[head & (capacity_ - 1)];
+    slot.ticks_.store(ticks(), std::memory_order::relaxed);
+    slot.coroutine_.store(reinterpret_cast<uintptr_t>(coroutine), std::memory_order::relaxed);
+    auto packed = reinterpret_cast<uintptr_t>(other) << 8 | static_cast<uint8_t>(event);
+    slot.other_.store(packed, std::memory_order::relaxed);
+    head_.store(head + 1, std::memory_order::release);
+  }
+
+  struct Slot {
+    std::atomic<uint64_t> ticks_ {0};
+    std::atomic<uintptr_t> coroutine_ {0};
+    /// The other pointer shifted left by 8 bits, or'ed with the TraceEvent.
+    std::atomic<uintptr_t> other_ {0};
+  };
+
+  /// The thread's id in the trace, in registration order.
+  const uint32_t threadId_;
+  /// Set with coro::trace::set_thread_name(), guarded by the registry's mutex.
+  std::string name_ {};
+  /// Set once the owning thread exited with events left to flush, the buffer is freed after its
+  /// next flush.  Guarded by the registry's mutex.
+  bool retired_ {false};
+  /// The index of the next event to record, only written by the owning thread.
+  alignas(64) std::atomic<uint64_t> head_ {0};
+  /// The index of the first event not flushed yet, only used by the flushing thread.
+  uint64_t flushed_ {0};
+  Slot slots_[capacity_];
+};
+
+/// The calling thread's buffer, created by its first event.
+extern constinit thread_local TraceBuffer *tTraceBuffer;
+
+/**
+ * Creates and registers the calling thread's buffer.
+ * @return nullptr if the buffer could not be allocated, the event is dropped then.
+ */
+auto registerTraceBuffer() noexcept -> TraceBuffer *;
+#endif
+
+/**
+ * Records event on the calling thread's trace buffer, compiled out unless CORO_TRACING is defined.
+ */
+inline auto trace([[maybe_unused]] TraceEvent event, [[maybe_unused]] const void *coroutine,
+    [[maybe_unused]] const void *other = nullptr) noexcept -> void {
+#if defined(CORO_TRACING)
+  auto *buffer = tTraceBuffer;
+  if (buffer == nullptr) [[unlikely]] {
+    buffer = registerTraceBuffer();
+    if (buffer == nullptr) { return; }
+  }
+  buffer->record(event, coroutine, other);
+#endif
+}
+}  // namespace coro::detail
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <coroutine>
+
+namespace coro {
+class ThreadPool;
+}  // namespace coro
+
+namespace coro::detail {
+/**
+ * A coroutine waiting on a synchronization primitive.  It is the base of the primitive's awaiter
+ * and so lives in the waiting coroutine's frame, waiters are linked into lists without allocating.
+ */
+struct Waiter {
+  std::coroutine_handle<> awaitingCoroutine_ {nullptr};
+  Waiter *next_ {nullptr};
+};
+
+/**
+ * Waiters push themselves onto the front of a primitive's list, reversing the list puts them back
+ * into the order they started waiting in.
+ */
+inline auto reverseWaiters(Waiter *waiters) noexcept -> Waiter * {
+  Waiter *reversed {nullptr};
+  while (waiters != nullptr) {
+    auto *next     = waiters->next_;
+    waiters->next_ = reversed;
+    reversed       = waiters;
+    waiters        = next;
+  }
+  return reversed;
+}
+
+/**
+ * Resumes every waiter of the list in order on the calling thread without nesting resumptions.  A
+ * waiter resumed inline that releases the next one, e.g. by unlocking, would otherwise resume it
+ * one stack frame deeper and a long chain of waiters would overflow the stack.  Called while the
+ * thread is already resuming waiters further up its stack, the waiters are queued and that outer
+ * call resumes them once the current waiter suspends or completes.
+ * @param waiters The list to resume, none of the waiters is touched once it is resumed.
+ */
+auto resumeInline(Waiter *waiters) noexcept -> void;
+
+/**
+ * Resumes every waiter of the list in order, without a thread pool or once it does not accept
+ * any more they are resumed inline on the calling thread through resumeInline().
+ * @param threadPool Resumes the waiters in ThreadPool::resume() batches, can be nullptr.
+ * @param waiters The list to resume, none of the waiters is touched once it is resumed.
+ */
+auto resumeWaiters(ThreadPool *threadPool, Waiter *waiters) noexcept -> void;
+}  // namespace coro::detail
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+
+namespace coro::detail {
+/**
+ * Joins the children of a when_all(), the last one to complete resumes the awaiting coroutine.
+ *
+ * The count starts one above the number of children, the extra count belongs to the awaiting
+ * coroutine and is only released once it has started every child.  Neither side can therefore
+ * reach zero before the awaiting coroutine is ready to be resumed.
+ */
+class WhenAllLatch {
+public:
+  explicit WhenAllLatch(std::size_t count) noexcept : count_(count + 1) {}
+  WhenAllLatch(const WhenAllLatch &)                     = delete;
+  WhenAllLatch(WhenAllLatch &&)                          = delete;
+  auto operator=(const WhenAllLatch &) -> WhenAllLatch & = delete;
+  auto operator=(WhenAllLatch &&) -> WhenAllLatch &      = delete;
+  ~WhenAllLatch()                                        = default;
+
+  /**
+   * Called by the awaiting coroutine after starting all children.
+   * @return True if the awaiting coroutine must suspend, false if every child already completed.
+   */
+  auto try_await(std::coroutine_handle<> awaiting) noexcept -> bool {
+    awaiting_ = awaiting;
+    return count_.fetch_sub(1, std::memory_order::acq_rel) > 1;
+  }
+
+  /**
+   * Called by each child from its final suspend point.
+   * @return The coroutine the completing child transfers to.
+   */
+  auto notify() noexcept -> std::coroutine_handle<> {
+    if (count_.fetch_sub(1, std::memory_order::acq_rel) == 1) { return awaiting_; }
+    return std::noop_coroutine();
+  }
+
+  /**
+   * A latch disguised as a continuation so it fits into a promise's continuation slot, coroutine
+   * frames are never at an odd address.
+   */
+  auto as_continuation() noexcept -> std::coroutine_handle<> {
+    return std::coroutine_handle<>::from_address(reinterpret_cast<void *>(reinterpret_cast<uintptr_t>(this) | tag_));
+  }
+
+  /**
+   * @return The latch continuation refers to, nullptr if it is a regular coroutine.
+   */
+  static auto from_continuation(std::coroutine_handle<> continuation) noexcept -> WhenAllLatch * {
+    auto bits = reinterpret_cast<uintptr_t>(continuation.address());
+    return (bits & tag_) != 0 ? reinterpret_cast<WhenAllLatch *>(bits & ~tag_) : nullptr;
+  }
+
+private:
+  static constexpr uintptr_t tag_ = 1;
+
+  std::atomic<std::size_t> count_;
+  std::coroutine_handle<> awaiting_ {nullptr};
+};
+}  // namespace coro::detail
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace coro::detail {
+/**
+ * Bounded Chase-Lev work-stealing deque of coroutine handles.
+ *
+ * The owning thread pushes and pops at the bottom (LIFO), any other thread may steal from the
+ * top (FIFO). The buffer has a fixed power-of-two capacity so there is no buffer growth and no
+ * memory reclamation problem; a failed push() tells the owner to put the handle somewhere else.
+ *
+ * Memory orderings follow "Correct and Efficient Work-Stealing for Weak Memory Models"
+ * (Le, Pop, Cohen, Zappa Nardelli, PPoPP'13).
+ */
+class WorkStealingDeque {
+public:
+  /**
+   * @param capacity The maximum number of handles, rounded up to the next power of two.
+   */
+  explicit WorkStealingDeque(std::size_t capacity)
+      : mask_(std::bit_ceil(capacity < 2 ? std::size_t {2} : capacity) - 1)
+      , buffer_(std::make_unique<std::atomic<void *>[]>(mask_ + 1)) {}
+
+  WorkStealingDeque(const WorkStealingDeque &)                     = delete;
+  WorkStealingDeque(WorkStealingDeque &&)                          = delete;
+  auto operator=(const WorkStealingDeque &) -> WorkStealingDeque & = delete;
+  auto operator=(WorkStealingDeque &&) -> WorkStealingDeque &      = delete;
+  ~WorkStealingDeque()                                             = default;
+
+  /**
+   * Owner only.
+   * @return False if the deque is full, the handle was not pushed.
+   */
+  auto push(std::coroutine_handle<> handle) noexcept -> bool {
+    auto b = bottom_.load(std::memory_order::relaxed);
+    auto t = top_.load(std::memory_order::acquire);
+    if (b - t > static_cast<std::int64_t>(mask_)) { return false; }
+
+    buffer_[b & mask_].store(handle.address(), std::memory_order::relaxed);
+    // Publishes the slot and the coroutine frame to thieves acquiring bottom_.
+    bottom_.store(b + 1, std::memory_order::release);
+    return true;
+  }
+
+  /**
+   * Owner only.
+   * @return The most recently pushed handle or nullptr if the deque is empty.
+   */
+  auto pop() noexcept -> std::coroutine_handle<> {
+    auto b = bottom_.load(std::memory_order::relaxed) - 1;
+    bottom_.store(b, std::memory_order::relaxed);
+    std::atomic_thread_fence(std::memory_order::seq_cst);
+    auto t = top_.load(std::memory_order::relaxed);
+
+    if (t > b) {
+      // Empty, restore the bottom.
+      bottom_.store(b + 1, std::memory_order::relaxed);
+      return nullptr;
+    }
+
+    auto *address = buffer_[b & mask_].load(std::memory_order::relaxed);
+    if (t == b) {
+      // Last element, race any thieves for it.
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order::seq_cst, std::memory_order::relaxed)) {
+        address = nullptr;
+      }
+      bottom_.store(b + 1, std::memory_order::relaxed);
+    }
+    return std::coroutine_handle<>::from_address(address);
+  }
+
+  /**
+   * Any thread.
+   * @return The oldest handle or nullptr if the deque is empty or the steal lost a race.
+   */
+  auto steal() noexcept -> std::coroutine_handle<> {
+    auto t = top_.load(std::memory_order::acquire);
+    std::atomic_thread_fence(std::memory_order::seq_cst);
+    auto b = bottom_.load(std::memory_order::acquire);
+    if (t >= b) { return nullptr; }
+
+    auto *address = buffer_[t & mask_].load(std::memory_order::relaxed);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order::seq_cst, std::memory_order::relaxed)) {
+      return nullptr;
+    }
+    return std::coroutine_handle<>::from_address(address);
+  }
+
+  /**
+   * @return An approximation of the number of handles in the deque.
+   */
+  auto size() const noexcept -> std::size_t {
+    auto b = bottom_.load(std::memory_order::relaxed);
+    auto t = top_.load(std::memory_order::relaxed);
+    return b > t ? static_cast<std::size_t>(b - t) : 0;
+  }
+
+  auto empty() const noexcept -> bool { return size() == 0; }
+
+  auto capacity() const noexcept -> std::size_t { return mask_ + 1; }
+
+private:
+  static constexpr std::size_t cacheLine_ = 64;
+
+  /// Stolen from by other threads.
+  alignas(cacheLine_) std::atomic<std::int64_t> top_ {0};
+  /// Only written by the owner.
+  alignas(cacheLine_) std::atomic<std::int64_t> bottom_ {0};
+  alignas(cacheLine_) std::size_t mask_;
+  std::unique_ptr<std::atomic<void *>[]> buffer_;
+};
+}  // namespace coro::detail
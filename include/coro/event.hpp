@@ -0,0 +1,105 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <coro/thread_pool.hpp>
+#include <coro/detail/waiter_list.hpp>
+
+namespace coro {
+/**
+ * An event coroutines wait on with co_await, waiting suspends the coroutine instead of blocking
+ * its thread and does not suspend at all while the event is set.
+ *
+ * The event is a single atomic word that is either set, unset, or the most recent waiter chained
+ * to the older ones through their awaiters, so neither waiting nor setting allocates.  A manual
+ * reset event stays set until reset() and set() resumes every waiter, in one ThreadPool::resume()
+ * batch when a thread pool is given at construction or inline on the setting thread otherwise.
+ * An auto reset event lets a single waiter through per set() instead, a set() without waiters is
+ * consumed by the next waiter.  Its concurrent set() calls are counted and the one that started
+ * counting releases a waiter for each of them, from a FIFO of the waiters it took off the word
+ * that is kept for the following sets, so a set() only reverses the waiters that arrived since.
+ */
+class Event {
+public:
+  enum class ResetMode : uint8_t {
+    /// The event stays set until reset(), all waiters are released.
+    Manual,
+    /// Each set() releases a single waiter and the event resets as it does.
+    Auto,
+  };
+
+  /**
+    * The awaitable returned by co_await on an event.
+    */
+  class WaitOperation : private detail::Waiter {
+    friend class Event;
+
+  public:
+    explicit WaitOperation(Event &event) noexcept : event_(event) {}
+
+    auto await_ready() noexcept -> bool { return event_.try_consume(); }
+    auto await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool;
+    auto await_resume() const noexcept -> void {}
+
+  private:
+    Event &event_;
+  };
+
+  /**
+    * @param mode Whether the event stays set until reset() or releases a single waiter per set().
+    * @param initiallySet Creates the event set.
+    */
+  explicit Event(ResetMode mode = ResetMode::Manual, bool initiallySet = false) noexcept
+      : mode_(mode), state_(initiallySet ? signalled() : nullptr) {}
+
+  /**
+    * @param threadPool Resumes the waiters set() releases, it must outlive the event.
+    */
+  explicit Event(ThreadPool &threadPool, ResetMode mode = ResetMode::Manual, bool initiallySet = false) noexcept
+      : mode_(mode), threadPool_(&threadPool), state_(initiallySet ? signalled() : nullptr) {}
+  Event(const Event &)                     = delete;
+  Event(Event &&)                          = delete;
+  auto operator=(const Event &) -> Event & = delete;
+  auto operator=(Event &&) -> Event &      = delete;
+  ~Event()                                 = default;
+
+  /**
+    * Suspends the awaiting coroutine until the event is set.
+    */
+  [[nodiscard]] auto operator co_await() noexcept -> WaitOperation { return WaitOperation {*this}; }
+
+  /**
+    * Sets the event and resumes the waiters it releases, does nothing if it is already set.
+    */
+  auto set() noexcept -> void;
+
+  /**
+    * Unsets the event, does nothing if it is not set.
+    */
+  auto reset() noexcept -> void;
+
+  [[nodiscard]] auto is_set() const noexcept -> bool { return state_.load(std::memory_order::acquire) == signalled(); }
+
+  [[nodiscard]] auto mode() const noexcept -> ResetMode { return mode_; }
+
+private:
+  /// The event is set, nullptr means it is not set and nobody waits.
+  static auto signalled() noexcept -> void * { return reinterpret_cast<void *>(std::uintptr_t {1}); }
+
+  ResetMode mode_;
+  ThreadPool *threadPool_ {nullptr};
+  /// signalled(), nullptr, or the most recent waiter chained to the older ones through next_.
+  std::atomic<void *> state_;
+  /// The set() calls of an auto reset event not handled yet, the set() taking it off zero
+  /// handles them until it is back to zero.
+  std::atomic<uint64_t> pending_ {0};
+  /// The waiters taken off state_ by an auto reset event, oldest first, only touched by the set()
+  /// handling pending_.  They all waited longer than the ones on state_.
+  detail::Waiter *waiters_ {nullptr};
+
+  /**
+    * @return True if the event is set, an auto reset event is reset by the caller.
+    */
+  auto try_consume() noexcept -> bool;
+};
+}  // namespace coro
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <coro/detail/promise_allocator.hpp>
+
+namespace coro {
+template <typename yield_type>
+class Generator;
+
+namespace detail {
+template <typename yield_type>
+class GeneratorPromise final : public PromiseAllocator {
+public:
+  using value_type     = std::remove_cvref_t<yield_type>;
+  using reference_type = std::conditional_t<std::is_reference_v<yield_type>, yield_type, yield_type &>;
+  using pointer_type   = std::add_pointer_t<reference_type>;
+
+  GeneratorPromise() noexcept = default;
+
+  auto get_return_object() noexcept -> Generator<yield_type>;
+
+  auto initial_suspend() const noexcept { return std::suspend_always {}; }
+  auto final_suspend() const noexcept { return std::suspend_always {}; }
+
+  /**
+   * Only stores the address of the value, a temporary lives until the generator is resumed.
+   */
+  auto yield_value(std::remove_reference_t<yield_type> &value) noexcept -> std::suspend_always {
+    value_ = std::addressof(value);
+    return std::suspend_always {};
+  }
+
+  auto yield_value(std::remove_reference_t<yield_type> &&value) noexcept -> std::suspend_always {
+    value_ = std::addressof(value);
+    return std::suspend_always {};
+  }
+
+  /**
+   * A generator is driven by its consumer and cannot suspend on anything but co_yield.
+   */
+  template <typename awaitable_type>
+  auto await_transform(awaitable_type &&) -> std::suspend_never = delete;
+
+  auto return_void() noexcept -> void {}
+
+  auto unhandled_exception() noexcept -> void { exception_ = std::current_exception(); }
+
+  auto value() const noexcept -> reference_type { return static_cast<reference_type>(*value_); }
+
+  auto rethrow_if_exception() -> void {
+    if (exception_) { std::rethrow_exception(std::exchange(exception_, nullptr)); }
+  }
+
+private:
+  pointer_type value_ {nullptr};
+  std::exception_ptr exception_ {nullptr};
+};
+}  // namespace detail
+
+/**
+ * A lazily evaluated sequence produced by a coroutine with co_yield, the coroutine runs up to the
+ * next co_yield each time the iterator is incremented.
+ *
+ * The generator models std::ranges::input_range and yields references to the values the coroutine
+ * yields instead of copies, so streaming any number of values keeps a single frame alive.  The
+ * frame is allocated like a Task's, see detail::PromiseAllocator.  An exception escaping the
+ * coroutine is rethrown from begin() or the increment that resumed it.
+ *
+ * Iterating consumes the generator, begin() can only be called once.  It is const so a generator
+ * can be passed on as a const range, e.g. to ThreadPool::resume().
+ *
+ * @tparam yield_type The type yielded, iterating produces yield_type & unless it is a reference.
+ */
+template <typename yield_type>
+class [[nodiscard]] Generator {
+public:
+  using promise_type     = detail::GeneratorPromise<yield_type>;
+  using coroutine_handle = std::coroutine_handle<promise_type>;
+
+  class Iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using difference_type   = std::ptrdiff_t;
+    using value_type        = typename promise_type::value_type;
+    using reference         = typename promise_type::reference_type;
+    using pointer           = typename promise_type::pointer_type;
+
+    Iterator() noexcept = default;
+    explicit Iterator(coroutine_handle coroutine) noexcept : coroutine_(coroutine) {}
+
+    auto operator*() const noexcept -> reference { return coroutine_.promise().value(); }
+    auto operator->() const noexcept -> pointer { return std::addressof(coroutine_.promise().value()); }
+
+    auto operator++() -> Iterator & {
+      coroutine_.resume();
+      if (coroutine_.done()) { coroutine_.promise().rethrow_if_exception(); }
+      return *this;
+    }
+    auto operator++(int) -> void { ++*this; }
+
+    friend auto operator==(const Iterator &it, std::default_sentinel_t) noexcept -> bool {
+      return it.coroutine_ == nullptr || it.coroutine_.done();
+    }
+
+  private:
+    coroutine_handle coroutine_ {nullptr};
+  };
+
+  Generator() noexcept = default;
+  explicit Generator(coroutine_handle coroutine) noexcept : coroutine_(coroutine) {}
+  Generator(const Generator &) = delete;
+  Generator(Generator &&other) noexcept : coroutine_(std::exchange(other.coroutine_, nullptr)) {}
+  auto operator=(const Generator &) -> Generator & = delete;
+  auto operator=(Generator &&other) noexcept -> Generator & {
+    if (std::addressof(other) != this) {
+      if (coroutine_ != nullptr) { coroutine_.destroy(); }
+      coroutine_ = std::exchange(other.coroutine_, nullptr);
+    }
+    return *this;
+  }
+  ~Generator() {
+    if (coroutine_ != nullptr) { coroutine_.destroy(); }
+  }
+
+  /**
+   * Runs the coroutine up to its first co_yield.
+   */
+  auto begin() const -> Iterator {
+    if (coroutine_ != nullptr) {
+      coroutine_.resume();
+      if (coroutine_.done()) { coroutine_.promise().rethrow_if_exception(); }
+    }
+    return Iterator {coroutine_};
+  }
+
+  auto end() const noexcept -> std::default_sentinel_t { return std::default_sentinel; }
+
+private:
+  coroutine_handle coroutine_ {nullptr};
+};
+
+namespace detail {
+template <typename yield_type>
+inline auto GeneratorPromise<yield_type>::get_return_object() noexcept -> Generator<yield_type> {
+  return Generator<yield_type> {std::coroutine_handle<GeneratorPromise>::from_promise(*this)};
+}
+}  // namespace detail
+}  // namespace coro
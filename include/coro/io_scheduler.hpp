@@ -0,0 +1,729 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <coro/detail/io_uring.hpp>
+#include <coro/detail/task_self_deleting.hpp>
+#include <coro/detail/timer_wheel.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+
+struct epoll_event;
+
+namespace coro {
+/**
+ * The readiness a poll waits for.
+ */
+enum class PollOp : uint8_t {
+  /// The fd is readable or the peer hung up.
+  Read,
+  /// The fd is writable.
+  Write,
+  /// Either of the above.
+  ReadWrite,
+};
+
+/**
+ * How a poll completed.
+ */
+enum class PollStatus : uint8_t {
+  /// The fd is ready for the requested operation.
+  Event,
+  /// The timeout expired before the fd became ready.
+  Timeout,
+  /// The fd reported an error or could not be polled, e.g. it is invalid or already being polled.
+  Error,
+  /// The peer closed its end of the fd, or the scheduler shut down before the fd became ready.
+  Closed,
+};
+
+/**
+ * The outcome of a completion-based I/O operation.
+ */
+struct IoResult {
+  /// The number of bytes transferred, the accepted fd, or a negated errno value.
+  int64_t value_ {0};
+
+  auto ok() const noexcept -> bool { return value_ >= 0; }
+
+  auto error() const noexcept -> std::error_code {
+    return ok() ? std::error_code {} : std::error_code {static_cast<int>(-value_), std::system_category()};
+  }
+};
+
+/**
+ * The file an I/O operation targets, either a plain fd or an index into the registered files.
+ */
+struct IoFile {
+  IoFile(int fd) noexcept : fd_(fd) {}  // NOLINT(google-explicit-constructor)
+
+  /**
+   * @param index The position of the file passed to IoScheduler::register_files().
+   */
+  static auto fixed(int index) noexcept -> IoFile {
+    IoFile file {index};
+    file.fixed_ = true;
+    return file;
+  }
+
+  int fd_;
+  bool fixed_ {false};
+};
+
+/**
+ * The result of IoScheduler::with_timeout(): the task's value, or nothing if the timeout expired
+ * first.  Whether the task completed in time for void tasks.
+ */
+template <typename return_type>
+using TimeoutResult = std::conditional_t<std::is_void_v<return_type>, bool, std::optional<return_type>>;
+
+/**
+ * Resumes coroutines once a file descriptor is ready, Linux only.
+ *
+ * A single I/O thread waits on an epoll instance, every poll registers its fd one-shot with the
+ * awaiting coroutine's operation as the user data so no lookup or allocation happens per event.
+ * Other threads interrupt the wait through an eventfd, e.g. to schedule a coroutine or to arm an
+ * earlier timeout.  The ready coroutines are resumed inline on the I/O thread, or handed to a
+ * ThreadPool with a single batched resume() per wakeup, see ExecutionStrategy.
+ *
+ * The completion-based operations, read(), write(), recv(), send(), accept() and fsync(), run on an
+ * io_uring instance when the kernel provides one.  The submission queue entries prepared between
+ * two loop iterations go out with a single io_uring_enter() and the ring's fd is watched by the
+ * same epoll instance, so the completions are harvested and resumed together with the polls.  On
+ * the epoll backend the operations try the syscall right away and poll the fd on EAGAIN instead.
+ *
+ * Timeouts and sleeps live in a hierarchical timer wheel, see detail::TimerWheel, linked through a
+ * node in the awaiting coroutine's frame: arming and cancelling them is O(1) and never allocates,
+ * and the timers expiring within the same tick are resumed together.
+ *
+ * When shutting down, either by the scheduler destructing or by manually calling shutdown(), the
+ * scheduler stops accepting new work, resumes the scheduled coroutines, completes the pending
+ * polls with PollStatus::Closed, cuts the sleeps short and cancels the in-flight operations with ECANCELED.
+ */
+class IoScheduler final : public std::enable_shared_from_this<IoScheduler> {
+  struct PrivateConstructor {
+    PrivateConstructor() = default;
+  };
+
+public:
+  /**
+    * Who runs the event loop.
+    */
+  enum class ThreadStrategy : uint8_t {
+    /// The scheduler spawns its own I/O thread.
+    Spawn,
+    /// The user drives the event loop by calling process_events().
+    Manual,
+  };
+
+  /**
+    * Where ready coroutines are resumed.
+    */
+  enum class ExecutionStrategy : uint8_t {
+    /// On the thread running the event loop, lowest latency for short handlers.
+    Inline,
+    /// On Options::threadPool_, keeps long handlers from delaying other fds.
+    ThreadPool,
+  };
+
+  class IoOperation;
+  class TimeoutOperation;
+
+  /**
+    * What carries out the completion-based operations.
+    */
+  enum class Backend : uint8_t {
+    /// io_uring if the kernel supports it, epoll otherwise.
+    Auto,
+    /// Non-blocking syscalls retried once epoll reports the fd ready.
+    Epoll,
+    /// io_uring, the scheduler fails to construct if it is unavailable.
+    IoUring,
+  };
+
+  struct Options {
+    ThreadStrategy threadStrategy_       = ThreadStrategy::Spawn;
+    ExecutionStrategy executionStrategy_ = ExecutionStrategy::Inline;
+    /// The thread pool for ExecutionStrategy::ThreadPool, one with the default options is created
+    /// if none is given.
+    std::shared_ptr<coro::ThreadPool> threadPool_ = nullptr;
+    /// The maximum number of events taken from epoll per wakeup.
+    std::size_t maxEvents_ = 64;
+    Backend backend_       = Backend::Auto;
+    /// The io_uring submission queue size, more operations in flight are fine.
+    uint32_t ringEntries_ = 256;
+    /// The timer resolution, deadlines are rounded up to it.  A coarser tick batches more timers
+    /// into a single wakeup.
+    std::chrono::milliseconds timerTick_ {1};
+    /// Functor to call on the spawned I/O thread upon starting execution.
+    std::function<void()> onIoThreadStart_ = nullptr;
+    /// Functor to call on the spawned I/O thread upon stopping execution.
+    std::function<void()> onIoThreadStop_ = nullptr;
+  };
+
+  /**
+    * The awaitable returned by poll(), lives in the awaiting coroutine's frame while it is
+    * registered with the scheduler.
+    */
+  class PollOperation {
+    friend class IoScheduler;
+    friend class IoOperation;
+    friend class SleepOperation;
+    explicit PollOperation(
+        IoScheduler &scheduler, int fd, PollOp op, std::chrono::steady_clock::time_point deadline) noexcept;
+
+  public:
+    PollOperation(const PollOperation &)                     = delete;
+    PollOperation(PollOperation &&)                          = delete;
+    auto operator=(const PollOperation &) -> PollOperation & = delete;
+    auto operator=(PollOperation &&) -> PollOperation &      = delete;
+    ~PollOperation()                                         = default;
+
+    auto await_ready() const noexcept -> bool { return false; }
+
+    /**
+      * Registers the fd, the awaiting coroutine is not suspended if that fails.
+      */
+    auto await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool;
+
+    auto await_resume() const noexcept -> PollStatus { return status_; }
+
+  private:
+    IoScheduler &scheduler_;
+    int fd_;
+    PollOp op_;
+    /// When to complete with PollStatus::Timeout, time_point::max() never does.
+    std::chrono::steady_clock::time_point deadline_;
+    PollStatus status_ {PollStatus::Error};
+    std::coroutine_handle<> awaitingCoroutine_ {nullptr};
+    /// Links the poll into IoScheduler::timers_ while it has a deadline.
+    struct Timer : detail::TimerNode {
+      PollOperation *operation_;
+    } timer_ {{}, this};
+    /// Waits for the deadline only, on behalf of a SleepOperation.
+    bool sleep_ {false};
+    /// Set by IoScheduler::cancel() before the poll got registered, it then completes right away.
+    bool cancelled_ {false};
+    /// Links the pending polls so shutdown() can complete them, guarded by IoScheduler::mutex_.
+    PollOperation *prev_ {nullptr};
+    PollOperation *next_ {nullptr};
+  };
+
+  /**
+    * The awaitable returned by the completion-based operations, lives in the awaiting coroutine's
+    * frame while it is in flight.
+    */
+  class IoOperation {
+    friend class IoScheduler;
+    enum class Kind : uint8_t { Read, Write, ReadFixed, WriteFixed, Recv, Send, Accept, Fsync };
+
+    explicit IoOperation(IoScheduler &scheduler, Kind kind, IoFile file, void *buffer, std::size_t length,
+        int64_t offset, uint32_t flags) noexcept;
+
+  public:
+    IoOperation(const IoOperation &)                     = delete;
+    IoOperation(IoOperation &&)                          = delete;
+    auto operator=(const IoOperation &) -> IoOperation & = delete;
+    auto operator=(IoOperation &&) -> IoOperation &      = delete;
+    ~IoOperation()                                       = default;
+
+    /**
+      * On the epoll backend, tries the syscall right away.
+      */
+    auto await_ready() noexcept -> bool;
+
+    /**
+      * Queues the submission, or polls the fd on the epoll backend.  The awaiting coroutine is not
+      * suspended if that fails.
+      */
+    auto await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool;
+
+    /**
+      * On the epoll backend, retries the syscall once the fd is ready.  It may still fail with
+      * EAGAIN if another reader took the data first.
+      */
+    auto await_resume() noexcept -> IoResult;
+
+  private:
+    IoScheduler &scheduler_;
+    Kind kind_;
+    IoFile file_;
+    void *buffer_;
+    std::size_t length_;
+    int64_t offset_;
+    uint32_t flags_;
+    int64_t result_ {-EAGAIN};
+    std::coroutine_handle<> awaitingCoroutine_ {nullptr};
+    /// Set once shutdown() asked the kernel to cancel the operation.
+    bool cancelled_ {false};
+    /// Links the in-flight operations so shutdown() can cancel them, guarded by IoScheduler::mutex_.
+    IoOperation *prev_ {nullptr};
+    IoOperation *next_ {nullptr};
+    /// Waits for the fd on the epoll backend.
+    PollOperation poll_;
+
+    /**
+      * Runs the operation as a non-blocking syscall.
+      */
+    auto perform() noexcept -> int64_t;
+  };
+
+  /**
+    * The awaitable returned by sleep_for() and sleep_until().
+    */
+  class SleepOperation {
+    friend class IoScheduler;
+    friend class TimeoutOperation;
+    explicit SleepOperation(IoScheduler &scheduler, std::chrono::steady_clock::time_point deadline) noexcept
+        : poll_(scheduler, -1, PollOp::Read, deadline) {
+      poll_.sleep_ = true;
+    }
+
+  public:
+    SleepOperation(const SleepOperation &)                     = delete;
+    SleepOperation(SleepOperation &&)                          = delete;
+    auto operator=(const SleepOperation &) -> SleepOperation & = delete;
+    auto operator=(SleepOperation &&) -> SleepOperation &      = delete;
+    ~SleepOperation()                                          = default;
+
+    auto await_ready() const noexcept -> bool { return poll_.deadline_ <= std::chrono::steady_clock::now(); }
+
+    /**
+      * A coro::Task stops sleeping early once its stop token is stopped, and never sleeps past its
+      * deadline.
+      */
+    template <std::derived_from<detail::PromiseBase> promise_type>
+    auto await_suspend(std::coroutine_handle<promise_type> awaitingCoroutine) noexcept -> bool {
+      const auto &promise = awaitingCoroutine.promise();
+      poll_.deadline_     = std::min(poll_.deadline_, promise.deadline());
+      const auto &token   = promise.stop_token();
+      if (token.stop_possible()) { stopCallback_.emplace(token, StopSleep {poll_}); }
+      return poll_.await_suspend(awaitingCoroutine);
+    }
+
+    auto await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool {
+      return poll_.await_suspend(awaitingCoroutine);
+    }
+
+    auto await_resume() const noexcept -> void {}
+
+  private:
+    struct StopSleep {
+      PollOperation &poll_;
+      auto operator()() const noexcept -> void { poll_.scheduler_.cancel(poll_); }
+    };
+
+    PollOperation poll_;
+    std::optional<std::stop_callback<StopSleep>> stopCallback_ {};
+  };
+
+  /**
+    * The awaitable through which with_timeout() waits for its task, the timeout is armed in the
+    * awaiting coroutine's frame.  The task is awaited by a detached runner, see runTimeout(), which
+    * races the timer under the scheduler's mutex: whichever completes first wins and the loser finds
+    * out once it completes in turn.
+    */
+  class TimeoutOperation {
+    friend class IoScheduler;
+    explicit TimeoutOperation(IoScheduler &scheduler, std::chrono::steady_clock::time_point deadline) noexcept
+        : scheduler_(scheduler), sleep_(scheduler, deadline) {}
+
+  public:
+    TimeoutOperation(const TimeoutOperation &)                     = delete;
+    TimeoutOperation(TimeoutOperation &&)                          = delete;
+    auto operator=(const TimeoutOperation &) -> TimeoutOperation & = delete;
+    auto operator=(TimeoutOperation &&) -> TimeoutOperation &      = delete;
+    ~TimeoutOperation()                                            = default;
+
+    auto await_ready() const noexcept -> bool { return sleep_.await_ready(); }
+
+    /**
+      * Arms the timer unless the task already completed, see SleepOperation::await_suspend().
+      */
+    template <std::derived_from<detail::PromiseBase> promise_type>
+    auto await_suspend(std::coroutine_handle<promise_type> awaitingCoroutine) noexcept -> bool {
+      return sleep_.await_suspend(awaitingCoroutine);
+    }
+
+    /**
+      * Gives up on the task unless it completed first.
+      * @return True if the task completed in time, its runner then waits to be resumed once the
+      *         result has been taken.
+      */
+    auto await_resume() noexcept -> bool;
+
+  private:
+    IoScheduler &scheduler_;
+    /// Resumes the awaiting coroutine at the deadline, or once the runner cancelled it.
+    SleepOperation sleep_;
+    /// The runner's link to this operation, cleared once the operation gave up on the task.
+    TimeoutOperation **runner_ {nullptr};
+    /// Set by the runner once the task completed in time.
+    bool completed_ {false};
+  };
+
+  /**
+    * The awaitable returned by schedule().
+    */
+  class ScheduleOperation {
+    friend class IoScheduler;
+    explicit ScheduleOperation(IoScheduler &scheduler) noexcept : scheduler_(scheduler) {}
+
+  public:
+    auto await_ready() const noexcept -> bool { return false; }
+
+    /**
+      * Resumes the awaiting coroutine inline if the scheduler is shutting down.
+      */
+    auto await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool;
+
+    auto await_resume() const noexcept -> void {}
+
+  private:
+    IoScheduler &scheduler_;
+  };
+
+  /**
+     * @see IoScheduler::makeShared
+     * @throw std::system_error If the epoll instance or the eventfd can't be created.
+     */
+  explicit IoScheduler(Options &&opts, PrivateConstructor);
+
+  /**
+     * @brief Creates an I/O scheduler, starts its I/O thread with ThreadStrategy::Spawn.
+     *
+     * @param opts The scheduler's options.
+     */
+  static auto makeShared(Options opts) -> std::shared_ptr<IoScheduler>;
+
+  /**
+     * @brief Creates an I/O scheduler with the default options.
+     */
+  static auto makeShared() -> std::shared_ptr<IoScheduler>;
+  IoScheduler(const IoScheduler &)                     = delete;
+  IoScheduler(IoScheduler &&)                          = delete;
+  auto operator=(const IoScheduler &) -> IoScheduler & = delete;
+  auto operator=(IoScheduler &&) -> IoScheduler &      = delete;
+
+  ~IoScheduler();
+
+  /**
+     * Moves the awaiting coroutine onto the scheduler, see ExecutionStrategy.
+     * @throw std::runtime_error If the scheduler is shutting down.
+     */
+  [[nodiscard]] auto schedule() -> ScheduleOperation;
+
+  /**
+     * Suspends the awaiting coroutine until fd is ready for op.  Only one coroutine may poll a given
+     * fd at a time, the fd must stay open until the poll completed.
+     * @param fd The file descriptor, typically non-blocking.
+     * @param op The readiness to wait for.
+     * @param timeout Completes the poll with PollStatus::Timeout once expired, zero waits forever.
+     * @return The awaitable producing the PollStatus.  PollStatus::Closed right away once the
+     *         scheduler is shutting down.
+     */
+  [[nodiscard]] auto poll(int fd, PollOp op, std::chrono::milliseconds timeout = std::chrono::milliseconds {0})
+      -> PollOperation;
+
+  /**
+     * Suspends the awaiting coroutine for at least duration without blocking a thread.  It resumes
+     * right away once the scheduler is shutting down.
+     */
+  [[nodiscard]] auto sleep_for(std::chrono::steady_clock::duration duration) -> SleepOperation;
+
+  /**
+     * Suspends the awaiting coroutine until deadline, see sleep_for().
+     */
+  [[nodiscard]] auto sleep_until(std::chrono::steady_clock::time_point deadline) -> SleepOperation;
+
+  /**
+     * Runs the task, starting inline on the awaiting thread, and gives up on it once timeout expired.
+     * Nothing is cancelled forcibly: the timeout becomes the task's deadline, which also ends its
+     * sleeps, and it observes the awaiting task's stop token unless it has one of its own.  It keeps
+     * running detached until it notices, so anything it references must outlive it.  Also gives up
+     * once the scheduler is shutting down or a stop is requested.  Besides the returned task, only
+     * the runner awaiting the task is allocated, the timer is armed in the returned task's frame.
+     * @return The awaitable producing the task's value, std::nullopt or false on timeout.
+     * @throw Rethrows the task's exception if it failed in time.
+     */
+  template <typename return_type>
+    requires(!std::is_reference_v<return_type>)
+  [[nodiscard]] auto with_timeout(Task<return_type> task, std::chrono::steady_clock::duration timeout)
+      -> Task<TimeoutResult<return_type>>;
+
+  /**
+     * Reads into buffer.  On the epoll backend the fd must be non-blocking, unless it is a regular file.
+     * @param offset The file offset, negative reads from the current position.
+     * @return The awaitable producing the number of bytes read.  ECANCELED once the scheduler is
+     *         shutting down.
+     */
+  [[nodiscard]] auto read(IoFile file, std::span<std::byte> buffer, int64_t offset = -1) -> IoOperation;
+
+  /**
+     * Writes buffer, see read().
+     */
+  [[nodiscard]] auto write(IoFile file, std::span<const std::byte> buffer, int64_t offset = -1) -> IoOperation;
+
+  /**
+     * Reads into a part of the buffer registered at bufferIndex, sparing the kernel from mapping it
+     * per operation.  A plain read() on the epoll backend.
+     */
+  [[nodiscard]] auto read_fixed(IoFile file, std::span<std::byte> buffer, uint16_t bufferIndex, int64_t offset = -1)
+      -> IoOperation;
+
+  /**
+     * Writes a part of the buffer registered at bufferIndex, see read_fixed().
+     */
+  [[nodiscard]] auto write_fixed(
+      IoFile file, std::span<const std::byte> buffer, uint16_t bufferIndex, int64_t offset = -1) -> IoOperation;
+
+  /**
+     * Receives from a socket, see read().
+     * @param flags The MSG_* flags for recv(2).
+     */
+  [[nodiscard]] auto recv(IoFile socket, std::span<std::byte> buffer, int flags = 0) -> IoOperation;
+
+  /**
+     * Sends on a socket, see read().
+     * @param flags The MSG_* flags for send(2).
+     */
+  [[nodiscard]] auto send(IoFile socket, std::span<const std::byte> buffer, int flags = 0) -> IoOperation;
+
+  /**
+     * Accepts a connection on a listening socket, see read().
+     * @param flags The SOCK_* flags for accept4(2).
+     * @return The awaitable producing the connected socket's fd.
+     */
+  [[nodiscard]] auto accept(IoFile socket, int flags = 0) -> IoOperation;
+
+  /**
+     * Flushes a file to its storage device.
+     * @param dataOnly Skips the metadata not needed to read the data back, see fdatasync(2).
+     */
+  [[nodiscard]] auto fsync(IoFile file, bool dataOnly = false) -> IoOperation;
+
+  /**
+     * Registers the buffers for read_fixed() and write_fixed(), replacing the previous ones.  No
+     * operation on them may be in flight.
+     * @throw std::system_error If the kernel refuses the buffers, e.g. they exceed RLIMIT_MEMLOCK.
+     */
+  auto register_buffers(std::span<const std::span<std::byte>> buffers) -> void;
+
+  /**
+     * Registers the files for IoFile::fixed(), replacing the previous ones.  No operation on them may
+     * be in flight.
+     * @throw std::system_error If the kernel refuses the files.
+     */
+  auto register_files(std::span<const int> fds) -> void;
+
+  /**
+     * @return The backend carrying out the completion-based operations, never Backend::Auto.
+     */
+  auto backend() const noexcept -> Backend { return ring_ != nullptr ? Backend::IoUring : Backend::Epoll; }
+
+  /**
+     * Runs one iteration of the event loop on the calling thread, ThreadStrategy::Manual only and
+     * never from more than one thread at a time.
+     * @param timeout How long to wait for an event if nothing is ready, negative waits forever.
+     * @return The number of coroutines resumed or handed to the thread pool.
+     */
+  auto process_events(std::chrono::milliseconds timeout = std::chrono::milliseconds {0}) -> std::size_t;
+
+  /**
+     * Stops accepting new work, resumes the scheduled coroutines and completes the pending polls
+     * with PollStatus::Closed.  Blocks until the I/O thread exited.
+     */
+  auto shutdown() noexcept -> void;
+
+  /**
+     * @return The number of pending polls and sleeps + in-flight operations + scheduled coroutines
+     *         not resumed yet.
+     */
+  auto size() const noexcept -> std::size_t { return size_.load(std::memory_order::acquire); }
+
+  /**
+     * @return True if no poll is pending and no coroutine is waiting to be resumed.
+     */
+  auto empty() const noexcept -> bool { return size() == 0; }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  Options opts_;
+  int epollFd_ {-1};
+  /// Interrupts epoll_wait(), registered with its own address as the user data.
+  int eventFd_ {-1};
+  std::thread ioThread_;
+
+  /// The io_uring instance, nullptr on the epoll backend.  Registered with epoll by its own address.
+  std::unique_ptr<detail::IoUring> ring_;
+
+  /// Guards timers_, waitDeadline_, pending_, inFlight_, scheduled_, files_ and the submission side
+  /// of ring_.
+  std::mutex mutex_;
+  /// The deadlines of the polls and sleeps.
+  detail::TimerWheel timers_;
+  /// Until when the event loop waits, an earlier deadline interrupts it.
+  Clock::time_point waitDeadline_ {Clock::time_point::max()};
+  /// The head of the intrusive list of registered polls.
+  PollOperation *pending_ {nullptr};
+  /// The head of the intrusive list of operations submitted to ring_.
+  IoOperation *inFlight_ {nullptr};
+  /// The fds passed to register_files(), resolves IoFile::fixed() on the epoll backend.
+  std::vector<int> files_;
+  /// Coroutines waiting to move onto the scheduler.
+  std::vector<std::coroutine_handle<>> scheduled_;
+
+  /// Buffers reused by every event loop iteration.
+  std::unique_ptr<epoll_event[]> events_;
+  std::vector<PollOperation *> completed_;
+  std::vector<detail::TimerNode *> expired_;
+  std::vector<detail::IoUring::Completion> completions_;
+  std::vector<std::coroutine_handle<>> ready_;
+
+  /// Set once eventFd_ has been written to and not drained yet, spares redundant writes.
+  std::atomic<bool> wakePending_ {false};
+  std::atomic<std::size_t> size_ {0};
+  std::atomic<bool> shutdownRequested_ {false};
+
+  /**
+     * The spawned I/O thread runs from this function.
+     */
+  auto io_thread() -> void;
+
+  /**
+     * One iteration of the event loop, waits at most timeout if nothing is ready.
+     * @return The number of coroutines resumed.
+     */
+  auto process(std::chrono::milliseconds timeout) -> std::size_t;
+
+  /**
+     * Resumes the ready coroutines inline or on the thread pool.
+     */
+  auto dispatch(const std::vector<std::coroutine_handle<>> &handles) -> void;
+
+  /**
+     * Completes every pending poll with PollStatus::Closed and resumes every scheduled coroutine.
+     */
+  auto drain() -> void;
+
+  /**
+     * Harvests the ring's completions, mutex_ must be held.
+     * @param ready Receives the coroutines awaiting the completed operations.
+     * @return The number of completed operations.
+     */
+  auto reap(std::vector<std::coroutine_handle<>> &ready) noexcept -> std::size_t;
+
+  /**
+     * Cuts a pending sleep short, or makes it complete right away if it is not registered yet.
+     * Polls on an fd can't be cancelled, the I/O thread may already be holding their event.
+     */
+  auto cancel(PollOperation &operation) noexcept -> void;
+
+  /**
+     * Awaits a with_timeout() task on behalf of operation, detached so the task can outlive a
+     * timeout.  Its frame owns the task and is gone once both sides of the race completed.
+     */
+  template <typename return_type>
+  auto run_timeout(TimeoutOperation &operation, Task<return_type> task) -> detail::TaskSelfDeleting;
+
+  /**
+     * Called by the runner once its task completed, cancels the timeout unless it expired first.
+     * @param operation The runner's link to the operation, nullptr once it gave up on the task.
+     * @return The coroutine to continue with: the operation's awaiting coroutine if its timer got
+     *         cancelled, std::noop_coroutine() if it resumes on its own, nullptr if the runner
+     *         lost the race.
+     */
+  auto complete_timeout(TimeoutOperation *&operation) noexcept -> std::coroutine_handle<>;
+
+  /**
+     * Unlinks a completed poll, mutex_ must be held.
+     */
+  auto unlink(PollOperation &operation) noexcept -> void;
+
+  /**
+     * Unlinks a completed operation, mutex_ must be held.
+     */
+  auto unlink(IoOperation &operation) noexcept -> void;
+
+  /**
+     * Interrupts epoll_wait() unless an interruption is already pending.
+     */
+  auto wake() noexcept -> void;
+};
+
+template <typename return_type>
+auto IoScheduler::run_timeout(TimeoutOperation &operation, Task<return_type> task) -> detail::TaskSelfDeleting {
+  // Waits for the task without taking its result, the operation takes it if it completed in time.
+  struct Completion : Task<return_type>::AwaitableBase {
+    auto await_resume() const noexcept -> void {}
+  };
+
+  struct Finish {
+    IoScheduler &scheduler_;
+    TimeoutOperation *&operation_;
+
+    auto await_ready() const noexcept -> bool { return false; }
+
+    auto await_suspend(std::coroutine_handle<> runner) noexcept -> std::coroutine_handle<> {
+      // The runner only continues, and destroys the task, once the operation is done with it.
+      auto next = scheduler_.complete_timeout(operation_);
+      return next != nullptr ? next : runner;
+    }
+
+    auto await_resume() const noexcept -> void {}
+  };
+
+  // Guarded by mutex_, cleared by the operation once it gave up.
+  TimeoutOperation *awaiting {&operation};
+  operation.runner_ = &awaiting;
+  co_await Completion {task.handle()};
+  co_await Finish {*this, awaiting};
+}
+
+template <typename return_type>
+  requires(!std::is_reference_v<return_type>)
+auto IoScheduler::with_timeout(Task<return_type> task, std::chrono::steady_clock::duration timeout)
+    -> Task<TimeoutResult<return_type>> {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  if (!task.promise().stop_token().stop_possible()) { task.promise().stop_token(co_await this_task::stop_token()); }
+  task.promise().deadline(std::min(task.promise().deadline(), deadline));
+
+  auto completion = task.handle();
+  TimeoutOperation operation {*this, deadline};
+  // Once the operation gave up the runner may be gone, it only waits to be resumed if the task won.
+  auto runner = run_timeout(operation, std::move(task)).handle();
+  runner.resume();
+  if (!co_await operation) { co_return TimeoutResult<return_type> {}; }
+
+  TimeoutResult<return_type> result {};
+  std::exception_ptr exception {nullptr};
+  try {
+    if constexpr (std::is_void_v<return_type>) {
+      completion.promise().result();
+      result = true;
+    } else {
+      result.emplace(std::move(completion.promise()).result());
+    }
+  } catch (...) {
+    exception = std::current_exception();
+  }
+  // Completes the runner, which destroys the task.
+  runner.resume();
+  if (exception != nullptr) { std::rethrow_exception(exception); }
+  co_return result;
+}
+}  // namespace coro
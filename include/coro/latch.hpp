@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <coro/event.hpp>
+#include <coro/thread_pool.hpp>
+
+namespace coro {
+/**
+ * A single use countdown coroutines wait on with co_await until it reaches zero, waiting suspends
+ * the coroutine instead of blocking its thread and does not suspend at all once it reached zero.
+ *
+ * The count_down() reaching zero sets a manual reset Event, which resumes every waiter at once.
+ */
+class Latch {
+public:
+  /**
+    * @param expected The number of count_down() calls to wait for, the latch is open if it is not
+    *        positive.
+    */
+  explicit Latch(std::ptrdiff_t expected) noexcept
+      : event_(Event::ResetMode::Manual, expected <= 0), count_(expected) {}
+
+  /**
+    * @param threadPool Resumes the waiters once the latch opens, it must outlive the latch.
+    */
+  Latch(ThreadPool &threadPool, std::ptrdiff_t expected) noexcept
+      : event_(threadPool, Event::ResetMode::Manual, expected <= 0), count_(expected) {}
+  Latch(const Latch &)                     = delete;
+  Latch(Latch &&)                          = delete;
+  auto operator=(const Latch &) -> Latch & = delete;
+  auto operator=(Latch &&) -> Latch &      = delete;
+  ~Latch()                                 = default;
+
+  /**
+    * Suspends the awaiting coroutine until the count reached zero.
+    */
+  [[nodiscard]] auto operator co_await() noexcept -> Event::WaitOperation { return event_.operator co_await(); }
+
+  /**
+    * Decrements the count, the call reaching zero resumes the waiters.
+    */
+  auto count_down(std::ptrdiff_t count = 1) noexcept -> void {
+    auto previous = count_.fetch_sub(count, std::memory_order::acq_rel);
+    if (previous > 0 && previous <= count) { event_.set(); }
+  }
+
+  /**
+    * @return True if the count reached zero.
+    */
+  [[nodiscard]] auto try_wait() const noexcept -> bool { return event_.is_set(); }
+
+  /**
+    * @return The number of count_down() calls left, zero once the latch is open.
+    */
+  [[nodiscard]] auto remaining() const noexcept -> std::ptrdiff_t {
+    auto count = count_.load(std::memory_order::acquire);
+    return count > 0 ? count : 0;
+  }
+
+private:
+  Event event_;
+  std::atomic<std::ptrdiff_t> count_;
+};
+}  // namespace coro
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace coro {
+namespace detail {
+class AtomicLatencyHistogram;
+}  // namespace detail
+
+/**
+ * A histogram of durations in nanoseconds with HdrHistogram style log-linear buckets.  Every power
+ * of two range is split into subBucketCount_ linear buckets, so a value is known to within
+ * 1/subBucketCount_ of itself over the whole 64 bit range without any configuration.
+ */
+class LatencyHistogram {
+public:
+  static constexpr std::size_t subBucketBits_  = 4;
+  static constexpr std::size_t subBucketCount_ = std::size_t {1} << subBucketBits_;
+  static constexpr std::size_t bucketCount_    = (64 - subBucketBits_ + 1) * subBucketCount_;
+
+  /**
+   * @return The index of the bucket counting value.
+   */
+  static constexpr auto bucket_of(uint64_t value) noexcept -> std::size_t {
+    if (value < subBucketCount_) { return static_cast<std::size_t>(value); }
+    auto exponent = static_cast<std::size_t>(std::bit_width(value)) - 1;
+    auto shift    = exponent - subBucketBits_;
+    return (shift + 1) * subBucketCount_ + static_cast<std::size_t>((value >> shift) & (subBucketCount_ - 1));
+  }
+
+  /**
+   * @return The smallest value counted by bucket.
+   */
+  static constexpr auto lowest_of(std::size_t bucket) noexcept -> uint64_t {
+    auto range = bucket / subBucketCount_;
+    auto sub   = bucket % subBucketCount_;
+    return range == 0 ? sub : (subBucketCount_ + sub) << (range - 1);
+  }
+
+  /**
+   * @return The largest value counted by bucket.
+   */
+  static constexpr auto highest_of(std::size_t bucket) noexcept -> uint64_t {
+    auto range = bucket / subBucketCount_;
+    return range == 0 ? lowest_of(bucket) : lowest_of(bucket) + ((uint64_t {1} << (range - 1)) - 1);
+  }
+
+  auto record(uint64_t value, uint64_t count = 1) noexcept -> void {
+    if (count == 0) { return; }
+    counts_[bucket_of(value)] += count;
+    count_ += count;
+    sum_ += value * count;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+
+  auto merge(const LatencyHistogram &other) noexcept -> void {
+    for (std::size_t bucket = 0; bucket < bucketCount_; ++bucket) { counts_[bucket] += other.counts_[bucket]; }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+
+  /**
+   * @return The number of values recorded.
+   */
+  auto count() const noexcept -> uint64_t { return count_; }
+
+  /**
+   * @return The number of values recorded in bucket, see bucket_of().
+   */
+  auto count(std::size_t bucket) const noexcept -> uint64_t { return counts_[bucket]; }
+
+  /**
+   * @return The smallest value recorded, 0 if the histogram is empty.
+   */
+  auto min() const noexcept -> uint64_t { return count_ == 0 ? 0 : min_; }
+
+  /**
+   * @return The largest value recorded, 0 if the histogram is empty.
+   */
+  auto max() const noexcept -> uint64_t { return max_; }
+
+  /**
+   * @return The exact mean of the values recorded, 0 if the histogram is empty.
+   */
+  auto mean() const noexcept -> double {
+    return count_ == 0 ? 0.0 : static_cast<double>(sum_) / static_cast<double>(count_);
+  }
+
+  /**
+   * @param percentile In [0, 100], e.g. 99.9.
+   * @return The value at or below which percentile percent of the recorded values fall, reported
+   *         as the highest value of its bucket but never above max().  0 if the histogram is empty.
+   */
+  auto percentile(double percentile) const noexcept -> uint64_t {
+    if (count_ == 0) { return 0; }
+    auto share = std::clamp(percentile, 0.0, 100.0) / 100.0;
+    auto rank  = std::clamp<uint64_t>(static_cast<uint64_t>(std::ceil(share * static_cast<double>(count_))), 1, count_);
+
+    uint64_t seen {0};
+    for (std::size_t bucket = 0; bucket < bucketCount_; ++bucket) {
+      seen += counts_[bucket];
+      if (seen >= rank) { return std::min(highest_of(bucket), max_); }
+    }
+    return max_;
+  }
+
+private:
+  friend class detail::AtomicLatencyHistogram;
+
+  std::array<uint64_t, bucketCount_> counts_ {};
+  uint64_t count_ {0};
+  uint64_t sum_ {0};
+  uint64_t min_ {std::numeric_limits<uint64_t>::max()};
+  uint64_t max_ {0};
+};
+
+namespace detail {
+/**
+ * The recording side of a LatencyHistogram.  Written by a single thread with plain relaxed stores,
+ * any thread may copy it out with add_to() while it is being written.
+ */
+class AtomicLatencyHistogram {
+public:
+  auto record(uint64_t value) noexcept -> void {
+    bump(counts_[LatencyHistogram::bucket_of(value)], 1);
+    bump(sum_, value);
+    if (value < min_.load(std::memory_order::relaxed)) { min_.store(value, std::memory_order::relaxed); }
+    if (value > max_.load(std::memory_order::relaxed)) { max_.store(value, std::memory_order::relaxed); }
+  }
+
+  /**
+   * Adds the values recorded so far to histogram.  Not a consistent cut, values recorded
+   * concurrently may be seen in the buckets but not yet in the sum or the other way round.
+   */
+  auto add_to(LatencyHistogram &histogram) const noexcept -> void {
+    LatencyHistogram copy {};
+    for (std::size_t bucket = 0; bucket < LatencyHistogram::bucketCount_; ++bucket) {
+      auto count = counts_[bucket].load(std::memory_order::relaxed);
+      if (count == 0) { continue; }
+      copy.counts_[bucket] = count;
+      copy.count_ += count;
+      // Keeps min() and max() within the buckets seen even if their stores are not visible yet.
+      copy.min_ = std::min(copy.min_, LatencyHistogram::highest_of(bucket));
+      copy.max_ = std::max(copy.max_, LatencyHistogram::lowest_of(bucket));
+    }
+    if (copy.count_ == 0) { return; }
+    copy.sum_ = sum_.load(std::memory_order::relaxed);
+    copy.min_ = std::min(copy.min_, min_.load(std::memory_order::relaxed));
+    copy.max_ = std::max(copy.max_, max_.load(std::memory_order::relaxed));
+    histogram.merge(copy);
+  }
+
+private:
+  static auto bump(std::atomic<uint64_t> &counter, uint64_t value) noexcept -> void {
+    counter.store(counter.load(std::memory_order::relaxed) + value, std::memory_order::relaxed);
+  }
+
+  std::array<std::atomic<uint64_t>, LatencyHistogram::bucketCount_> counts_ {};
+  std::atomic<uint64_t> sum_ {0};
+  std::atomic<uint64_t> min_ {std::numeric_limits<uint64_t>::max()};
+  std::atomic<uint64_t> max_ {0};
+};
+}  // namespace detail
+}  // namespace coro
@@ -0,0 +1,125 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <coro/thread_pool.hpp>
+#include <coro/detail/waiter_list.hpp>
+
+namespace coro {
+/**
+ * Owns a lock taken with co_await m.scoped_lock(), releases it upon destructing.
+ */
+template <typename mutex_type>
+class ScopedLock {
+public:
+  ScopedLock(mutex_type &mutex, std::adopt_lock_t) noexcept : mutex_(&mutex) {}
+  ScopedLock(ScopedLock &&other) noexcept : mutex_(std::exchange(other.mutex_, nullptr)) {}
+  ScopedLock(const ScopedLock &)                     = delete;
+  auto operator=(const ScopedLock &) -> ScopedLock & = delete;
+  auto operator=(ScopedLock &&other) noexcept -> ScopedLock & {
+    if (std::addressof(other) != this) {
+      unlock();
+      mutex_ = std::exchange(other.mutex_, nullptr);
+    }
+    return *this;
+  }
+  ~ScopedLock() { unlock(); }
+
+  /**
+   * Releases the lock early, does nothing if it is no longer owned.
+   */
+  auto unlock() noexcept -> void {
+    if (mutex_ != nullptr) { std::exchange(mutex_, nullptr)->unlock(); }
+  }
+
+  auto owns_lock() const noexcept -> bool { return mutex_ != nullptr; }
+
+private:
+  mutex_type *mutex_;
+};
+
+/**
+ * A mutex for coroutines, waiting for it suspends the awaiting coroutine instead of blocking its
+ * thread.
+ *
+ * Locking and unlocking without contention is a single compare-and-swap.  Waiters push their
+ * awaiter, which lives in their frame, onto a lock-free stack, the holder reverses it into FIFO
+ * order when unlocking and hands the lock straight to the oldest waiter.  That waiter resumes on
+ * the thread pool given at construction, or inline on the unlocking thread otherwise.  Waiters
+ * resumed inline never nest, a waiter unlocking in turn queues the next one for the outermost
+ * unlock to resume, so however long the chain of waiters the stack does not grow.
+ */
+class Mutex {
+public:
+  /**
+    * The awaitable returned by lock().
+    */
+  class LockOperation : private detail::Waiter {
+    friend class Mutex;
+
+  public:
+    explicit LockOperation(Mutex &mutex) noexcept : mutex_(mutex) {}
+
+    auto await_ready() noexcept -> bool { return mutex_.try_lock(); }
+    auto await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool;
+    auto await_resume() const noexcept -> void {}
+
+  protected:
+    Mutex &mutex_;
+  };
+
+  /**
+    * The awaitable returned by scoped_lock().
+    */
+  class ScopedLockOperation : public LockOperation {
+  public:
+    using LockOperation::LockOperation;
+
+    auto await_resume() const noexcept -> ScopedLock<Mutex> { return ScopedLock<Mutex> {mutex_, std::adopt_lock}; }
+  };
+
+  Mutex() noexcept = default;
+
+  /**
+    * @param threadPool Resumes the waiters a lock is handed to, it must outlive the mutex.
+    */
+  explicit Mutex(ThreadPool &threadPool) noexcept : threadPool_(&threadPool) {}
+  Mutex(const Mutex &)                     = delete;
+  Mutex(Mutex &&)                          = delete;
+  auto operator=(const Mutex &) -> Mutex & = delete;
+  auto operator=(Mutex &&) -> Mutex &      = delete;
+  ~Mutex()                                 = default;
+
+  /**
+    * Suspends the awaiting coroutine until it holds the lock, it must call unlock() afterwards.
+    */
+  [[nodiscard]] auto lock() noexcept -> LockOperation { return LockOperation {*this}; }
+
+  /**
+    * Same as lock(), the lock is released when the ScopedLock produced by the awaitable destructs.
+    */
+  [[nodiscard]] auto scoped_lock() noexcept -> ScopedLockOperation { return ScopedLockOperation {*this}; }
+
+  /**
+    * @return True if the lock was free and is now held by the caller.
+    */
+  [[nodiscard]] auto try_lock() noexcept -> bool;
+
+  /**
+    * Releases the lock, or hands it to the oldest waiter.
+    */
+  auto unlock() noexcept -> void;
+
+private:
+  /// The lock is free, nullptr means it is held without waiters.
+  static auto unlocked() noexcept -> void * { return reinterpret_cast<void *>(std::uintptr_t {1}); }
+
+  ThreadPool *threadPool_ {nullptr};
+  /// unlocked(), nullptr, or the most recent waiter chained to the older ones through next_.
+  std::atomic<void *> state_ {unlocked()};
+  /// The waiters in FIFO order, only touched by the holder.
+  detail::Waiter *waiters_ {nullptr};
+};
+}  // namespace coro
@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <coro/thread_pool.hpp>
+#include <coro/detail/waiter_list.hpp>
+
+namespace coro {
+/**
+ * A counting semaphore for coroutines, acquiring it suspends the awaiting coroutine instead of
+ * blocking its thread and does not suspend at all while a unit is available.
+ *
+ * The semaphore is a single atomic word holding either the number of available units or, while
+ * none are available, the most recent waiter chained to the older ones through their awaiters.
+ * A release() hands its units to the oldest waiters and resumes all of them in one
+ * ThreadPool::resume() batch when a thread pool is given at construction, or inline on the
+ * releasing thread otherwise.  Concurrent release() calls are counted and the one that started
+ * counting hands out the units of all of them.  Once the waiters it took off the word before are
+ * used up it takes the newly arrived ones with a single compare-and-swap and reverses them into a
+ * FIFO kept for the following releases, so a release costs the waiters it resumes plus the ones
+ * that arrived since the previous take.
+ */
+class Semaphore {
+public:
+  /**
+    * The awaitable returned by acquire().
+    */
+  class AcquireOperation : private detail::Waiter {
+    friend class Semaphore;
+
+  public:
+    explicit AcquireOperation(Semaphore &semaphore) noexcept : semaphore_(semaphore) {}
+
+    auto await_ready() noexcept -> bool { return semaphore_.try_acquire(); }
+    auto await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool;
+    auto await_resume() const noexcept -> void {}
+
+  private:
+    Semaphore &semaphore_;
+  };
+
+  /**
+    * @param available The number of units available initially.
+    */
+  explicit Semaphore(std::ptrdiff_t available) noexcept : state_(units(available)) {}
+
+  /**
+    * @param threadPool Resumes the waiters release() hands units to, it must outlive the semaphore.
+    */
+  Semaphore(ThreadPool &threadPool, std::ptrdiff_t available) noexcept
+      : threadPool_(&threadPool), state_(units(available)) {}
+  Semaphore(const Semaphore &)                     = delete;
+  Semaphore(Semaphore &&)                          = delete;
+  auto operator=(const Semaphore &) -> Semaphore & = delete;
+  auto operator=(Semaphore &&) -> Semaphore &      = delete;
+  ~Semaphore()                                     = default;
+
+  /**
+    * Suspends the awaiting coroutine until it acquired a unit, it must release() it afterwards.
+    */
+  [[nodiscard]] auto acquire() noexcept -> AcquireOperation { return AcquireOperation {*this}; }
+
+  /**
+    * @return True if a unit was available and is now acquired by the caller.
+    */
+  [[nodiscard]] auto try_acquire() noexcept -> bool;
+
+  /**
+    * Makes units available, handing them to the oldest waiters first.
+    */
+  auto release(std::ptrdiff_t count = 1) noexcept -> void;
+
+  /**
+    * @return The number of units available, zero while coroutines wait.
+    */
+  [[nodiscard]] auto available() const noexcept -> std::ptrdiff_t;
+
+private:
+  /// Waiters are at least pointer aligned, a set low bit tags the number of available units.
+  static auto units(std::ptrdiff_t count) noexcept -> std::uintptr_t {
+    return static_cast<std::uintptr_t>(count) << 1 | 1;
+  }
+  static auto isUnits(std::uintptr_t state) noexcept -> bool { return (state & 1) != 0; }
+  static auto unitCount(std::uintptr_t state) noexcept -> std::ptrdiff_t {
+    return static_cast<std::ptrdiff_t>(state >> 1);
+  }
+
+  ThreadPool *threadPool_ {nullptr};
+  /// units(), or the most recent waiter chained to the older ones through next_.
+  std::atomic<std::uintptr_t> state_;
+  /// The units release() calls made and not handed out yet, the release() taking it off zero
+  /// hands them out until it is back to zero.
+  std::atomic<std::ptrdiff_t> pending_ {0};
+  /// The waiters taken off state_, oldest first, only touched by the release() handing out units.
+  /// They all waited longer than the ones on state_.
+  detail::Waiter *waiters_ {nullptr};
+};
+}  // namespace coro
@@ -0,0 +1,168 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <coro/mutex.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/detail/waiter_list.hpp>
+
+namespace coro {
+/**
+ * Owns a shared lock taken with co_await m.scoped_lock_shared(), releases it upon destructing.
+ */
+template <typename mutex_type>
+class SharedLock {
+public:
+  SharedLock(mutex_type &mutex, std::adopt_lock_t) noexcept : mutex_(&mutex) {}
+  SharedLock(SharedLock &&other) noexcept : mutex_(std::exchange(other.mutex_, nullptr)) {}
+  SharedLock(const SharedLock &)                     = delete;
+  auto operator=(const SharedLock &) -> SharedLock & = delete;
+  auto operator=(SharedLock &&other) noexcept -> SharedLock & {
+    if (std::addressof(other) != this) {
+      unlock();
+      mutex_ = std::exchange(other.mutex_, nullptr);
+    }
+    return *this;
+  }
+  ~SharedLock() { unlock(); }
+
+  /**
+   * Releases the lock early, does nothing if it is no longer owned.
+   */
+  auto unlock() noexcept -> void {
+    if (mutex_ != nullptr) { std::exchange(mutex_, nullptr)->unlock_shared(); }
+  }
+
+  auto owns_lock() const noexcept -> bool { return mutex_ != nullptr; }
+
+private:
+  mutex_type *mutex_;
+};
+
+/**
+ * A readers-writer lock for coroutines, waiting for it suspends the awaiting coroutine instead of
+ * blocking its thread.
+ *
+ * The lock state is a single word holding the number of readers, a writer bit and a waiting bit,
+ * so locking and unlocking without contention is a single compare-and-swap.  Waiters are queued
+ * in FIFO order through their awaiters under a short internal lock that is never held while a
+ * coroutine runs.  Once any waiter is queued new readers queue behind it, so writers are not
+ * starved.  A writer releasing the lock hands it to the next writer or to all the readers queued
+ * in a row before the next writer, they resume on the thread pool given at construction or inline
+ * on the unlocking thread otherwise, without nesting like Mutex's waiters.
+ */
+class SharedMutex {
+public:
+  /**
+    * The awaitable returned by lock() and lock_shared().
+    */
+  class LockOperation : private detail::Waiter {
+    friend class SharedMutex;
+
+  public:
+    LockOperation(SharedMutex &mutex, bool shared) noexcept : mutex_(mutex), shared_(shared) {}
+
+    auto await_ready() noexcept -> bool { return shared_ ? mutex_.try_lock_shared() : mutex_.try_lock(); }
+    auto await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool;
+    auto await_resume() const noexcept -> void {}
+
+  protected:
+    SharedMutex &mutex_;
+
+  private:
+    bool shared_;
+  };
+
+  /**
+    * The awaitable returned by scoped_lock().
+    */
+  class ScopedLockOperation : public LockOperation {
+  public:
+    explicit ScopedLockOperation(SharedMutex &mutex) noexcept : LockOperation(mutex, false) {}
+
+    auto await_resume() const noexcept -> ScopedLock<SharedMutex> {
+      return ScopedLock<SharedMutex> {mutex_, std::adopt_lock};
+    }
+  };
+
+  /**
+    * The awaitable returned by scoped_lock_shared().
+    */
+  class SharedLockOperation : public LockOperation {
+  public:
+    explicit SharedLockOperation(SharedMutex &mutex) noexcept : LockOperation(mutex, true) {}
+
+    auto await_resume() const noexcept -> SharedLock<SharedMutex> {
+      return SharedLock<SharedMutex> {mutex_, std::adopt_lock};
+    }
+  };
+
+  SharedMutex() noexcept = default;
+
+  /**
+    * @param threadPool Resumes the waiters a lock is handed to, it must outlive the mutex.
+    */
+  explicit SharedMutex(ThreadPool &threadPool) noexcept : threadPool_(&threadPool) {}
+  SharedMutex(const SharedMutex &)                     = delete;
+  SharedMutex(SharedMutex &&)                          = delete;
+  auto operator=(const SharedMutex &) -> SharedMutex & = delete;
+  auto operator=(SharedMutex &&) -> SharedMutex &      = delete;
+  ~SharedMutex()                                       = default;
+
+  /**
+    * Suspends the awaiting coroutine until it holds the lock exclusively, it must call unlock()
+    * afterwards.
+    */
+  [[nodiscard]] auto lock() noexcept -> LockOperation { return LockOperation {*this, false}; }
+
+  /**
+    * Same as lock(), the lock is released when the ScopedLock produced by the awaitable destructs.
+    */
+  [[nodiscard]] auto scoped_lock() noexcept -> ScopedLockOperation { return ScopedLockOperation {*this}; }
+
+  /**
+    * Suspends the awaiting coroutine until it shares the lock with other readers, it must call
+    * unlock_shared() afterwards.
+    */
+  [[nodiscard]] auto lock_shared() noexcept -> LockOperation { return LockOperation {*this, true}; }
+
+  /**
+    * Same as lock_shared(), the lock is released when the SharedLock produced by the awaitable
+    * destructs.
+    */
+  [[nodiscard]] auto scoped_lock_shared() noexcept -> SharedLockOperation { return SharedLockOperation {*this}; }
+
+  /**
+    * @return True if the lock was free and is now held exclusively by the caller.
+    */
+  [[nodiscard]] auto try_lock() noexcept -> bool;
+
+  /**
+    * @return True if neither a writer holds the lock nor anyone waits for it, the caller now
+    *         shares it.
+    */
+  [[nodiscard]] auto try_lock_shared() noexcept -> bool;
+
+  auto unlock() noexcept -> void;
+  auto unlock_shared() noexcept -> void;
+
+private:
+  static constexpr uint64_t writer_  = uint64_t {1} << 63;
+  static constexpr uint64_t waiting_ = uint64_t {1} << 62;
+
+  ThreadPool *threadPool_ {nullptr};
+  /// The number of readers, writer_ while held exclusively, waiting_ while anyone is queued.
+  std::atomic<uint64_t> state_ {0};
+  /// Guards the queue, and state_ while waiting_ is set.
+  std::mutex waitMutex_;
+  LockOperation *head_ {nullptr};
+  LockOperation *tail_ {nullptr};
+
+  /**
+    * Hands the released lock to the front of the queue, waitMutex_ must be held by lk.
+    */
+  auto wake(std::unique_lock<std::mutex> &lk) noexcept -> void;
+};
+}  // namespace coro
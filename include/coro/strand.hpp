@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/detail/mpsc_queue.hpp>
+
+namespace coro::detail {
+/**
+ * A coroutine queued on a Strand, embedded in its awaiter.
+ */
+struct StrandNode {
+  std::atomic<StrandNode *> next_ {nullptr};
+  std::coroutine_handle<> handle_ {nullptr};
+};
+}  // namespace coro::detail
+
+namespace coro {
+/**
+ * Serializes coroutines on a ThreadPool without a mutex or a dedicated thread, e.g. all the
+ * coroutines working on one connection.
+ *
+ * A coroutine that awaits schedule() continues on the strand: it runs on one of the pool's
+ * executors, exclusively among the coroutines on the same strand and in the order they awaited
+ * schedule(), until it suspends again.  The awaiters are queued in a lock-free intrusive MPSC
+ * queue living in their frames, so scheduling onto a strand never allocates or blocks.  The first
+ * coroutine queued on an idle strand activates the strand's drainer on the thread pool, which
+ * resumes up to drainBatch coroutines in a row on its executor before it queues itself behind the
+ * pool's other work, so an activation costs one thread pool slot for the whole batch.
+ */
+class Strand {
+public:
+  /**
+    * The awaitable returned by schedule().
+    */
+  class ScheduleOperation {
+    friend class Strand;
+
+  public:
+    explicit ScheduleOperation(Strand &strand) noexcept : strand_(strand) {}
+
+    auto await_ready() const noexcept -> bool { return false; }
+    auto await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> void;
+    auto await_resume() const noexcept -> void {}
+
+  private:
+    Strand &strand_;
+    detail::StrandNode node_ {};
+  };
+
+  /**
+    * @param threadPool Runs the strand's coroutines, it must outlive the strand.
+    * @param drainBatch The most coroutines resumed per activation before the strand yields its
+    *        executor to the rest of the thread pool, at least 1.
+    */
+  explicit Strand(ThreadPool &threadPool, uint32_t drainBatch = 64);
+  Strand(const Strand &)                     = delete;
+  Strand(Strand &&)                          = delete;
+  auto operator=(const Strand &) -> Strand & = delete;
+  auto operator=(Strand &&) -> Strand &      = delete;
+  /**
+    * No coroutine may be scheduled on the strand anymore.
+    */
+  ~Strand() = default;
+
+  /**
+    * Continues the awaiting coroutine on the strand, once the coroutines scheduled before it
+    * suspended.  When the thread pool is shut down the strand runs on the thread scheduling onto
+    * the idle strand instead.
+    */
+  [[nodiscard]] auto schedule() noexcept -> ScheduleOperation { return ScheduleOperation {*this}; }
+
+  /**
+    * @return True if called from a coroutine running on this strand.
+    */
+  auto running_in_this_thread() const noexcept -> bool;
+
+  auto thread_pool() const noexcept -> ThreadPool & { return threadPool_; }
+
+private:
+  /**
+    * The drainer's await after every batch, it parks the drainer when the strand went idle and
+    * queues it on the thread pool otherwise.
+    */
+  struct Reschedule {
+    Strand &strand_;
+    uint64_t ran_;
+
+    auto await_ready() const noexcept -> bool { return false; }
+    auto await_suspend(std::coroutine_handle<> drainer) noexcept -> bool;
+    auto await_resume() const noexcept -> void {}
+  };
+
+  /**
+    * Queues node and activates the drainer if the strand was idle.
+    */
+  auto post(detail::StrandNode &node) noexcept -> void;
+
+  /**
+    * Runs the queued coroutines in batches for as long as the strand is busy, never completes.
+    */
+  auto drain() -> Task<void>;
+
+  ThreadPool &threadPool_;
+  const uint32_t drainBatch_;
+  detail::IntrusiveMpscQueue<detail::StrandNode> queue_ {};
+  /// The coroutines queued and not run yet, the strand is idle and the drainer parked at 0.
+  alignas(64) std::atomic<uint64_t> pending_ {0};
+  Task<void> drainer_;
+};
+}  // namespace coro
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <coro/detail/promise_allocator.hpp>
+
+#define AWAITABLE_IMPL_INL_H
+#include <coro/concepts/awaitable.hpp>
+
+namespace coro {
+namespace detail {
+/**
+ * One-shot event a regular thread blocks on until a coroutine completes.  Blocks on a futex
+ * instead of a mutex and condition variable.
+ *
+ * The waiter returns, and usually destroys the event on its stack, as soon as it sees the event
+ * set, so set() must not touch the event after setting it.  It wakes the futex by address, which
+ * is harmless once the event is gone, rather than through std::atomic::notify_one().
+ */
+class SyncWaitEvent {
+public:
+  SyncWaitEvent() noexcept                                 = default;
+  SyncWaitEvent(const SyncWaitEvent &)                     = delete;
+  SyncWaitEvent(SyncWaitEvent &&)                          = delete;
+  auto operator=(const SyncWaitEvent &) -> SyncWaitEvent & = delete;
+  auto operator=(SyncWaitEvent &&) -> SyncWaitEvent &      = delete;
+  ~SyncWaitEvent()                                         = default;
+
+  auto set() noexcept -> void;
+
+  auto wait() noexcept -> void;
+
+private:
+  static constexpr uint32_t unset_    = 0;
+  static constexpr uint32_t signaled_ = 1;
+  /// The waiter is about to sleep or sleeps on the futex, set() has to wake it.
+  static constexpr uint32_t sleeping_ = 2;
+
+  std::atomic<uint32_t> state_ {unset_};
+};
+
+class SyncWaitTaskPromiseBase : public PromiseAllocator {
+public:
+  /**
+   * Wakes the waiting thread once the wrapper coroutine has suspended for the last time, the
+   * waiting thread then owns the frame and destroys it.
+   */
+  struct CompletionNotifier {
+    auto await_ready() const noexcept -> bool { return false; }
+
+    template <typename promise_type>
+    auto await_suspend(std::coroutine_handle<promise_type> coroutine) noexcept -> void {
+      coroutine.promise().event_->set();
+    }
+
+    auto await_resume() noexcept -> void {}
+  };
+
+  SyncWaitTaskPromiseBase() noexcept = default;
+  ~SyncWaitTaskPromiseBase()         = default;
+
+  auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+  auto final_suspend() noexcept -> CompletionNotifier { return {}; }
+  auto unhandled_exception() noexcept -> void { exception_ = std::current_exception(); }
+
+protected:
+  SyncWaitEvent *event_ {nullptr};
+  std::exception_ptr exception_ {nullptr};
+};
+
+template <typename return_type>
+class SyncWaitTask;
+
+template <typename return_type>
+class SyncWaitTaskPromise final : public SyncWaitTaskPromiseBase {
+public:
+  using coroutine_type = std::coroutine_handle<SyncWaitTaskPromise<return_type>>;
+
+  auto get_return_object() noexcept -> SyncWaitTask<return_type> {
+    return SyncWaitTask<return_type> {coroutine_type::from_promise(*this)};
+  }
+
+  auto start(SyncWaitEvent &event) -> void {
+    event_ = &event;
+    coroutine_type::from_promise(*this).resume();
+  }
+
+  /**
+   * The awaited value is not copied into the promise, the wrapper suspends inside the co_yield
+   * full-expression so the value stays alive until the waiting thread has taken it.
+   */
+  auto yield_value(return_type &&value) noexcept -> CompletionNotifier {
+    value_ = std::addressof(value);
+    return {};
+  }
+
+  auto return_void() noexcept -> void {}
+
+  auto result() -> return_type && {
+    if (exception_) { std::rethrow_exception(exception_); }
+    return static_cast<return_type &&>(*value_);
+  }
+
+private:
+  std::remove_reference_t<return_type> *value_ {nullptr};
+};
+
+template <>
+class SyncWaitTaskPromise<void> final : public SyncWaitTaskPromiseBase {
+public:
+  using coroutine_type = std::coroutine_handle<SyncWaitTaskPromise<void>>;
+
+  auto get_return_object() noexcept -> SyncWaitTask<void>;
+
+  auto start(SyncWaitEvent &event) -> void {
+    event_ = &event;
+    coroutine_type::from_promise(*this).resume();
+  }
+
+  auto return_void() noexcept -> void {}
+
+  auto result() -> void {
+    if (exception_) { std::rethrow_exception(exception_); }
+  }
+};
+
+/**
+ * The coroutine wrapping the awaitable given to sync_wait(), owned by the waiting thread.
+ */
+template <typename return_type>
+class SyncWaitTask {
+public:
+  using promise_type   = SyncWaitTaskPromise<return_type>;
+  using coroutine_type = std::coroutine_handle<promise_type>;
+
+  explicit SyncWaitTask(coroutine_type coroutine) noexcept : coroutine_(coroutine) {}
+  SyncWaitTask(const SyncWaitTask &) = delete;
+  SyncWaitTask(SyncWaitTask &&other) noexcept : coroutine_(std::exchange(other.coroutine_, nullptr)) {}
+  auto operator=(const SyncWaitTask &) -> SyncWaitTask & = delete;
+  auto operator=(SyncWaitTask &&) -> SyncWaitTask &      = delete;
+
+  ~SyncWaitTask() {
+    if (coroutine_ != nullptr) { coroutine_.destroy(); }
+  }
+
+  auto promise() -> promise_type & { return coroutine_.promise(); }
+
+private:
+  coroutine_type coroutine_ {nullptr};
+};
+
+inline auto SyncWaitTaskPromise<void>::get_return_object() noexcept -> SyncWaitTask<void> {
+  return SyncWaitTask<void> {coroutine_type::from_promise(*this)};
+}
+
+template <concepts::awaitable awaitable_type,
+    typename return_type = typename concepts::awaitable_traits<awaitable_type>::awaiter_return_type>
+auto makeSyncWaitTask(awaitable_type &&a) -> SyncWaitTask<return_type> {
+  if constexpr (std::is_void_v<return_type>) {
+    co_await std::forward<awaitable_type>(a);
+    co_return;
+  } else {
+    co_yield co_await std::forward<awaitable_type>(a);
+  }
+}
+}  // namespace detail
+
+/**
+ * Blocks the calling thread until the awaitable completes, e.g. a coro::Task that moves itself
+ * onto a coro::ThreadPool.  The only allocation is the wrapper coroutine's frame, the calling
+ * thread sleeps on a futex rather than a mutex and condition variable.
+ * @param a The awaitable to wait on.
+ * @return The awaitable's result, references are passed through.
+ * @throw Rethrows anything the awaitable threw.
+ */
+template <concepts::awaitable awaitable_type,
+    typename return_type = typename concepts::awaitable_traits<awaitable_type>::awaiter_return_type>
+auto sync_wait(awaitable_type &&a) -> return_type {
+  detail::SyncWaitEvent event {};
+  auto task = detail::makeSyncWaitTask(std::forward<awaitable_type>(a));
+  task.promise().start(event);
+  event.wait();
+
+  if constexpr (std::is_void_v<return_type> || std::is_reference_v<return_type>) {
+    return task.promise().result();
+  } else if constexpr (std::is_move_constructible_v<return_type>) {
+    return std::move(task.promise().result());
+  } else {
+    return static_cast<const return_type &>(task.promise().result());
+  }
+}
+}  // namespace coro
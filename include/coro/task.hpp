@@ -1,29 +1,42 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <concepts>
 #include <coroutine>
 #include <exception>
 #include <stdexcept>
+#include <stop_token>
 #include <type_traits>
 #include <utility>
 #include <variant>
 
+#include <coro/detail/promise_allocator.hpp>
+#include <coro/detail/trace_buffer.hpp>
+#include <coro/detail/when_all_latch.hpp>
+
 namespace coro {
 template <typename return_type = void>
 class Task;
 namespace detail {
-struct PromiseBase {
+struct PromiseBase : public PromiseAllocator {
   friend struct FinalAwaitable;
   struct FinalAwaitable {
     auto await_ready() const noexcept -> bool { return false; }
 
     template <typename promise_type>
     auto await_suspend(std::coroutine_handle<promise_type> coroutine) noexcept -> std::coroutine_handle<> {
-      // If there is a continuation call it, otherwise this is the end of the line
-      auto &promise = coroutine.promise();
-      if (promise.continuation_ != nullptr) {
-        return promise.continuation_;
-      } else {
+      // If there is a continuation call it, otherwise this is the end of the line.  A when_all()
+      // child counts down the latch instead, the frame may be destroyed as soon as it did.
+      auto continuation = coroutine.promise().continuation_;
+      if (continuation == nullptr) {
         return std::noop_coroutine();
+      } else if (auto *latch = WhenAllLatch::from_continuation(continuation)) {
+        trace(TraceEvent::Continuation, coroutine.address(), latch);
+        return latch->notify();
+      } else {
+        trace(TraceEvent::Continuation, coroutine.address(), continuation.address());
+        return continuation;
       }
     }
 
@@ -36,9 +49,45 @@ struct PromiseBase {
   auto initial_suspend() noexcept { return std::suspend_always {}; }
   auto final_suspend() noexcept { return FinalAwaitable {}; }
   auto continuation(std::coroutine_handle<> continuation) noexcept -> void { continuation_ = continuation; }
+  auto continuation(WhenAllLatch &latch) noexcept -> void { continuation_ = latch.as_continuation(); }
+
+  /**
+   * Sets the stop token this coroutine observes through this_task::stop_requested(), the tasks it
+   * awaits inherit it unless they have a stop token of their own.
+   */
+  auto stop_token(std::stop_token token) noexcept -> void { stopToken_ = std::move(token); }
+  auto stop_token() const noexcept -> const std::stop_token & { return stopToken_; }
+
+  /**
+   * Sets the absolute deadline after which this_task::stop_requested() is true, the tasks it
+   * awaits inherit the earlier of their own and this deadline.
+   */
+  auto deadline(std::chrono::steady_clock::time_point deadline) noexcept -> void { deadline_ = deadline; }
+  auto deadline() const noexcept -> std::chrono::steady_clock::time_point { return deadline_; }
+
+  /**
+   * @return True if a stop was requested or the deadline passed.  Only reads the clock if there
+   *         is a deadline.
+   */
+  auto stop_requested() const noexcept -> bool {
+    return stopToken_.stop_requested() ||
+           (deadline_ != noDeadline && std::chrono::steady_clock::now() >= deadline_);
+  }
+
+  /**
+   * Called when the coroutine is awaited by parent.
+   */
+  auto inherit_cancellation(const PromiseBase &parent) noexcept -> void {
+    if (!stopToken_.stop_possible()) { stopToken_ = parent.stopToken_; }
+    deadline_ = std::min(deadline_, parent.deadline_);
+  }
+
+  static constexpr std::chrono::steady_clock::time_point noDeadline = std::chrono::steady_clock::time_point::max();
 
 protected:
   std::coroutine_handle<> continuation_ {nullptr};
+  std::stop_token stopToken_ {};
+  std::chrono::steady_clock::time_point deadline_ {noDeadline};
 };
 
 template <typename return_type>
@@ -162,8 +211,14 @@ public:
     AwaitableBase(coroutine_handle coroutine) noexcept : coroutine_(coroutine) {}
     auto await_ready() const noexcept -> bool { return !coroutine_ || coroutine_.done(); }
 
-    auto await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> std::coroutine_handle<> {
+    template <typename awaiting_promise_type>
+    auto await_suspend(std::coroutine_handle<awaiting_promise_type> awaitingCoroutine) noexcept
+        -> std::coroutine_handle<> {
+      if constexpr (std::derived_from<awaiting_promise_type, detail::PromiseBase>) {
+        coroutine_.promise().inherit_cancellation(awaitingCoroutine.promise());
+      }
       coroutine_.promise().continuation(awaitingCoroutine);
+      detail::trace(detail::TraceEvent::Suspend, awaitingCoroutine.address(), coroutine_.address());
       return coroutine_;
     }
 
@@ -246,5 +301,72 @@ inline auto Promise<void>::get_return_object() noexcept -> Task<> {
   return Task<> {coroutine_handle::from_promise(*this)};
 }
 
+/**
+ * Never suspends, reads the awaiting coroutine's cancellation state through the handle it is given.
+ */
+struct StopRequestedOperation {
+  auto await_ready() const noexcept -> bool { return false; }
+
+  template <std::derived_from<PromiseBase> promise_type>
+  auto await_suspend(std::coroutine_handle<promise_type> coroutine) noexcept -> bool {
+    stopRequested_ = coroutine.promise().stop_requested();
+    return false;
+  }
+
+  auto await_resume() const noexcept -> bool { return stopRequested_; }
+
+  bool stopRequested_ {false};
+};
+
+struct StopTokenOperation {
+  auto await_ready() const noexcept -> bool { return false; }
+
+  template <std::derived_from<PromiseBase> promise_type>
+  auto await_suspend(std::coroutine_handle<promise_type> coroutine) noexcept -> bool {
+    promise_ = &coroutine.promise();
+    return false;
+  }
+
+  auto await_resume() const noexcept -> std::stop_token { return promise_->stop_token(); }
+
+  const PromiseBase *promise_ {nullptr};
+};
+
+struct DeadlineOperation {
+  auto await_ready() const noexcept -> bool { return false; }
+
+  template <std::derived_from<PromiseBase> promise_type>
+  auto await_suspend(std::coroutine_handle<promise_type> coroutine) noexcept -> bool {
+    deadline_ = coroutine.promise().deadline();
+    return false;
+  }
+
+  auto await_resume() const noexcept -> std::chrono::steady_clock::time_point { return deadline_; }
+
+  std::chrono::steady_clock::time_point deadline_ {PromiseBase::noDeadline};
+};
 }  // namespace detail
+
+/**
+ * Cooperative cancellation of the current coro::Task.  A task observes the stop token and deadline
+ * set on its promise, or inherited from the task awaiting it, so setting them on the root of a task
+ * tree reaches every task it awaits.  Nothing is cancelled forcibly, long running tasks check
+ * stop_requested() at convenient points and return early.
+ */
+namespace this_task {
+/**
+ * @return An awaitable producing true if a stop was requested or the deadline passed, it never suspends.
+ */
+[[nodiscard]] inline auto stop_requested() noexcept -> detail::StopRequestedOperation { return {}; }
+
+/**
+ * @return An awaitable producing the current task's stop token, e.g. to register a std::stop_callback.
+ */
+[[nodiscard]] inline auto stop_token() noexcept -> detail::StopTokenOperation { return {}; }
+
+/**
+ * @return An awaitable producing the current task's deadline, PromiseBase::noDeadline if there is none.
+ */
+[[nodiscard]] inline auto deadline() noexcept -> detail::DeadlineOperation { return {}; }
+}  // namespace this_task
 }  // namespace coro
@@ -1,11 +1,18 @@
 #pragma once
+#include <array>
+#include <chrono>
 #include <coroutine>
-#include <deque>
 #include <functional>
 #include <memory>
+#include <memory_resource>
 #include <ranges>
+#include <span>
 #include <thread>
+#include <vector>
+#include <coro/latency_histogram.hpp>
 #include <coro/task.hpp>
+#include <coro/detail/intrusive_queue.hpp>
+#include <coro/detail/work_stealing_deque.hpp>
 
 #define RANGE_OF_IMPL_INL_H
 #include <coro/concepts/range_of.hpp>
@@ -14,10 +21,32 @@
 #include <mutex>
 
 namespace coro {
+namespace detail {
+class TaskSelfDeleting;
+#if defined(CORO_THREAD_POOL_METRICS)
+/// A queued coroutine and when it was queued, defined in thread_pool.cpp.
+struct TimedHandle;
+using QueuedHandle = TimedHandle;
+#else
+using QueuedHandle = std::coroutine_handle<>;
+#endif
+}  // namespace detail
+
 /**
  * Creates a thread pool that executes arbitrary coroutine tasks in a FIFO scheduler policy.
  * The thread pool by default will create an execution thread per available core on the system.
  *
+ * Optionally the thread pool can run in a work-stealing mode, see SchedulePolicy::WorkStealing.
+ *
+ * Work is queued in one FIFO lane per Priority, executors take higher priority work first and
+ * periodically serve the lower lanes first so they are never starved, see Options::agingInterval_.
+ *
+ * Executors can be pinned to cpus and grouped by NUMA node, each node then has its own queues and
+ * executors only take work from other nodes once their own node ran dry, see Options::numaAware_.
+ *
+ * Built with CORO_THREAD_POOL_METRICS the executors count what they do and time every coroutine
+ * they run, see metrics().  Without it none of that is compiled in.
+ *
  * When shutting down, either by the thread pool destructing or by manually calling shutdown()
  * the thread pool will stop accepting new tasks but will complete all tasks that were scheduled
  * prior to the shutdown request.
@@ -29,6 +58,22 @@ class ThreadPool final : public std::enable_shared_from_this<ThreadPool> {
   };
 
 public:
+  /**
+    * The lane a coroutine is queued in, executors take the highest priority work first.
+    */
+  enum class Priority : uint8_t {
+    /// Latency critical work, e.g. RPC continuations.  Never goes to an executor's local deque so
+    /// any idle executor can pick it up immediately.
+    High,
+    /// The default.
+    Normal,
+    /// Bulk work that should only use otherwise idle capacity, e.g. compactions.
+    Low,
+  };
+
+  /// The number of Priority lanes.
+  static constexpr std::size_t priorityCount = 3;
+
   /**
     * A schedule operation is an awaitable type with a coroutine to resume the task scheduled on one of
     * the executor threads.
@@ -38,8 +83,10 @@ public:
     /**
       * Only thread_pools can create schedule operations when a task is being scheduled.
       * @param tp The thread pool that created this schedule operation.
+      * @param priority The lane to queue the awaiting coroutine in.
+      * @param runNext Place the awaiting coroutine in the calling executor's next slot, see schedule_local().
       */
-    explicit ScheduleOperation(ThreadPool &_tp) noexcept;
+    explicit ScheduleOperation(ThreadPool &_tp, Priority priority, bool runNext = false) noexcept;
 
   public:
     /**
@@ -50,8 +97,10 @@ public:
     /**
       * Suspending always returns to the caller (using void return of await_suspend()) and
       * stores the coroutine internally for the executing thread to resume from.
+      * @throw std::runtime_error If called from outside of the thread pool while the submission
+      *        queue is full, the awaiting coroutine is resumed with the exception.
     */
-    auto await_suspend(std::coroutine_handle<> awaiting_coroutine) noexcept -> void;
+    auto await_suspend(std::coroutine_handle<> awaiting_coroutine) -> void;
 
     /**
       * no-op as this is the function called first by the thread pool's executing thread.
@@ -60,12 +109,81 @@ public:
 
   private:
     ThreadPool &threadPool_;
+    Priority priority_;
+    bool runNext_;
+    /// Links the awaiting coroutine into an overflow queue without allocating, the operation lives
+    /// in the suspended coroutine's frame until it is resumed.
+    detail::ReadyNode node_ {};
+  };
+
+  /**
+    * How the executor threads share the scheduled coroutines.
+    */
+  enum class SchedulePolicy : uint8_t {
+    /// A single FIFO queue shared by all executor threads.
+    Fifo,
+    /// Each executor thread owns a local deque, coroutines resumed from an executor thread go to
+    /// its own deque (LIFO for the owner) and idle executors steal the oldest entries from the
+    /// others. Submissions from outside of the thread pool go to the shared FIFO queue.
+    WorkStealing,
+  };
+
+  /**
+    * How executor threads are pinned to cpus.
+    */
+  enum class AffinityPolicy : uint8_t {
+    /// Executors are not pinned, the operating system places them.
+    None,
+    /// Executors fill the cpus of the first NUMA node before moving on to the next one.
+    Compact,
+    /// Executors are spread round robin over the NUMA nodes.
+    Scatter,
   };
 
   struct Options {
     /// The number of executor threads for this thread pool.  Uses the hardware concurrency
     /// value by default.
     uint32_t threadCount_ = std::thread::hardware_concurrency();
+    /// The scheduling policy, FIFO by default.
+    SchedulePolicy policy_ = SchedulePolicy::Fifo;
+    /// The capacity of each executor's local deque when using SchedulePolicy::WorkStealing,
+    /// rounded up to a power of two.  Overflowing coroutines go to the shared queue.
+    std::size_t localQueueCapacity_ = 256;
+    /// The capacity of each priority lane's lock-free submission queue, per NUMA node when numaAware_,
+    /// rounded up to a power of two.
+    /// Submissions from outside of the thread pool are rejected while it is full, executor
+    /// threads spill into a mutex guarded overflow queue instead so no continuation is lost.
+    std::size_t submissionQueueCapacity_ = 16384;
+    /// Anti-starvation aging: every agingInterval_-th dequeue of an executor looks at the lanes
+    /// from the lowest priority up, so a lower priority lane gets at least that share of every
+    /// executor while it has work.  0 serves strictly by priority.
+    uint32_t agingInterval_ = 32;
+    /// A normal priority coroutine an executor readies with resume(), e.g. the waiter of an Event
+    /// it sets, or moves with schedule_local() goes into the executor's next slot and runs right
+    /// after the current coroutine on the same thread, its cache lines still warm.  A coroutine
+    /// readied while the slot is taken pushes the older one to the queue.  This caps the coroutines
+    /// an executor runs from its next slot in a row before it serves the queues, 0 disables the slot.
+    /// An executor about to park takes the coroutines waiting in the other executors' next slots.
+    uint32_t nextSlotBudget_ = 3;
+    /// The idle strategy: an executor that runs out of work first polls for new work this many
+    /// times with a cpu pause in between, then idleYieldCount_ times with std::this_thread::yield()
+    /// in between, and only then parks on the condition variable.  Spinning executors are woken
+    /// without a futex call, raising the budget trades idle CPU for lower wakeup latency.
+    uint32_t idleSpinCount_ = 128;
+    /// See idleSpinCount_.
+    uint32_t idleYieldCount_ = 2;
+    /// How the executors are pinned to the cpus the process may run on, ignored if cpus_ is set.
+    AffinityPolicy affinity_ = AffinityPolicy::None;
+    /// Explicit cpus to pin the executors to, executor i is pinned to cpus_[i % cpus_.size()].
+    /// Pinning is best effort, an executor that can't be pinned keeps running unpinned.
+    std::vector<uint32_t> cpus_ {};
+    /// Groups pinned executors by NUMA node: every node gets its own submission queues, coroutines
+    /// submitted from a node's cpu are queued on that node and executors prefer the work and the
+    /// deques of their own node.  Unpinned executors all share the first group.
+    bool numaAware_ = false;
+    /// Overrides the NUMA nodes read from /sys/devices/system/node, each entry lists the cpus of
+    /// one node.  E.g. to group executors by shared L3 cache instead.
+    std::vector<std::vector<uint32_t>> nodeCpus_ {};
     /// Functor to call on each executor thread upon starting execution.  The parameter is the
     /// thread's ID assigned to it by the thread pool.
     std::function<void(std::size_t)> onThreadStart_ = nullptr;
@@ -74,6 +192,49 @@ public:
     std::function<void(std::size_t)> onThreadStop_ = nullptr;
   };
 
+  /// Are metrics() collected, see CORO_THREAD_POOL_METRICS.
+#if defined(CORO_THREAD_POOL_METRICS)
+  static constexpr bool metricsEnabled = true;
+#else
+  static constexpr bool metricsEnabled = false;
+#endif
+
+  /**
+    * The counters of one executor thread, see metrics().
+    */
+  struct WorkerMetrics {
+    /// The number of coroutines the executor resumed.
+    uint64_t executed_ {0};
+    /// The number of coroutines taken from other executors' local deques.
+    uint64_t steals_ {0};
+    /// The number of times the executor ran out of work and parked on the condition variable.
+    uint64_t parks_ {0};
+    /// The number of parks that ended with work to run, the rest were woken for nothing or shutdown.
+    uint64_t wakeups_ {0};
+    /// The time spent resuming coroutines.
+    std::chrono::nanoseconds busy_ {0};
+    /// The time spent spinning, yielding and parked while out of work.
+    std::chrono::nanoseconds idle_ {0};
+  };
+
+  /**
+    * A snapshot of the thread pool's metrics, see metrics().
+    */
+  struct Metrics {
+    /// Indexed by the executor's thread ID.
+    std::vector<WorkerMetrics> workers_ {};
+    /// The time from queueing a coroutine to an executor resuming it, in nanoseconds.  Coroutines an
+    /// executor queues on its own local deque in work-stealing mode are not timed.
+    LatencyHistogram queueWait_ {};
+    /// The time each resumed coroutine ran until it suspended or completed, in nanoseconds.
+    LatencyHistogram runTime_ {};
+
+    /**
+      * @return The counters summed over all executors.
+      */
+    auto total() const noexcept -> WorkerMetrics;
+  };
+
   /**
      * @see thread_pool::make_shared
      */
@@ -85,9 +246,12 @@ public:
      * @param opts The thread pool's options.
      * @return std::shared_ptr<thread_pool>
      */
-  static auto makeShared(Options opts = Options {.threadCount_ = std::thread::hardware_concurrency(),
-                             .onThreadStart_                   = nullptr,
-                             .onThreadStop_                    = nullptr}) -> std::shared_ptr<ThreadPool>;
+  static auto makeShared(Options opts) -> std::shared_ptr<ThreadPool>;
+
+  /**
+     * @brief Creates a thread pool executor with the default options.
+     */
+  static auto makeShared() -> std::shared_ptr<ThreadPool>;
   ThreadPool(const ThreadPool &)                     = delete;
   ThreadPool(ThreadPool &&)                          = delete;
   auto operator=(const ThreadPool &) -> ThreadPool & = delete;
@@ -107,64 +271,109 @@ public:
      * @return The schedule operation to switch from the calling scheduling thread to the executor thread
      * pool thread.
      */
-  [[nodiscard]] auto schedule() -> ScheduleOperation;
+  [[nodiscard]] auto schedule(Priority priority = Priority::Normal) -> ScheduleOperation;
+
+  /**
+     * Same as schedule() at normal priority, but awaited on one of this thread pool's executors the
+     * coroutine goes into that executor's next slot instead of the back of the queue, so it continues
+     * on the same thread right after the current coroutine returns, see Options::nextSlotBudget_.
+     * @throw std::runtime_error If the thread pool is `shutdown()`.
+     */
+  [[nodiscard]] auto schedule_local() -> ScheduleOperation;
 
   /**
      * Spawns the given task to be run on this thread pool, the task is detached from the user.
      * @param task The task to spawn onto the thread pool.
+     * @param priority The lane the task starts in.
+     * @return True if the task has been spawned onto this thread pool, false if the thread pool
+     *         is shutting down or the submission queue is full.
+     */
+  auto spawn(coro::Task<void> &&task, Priority priority = Priority::Normal) noexcept -> bool;
+
+  /**
+     * Spawns the given task with the detached wrapper frame allocated from allocator, e.g. a request
+     * scoped arena.  The task's own frame comes from wherever the task was created.
+     * @param allocator The allocator for the wrapper frame, must outlive the task.
+     * @param task The task to spawn onto the thread pool.
      * @return True if the task has been spawned onto this thread pool.
      */
-  auto spawn(coro::Task<void> &&task) noexcept -> bool;
+  auto spawn(std::allocator_arg_t, std::pmr::polymorphic_allocator<> allocator, coro::Task<void> &&task,
+      Priority priority = Priority::Normal) noexcept -> bool;
 
   /**
      * Schedules a task on the thread pool and returns another task that must be awaited on for completion.
      * This can be done via co_await in a coroutine context or coro::sync_wait() outside of coroutine context.
      * @tparam return_type The return value of the task.
      * @param task The task to schedule on the thread pool.
+     * @param priority The lane the task starts in.
      * @return The task to await for the input task to complete.
      */
   template <typename return_type>
-  [[nodiscard]] auto schedule(coro::Task<return_type> task) -> coro::Task<return_type> {
-    co_await schedule();
+  [[nodiscard]] auto schedule(coro::Task<return_type> task, Priority priority = Priority::Normal)
+      -> coro::Task<return_type> {
+    co_await schedule(priority);
     co_return co_await task;
   }
   /**
-     * Schedules any coroutine handle that is ready to be resumed.
+     * Schedules any coroutine handle that is ready to be resumed.  Called from an executor thread a
+     * normal priority coroutine goes into the executor's next slot, see Options::nextSlotBudget_.
      * @param handle The coroutine handle to schedule.
-     * @return True if the coroutine is resumed, false if its a nullptr or the coroutine is already done.
+     * @param priority The lane to queue the coroutine in.
+     * @return True if the coroutine is resumed, false if its a nullptr, the coroutine is already done
+     *         or the submission queue is full.
      */
-  auto resume(std::coroutine_handle<> handle) noexcept -> bool;
+  auto resume(std::coroutine_handle<> handle, Priority priority = Priority::Normal) noexcept -> bool;
   /**
-     * Schedules the set of coroutine handles that are ready to be resumed.
+     * Schedules the set of coroutine handles that are ready to be resumed.  The handles are queued
+     * in chunks, each reserved in the shared queue at once, and at most one executor is woken per
+     * handle once the whole range is queued.  Coroutines resumed from an executor thread go to the
+     * shared queue rather than its local deque so idle executors pick them up directly.
      * @param handles The coroutine handles to schedule.
-     * @param uint64_t The number of tasks resumed, if any where null they are discarded.
+     * @param uint64_t The number of tasks resumed, if any where null they are discarded.  Handles
+     *        are queued in order, once one does not fit into a full submission queue none of the
+     *        following handles are resumed either.
+     * @param priority The lane to queue the coroutines in.
      */
   template <coro::concepts::range_of<std::coroutine_handle<>> range_type>
-  auto resume(const range_type &handles) noexcept -> uint64_t {
-    size_.fetch_add(std::size(handles), std::memory_order::release);
-
-    size_t null_handles {0};
-
-    {
-      std::scoped_lock lk {waitMutex_};
-      for (const auto &handle : handles) {
-        if (handle != nullptr) [[likely]] {
-          queue_.emplace_back(handle);
-        } else {
-          ++null_handles;
-        }
+  auto resume(const range_type &handles, Priority priority = Priority::Normal) noexcept -> uint64_t {
+    std::array<std::coroutine_handle<>, batchSize_> batch;
+    std::size_t count {0};
+    uint64_t total {0};
+    for (const auto &handle : handles) {
+      if (handle == nullptr) [[unlikely]] { continue; }
+
+      batch[count++] = handle;
+      if (count == batch.size()) {
+        auto submitted = submit(std::span {batch.data(), count}, priority);
+        total += submitted;
+        if (submitted < std::exchange(count, 0)) [[unlikely]] { break; }
       }
     }
+    if (count > 0) { total += submit(std::span {batch.data(), count}, priority); }
 
-    if (null_handles > 0) { size_.fetch_sub(null_handles, std::memory_order::release); }
+    wake(total);
+    return total;
+  }
 
-    uint64_t total = std::size(handles) - null_handles;
-    if (total >= threads_.size()) {
-      waitCv_.notify_all();
-    } else {
-      for (uint64_t i = 0; i < total; ++i) { waitCv_.notify_one(); }
+  /**
+     * Spawns the tasks of a range like spawn() does with each of them, queueing them in chunks
+     * like resume() does with a range of handles.  The tasks are moved out of the range.
+     * @param tasks The tasks to spawn onto the thread pool.
+     * @param priority The lane the tasks start in.
+     * @return The number of tasks spawned, the tasks the thread pool did not accept are destroyed.
+     */
+  template <coro::concepts::range_of<coro::Task<void>> range_type>
+  auto spawn(range_type &&tasks, Priority priority = Priority::Normal) noexcept -> uint64_t {
+    std::array<std::coroutine_handle<>, batchSize_> batch;
+    std::size_t count {0};
+    uint64_t total {0};
+    for (auto &task : tasks) {
+      batch[count++] = prepare_spawn(std::move(task));
+      if (count == batch.size()) { total += spawn_batch(std::span {batch.data(), std::exchange(count, 0)}, priority); }
     }
+    if (count > 0) { total += spawn_batch(std::span {batch.data(), count}, priority); }
 
+    wake(total);
     return total;
   }
 
@@ -174,7 +383,7 @@ public:
      * FIFO task queue.  This function is useful to yielding long processing tasks to let other tasks
      * get processing time.
      */
-  [[nodiscard]] auto yield() -> ScheduleOperation { return schedule(); }
+  [[nodiscard]] auto yield(Priority priority = Priority::Normal) -> ScheduleOperation { return schedule(priority); }
 
   /**
      * Shutsdown the thread pool.  This will finish any tasks scheduled prior to calling this
@@ -196,22 +405,48 @@ public:
   /**
      * @return The number of tasks waiting in the task queue to be executed.
      */
-  auto queue_size() const noexcept -> std::size_t {
-    std::atomic_thread_fence(std::memory_order::acquire);
-    return queue_.size();
-  }
+  auto queue_size() const noexcept -> std::size_t { return queued_.load(std::memory_order::acquire); }
+
+  /**
+     * @return The number of tasks waiting in the given priority lane.
+     */
+  auto queue_size(Priority priority) const noexcept -> std::size_t;
 
   /**
      * @return True if the task queue is currently empty.
      */
   auto queue_empty() const noexcept -> bool { return queue_size() == 0; }
 
+  /**
+     * Aggregates the executors' counters and histograms while they keep running, each value is read
+     * atomically but the snapshot is not a consistent cut across them.  Everything is zero unless
+     * built with CORO_THREAD_POOL_METRICS.
+     * @return The metrics collected since the thread pool was created.
+     */
+  auto metrics() const -> Metrics;
+
 private:
+  /// Per executor thread state, defined in thread_pool.cpp.
+  struct Worker;
+  /// The shared queues of one priority, defined in thread_pool.cpp.
+  struct Lane;
+  /// The lanes of one NUMA node and the executors running on it, defined in thread_pool.cpp.
+  struct Node;
+
   Options opts_;
   std::vector<std::thread> threads_;
+  std::vector<std::unique_ptr<Worker>> workers_;
   std::mutex waitMutex_;
   std::condition_variable_any waitCv_;
-  std::deque<std::coroutine_handle<>> queue_;
+  /// The chunk size of the range overloads of resume() and spawn().
+  static constexpr std::size_t batchSize_ = 256;
+
+  /// A single node unless Options::numaAware_.
+  std::vector<std::unique_ptr<Node>> nodes_;
+  /// Maps a cpu to the index of its node in nodes_, nodes_.size() for cpus no executor runs on.
+  std::vector<std::size_t> cpuNode_;
+  /// Spreads submissions from cpus without a node over the nodes.
+  std::atomic<std::size_t> nextNode_ {0};
 
   /**
      * Each background thread runs from this function.
@@ -221,10 +456,112 @@ private:
 
   /**
      * @param handle Schedules the given coroutine to be executed upon the first available thread.
+     * @param node See enqueue().
+     * @param runNext Use the calling executor's next slot for a normal priority handle if there is one.
+     * @return False if the handle could not be queued, see enqueue().
+     */
+  auto schedule_impl(std::coroutine_handle<> handle, Priority priority, detail::ReadyNode *node = nullptr,
+      bool runNext = false) noexcept -> bool;
+
+  /**
+     * Starts the detached wrapper task, destroys it if the thread pool refuses it.
+     */
+  auto spawn_impl(detail::TaskSelfDeleting &wrapperTask, Priority priority) noexcept -> bool;
+
+  /**
+     * Creates the detached wrapper task for a spawn() of a range, counted in size_ until it completes.
+     * @return The wrapper's handle, not queued yet.
+     */
+  auto prepare_spawn(coro::Task<void> &&task) -> std::coroutine_handle<>;
+
+  /**
+     * Submits the prepared wrapper tasks, destroys the ones the thread pool refuses.  Does not wake
+     * any executors.
+     * @return The number of wrapper tasks queued.
+     */
+  auto spawn_batch(std::span<const std::coroutine_handle<>> handles, Priority priority) noexcept -> std::size_t;
+
+  /**
+     * Counts the handles in size_ and queues them with enqueue_batch(), does not wake any executors.
+     * @return The number of handles queued, a prefix of handles.
+     */
+  auto submit(std::span<const std::coroutine_handle<>> handles, Priority priority) noexcept -> std::size_t;
+
+  /**
+     * Places a batch of handles on the shared queue of the priority with a single reservation,
+     * executor threads spill what does not fit into the overflow queue in one go.
+     * @param handles At most batchSize_ handles.
+     * @return The number of handles queued, a prefix of handles.  Less than all of them only if
+     *         called from outside of the thread pool and the shared queue is full.
+     */
+  auto enqueue_batch(std::span<const std::coroutine_handle<>> handles, Priority priority) noexcept -> std::size_t;
+
+  /**
+     * Places a normal priority handle on the calling executor's local deque if possible, otherwise
+     * on the priority's shared queue.  Does not wake any executors.
+     * @param node Storage owned by the suspended coroutine, an executor spilling into the overflow
+     *        queue links it instead of allocating a slot for the handle.
+     * @return False if called from outside of the thread pool and the shared queue is full.
+     */
+  auto enqueue(std::coroutine_handle<> handle, Priority priority, detail::ReadyNode *node = nullptr) noexcept -> bool;
+
+  /**
+     * The part of enqueue() after the handle was counted in queued_ and the lane's depth_.
      */
-  auto schedule_impl(std::coroutine_handle<> handle) noexcept -> void;
+  auto publish(Lane &lane, std::coroutine_handle<> handle, Priority priority, detail::ReadyNode *node) noexcept -> bool;
+
+  /**
+     * Places a normal priority handle in the calling executor's next slot, the coroutine it
+     * displaces goes to the queues.  Does not wake any executors.
+     * @return True if a coroutine was displaced.
+     */
+  auto enqueue_next(std::coroutine_handle<> handle) noexcept -> bool;
+
+  /**
+     * Takes the coroutine waiting in the next slot of another executor, see Options::nextSlotBudget_.
+     */
+  auto steal_next(std::size_t idx) noexcept -> detail::QueuedHandle;
+
+  /**
+     * @return The node submissions from the calling thread are queued on.
+     */
+  auto submission_node() noexcept -> Node &;
+
+  /**
+     * @return The oldest coroutine of the node's shared queues for priority, nullptr if there is none.
+     */
+  auto dequeue_lane(Node &node, Priority priority) noexcept -> detail::QueuedHandle;
+
+  /**
+     * @return The next coroutine for executor idx to run, or nullptr if there is none anywhere.
+     *         Work of the executor's own node comes first.
+     */
+  auto dequeue(std::size_t idx) noexcept -> detail::QueuedHandle;
+
+  /**
+     * Spins, yields and finally parks executor idx according to the idle options.
+     * @return The next coroutine to run if one showed up before parking, otherwise nullptr.
+     */
+  auto idle(std::size_t idx) -> detail::QueuedHandle;
+
+  /**
+     * Blocks executor idx until there is work available or shutdown is requested.
+     */
+  auto park(std::size_t idx) -> void;
+
+  /**
+     * Wakes up to count parked executors, no-op if none are parked.
+     */
+  auto wake(uint64_t count) noexcept -> void;
+
   /// The number of tasks in the queue + currently executing.
   std::atomic<std::size_t> size_ {0};
+  /// The number of tasks waiting in any of the queues.
+  std::atomic<std::size_t> queued_ {0};
+  /// The number of executors parked on waitCv_.
+  std::atomic<uint32_t> sleeping_ {0};
+  /// The number of idle executors spinning or yielding before they park.
+  std::atomic<uint32_t> spinning_ {0};
   /// Has the thread pool been requested to shut down?
   std::atomic<bool> shutdownRequested_ {false};
 };
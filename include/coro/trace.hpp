@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <iosfwd>
+#include <string_view>
+
+#include <coro/detail/trace_buffer.hpp>
+
+/**
+ * Coroutine tracing, compiled in with CORO_TRACING.
+ *
+ * Every thread records into its own lock-free ring of the most recent events: coroutines being
+ * scheduled on a ThreadPool, executors resuming them and the resumption ending, coroutines
+ * suspending on a task or a thread pool, completed tasks transferring to their continuation and
+ * detached tasks being spawned and deleting themselves.  Recording stores a cycle counter timestamp
+ * and two pointers, the events are only converted to a Chrome trace, which ui.perfetto.dev and
+ * chrome://tracing load, when flushed with write_chrome_trace().
+ */
+namespace coro::trace {
+/// Are events recorded, see CORO_TRACING.
+#if defined(CORO_TRACING)
+inline constexpr bool enabled = true;
+#else
+inline constexpr bool enabled = false;
+#endif
+
+/**
+ * Names the calling thread in the trace, ThreadPool executors are named after their pool and ID.
+ */
+auto set_thread_name(std::string_view name) -> void;
+
+/**
+ * Writes the events recorded since the previous flush on all threads as Chrome trace event JSON
+ * and consumes them.  Threads keep recording while the trace is written.  The events of exited
+ * threads are kept for up to 16 of them, flushing regularly keeps threads coming and going from
+ * losing theirs.
+ * @return The number of events written, events overwritten before they were flushed are lost.
+ */
+auto write_chrome_trace(std::ostream &out) -> std::size_t;
+
+/**
+ * Same as above into the file at path, which is replaced.
+ * @throw std::runtime_error If the file can't be written.
+ */
+auto write_chrome_trace(const std::filesystem::path &path) -> std::size_t;
+}  // namespace coro::trace
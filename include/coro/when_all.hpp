@@ -0,0 +1,235 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <coro/detail/task_range.hpp>
+#include <coro/detail/when_all_latch.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+
+namespace coro {
+namespace detail {
+/// What a when_all() child contributes to the tuple, void children contribute std::monostate.
+template <typename return_type>
+using WhenAllResult = std::conditional_t<std::is_void_v<return_type>, std::monostate, return_type>;
+
+template <typename return_type>
+auto whenAllResult(Task<return_type> &task) -> WhenAllResult<return_type> {
+  if constexpr (std::is_void_v<return_type>) {
+    task.promise().result();
+    return {};
+  } else {
+    return std::move(task).promise().result();
+  }
+}
+
+/**
+ * Starts the children, on the thread pool in one batch if there is one, and counts down the
+ * awaiting coroutine's share of the latch.  Children the thread pool does not accept run inline.
+ * @return True if the awaiting coroutine must suspend.
+ */
+template <typename range_type>
+auto whenAllStart(WhenAllLatch &latch, ThreadPool *threadPool, const range_type &handles,
+    std::coroutine_handle<> awaiting) noexcept -> bool {
+  std::size_t started {0};
+  if (threadPool != nullptr) { started = threadPool->resume(handles); }
+  for (auto handle : handles | std::views::drop(started)) { handle.resume(); }
+  return latch.try_await(awaiting);
+}
+
+/**
+ * The awaitable returned by the variadic when_all(), owns the children.
+ */
+template <typename... return_types>
+class WhenAllTupleAwaitable {
+public:
+  using result_type = std::tuple<WhenAllResult<return_types>...>;
+
+  explicit WhenAllTupleAwaitable(ThreadPool *threadPool, Task<return_types> &&...tasks) noexcept
+      : threadPool_(threadPool), tasks_(std::move(tasks)...) {}
+  WhenAllTupleAwaitable(const WhenAllTupleAwaitable &) = delete;
+  /**
+   * Only valid before being awaited.
+   */
+  WhenAllTupleAwaitable(WhenAllTupleAwaitable &&other) noexcept
+      : threadPool_(other.threadPool_), tasks_(std::move(other.tasks_)) {}
+  auto operator=(const WhenAllTupleAwaitable &) -> WhenAllTupleAwaitable & = delete;
+  auto operator=(WhenAllTupleAwaitable &&) -> WhenAllTupleAwaitable &      = delete;
+  ~WhenAllTupleAwaitable()                                                = default;
+
+  struct Awaitable {
+    auto await_ready() const noexcept -> bool { return sizeof...(return_types) == 0; }
+
+    template <typename awaiting_promise_type>
+    auto await_suspend(std::coroutine_handle<awaiting_promise_type> awaitingCoroutine) noexcept -> bool {
+      if constexpr (std::derived_from<awaiting_promise_type, PromiseBase>) {
+        whenAll_.inherit_cancellation(awaitingCoroutine.promise());
+      }
+      return whenAll_.start(awaitingCoroutine);
+    }
+
+    auto await_resume() -> result_type { return whenAll_.results(); }
+
+    WhenAllTupleAwaitable &whenAll_;
+  };
+
+  auto operator co_await() && noexcept -> Awaitable { return Awaitable {*this}; }
+
+private:
+  auto start(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool {
+    auto handles = std::apply(
+        [this](auto &...task) {
+          (task.promise().continuation(latch_), ...);
+          return std::array<std::coroutine_handle<>, sizeof...(return_types)> {task.handle()...};
+        },
+        tasks_);
+    return whenAllStart(latch_, threadPool_, handles, awaitingCoroutine);
+  }
+
+  auto inherit_cancellation(const PromiseBase &parent) noexcept -> void {
+    std::apply([&parent](auto &...task) { (task.promise().inherit_cancellation(parent), ...); }, tasks_);
+  }
+
+  auto results() -> result_type {
+    return std::apply([](auto &...task) { return result_type {whenAllResult(task)...}; }, tasks_);
+  }
+
+  ThreadPool *threadPool_ {nullptr};
+  std::tuple<Task<return_types>...> tasks_;
+  WhenAllLatch latch_ {sizeof...(return_types)};
+};
+
+/**
+ * The awaitable returned by the range when_all(), owns the children.
+ */
+template <typename return_type>
+class WhenAllRangeAwaitable {
+public:
+  using result_type = std::conditional_t<std::is_void_v<return_type>, void,
+      std::vector<std::conditional_t<std::is_reference_v<return_type>,
+          std::reference_wrapper<std::remove_reference_t<return_type>>, return_type>>>;
+
+  explicit WhenAllRangeAwaitable(ThreadPool *threadPool, std::vector<Task<return_type>> &&tasks) noexcept
+      : threadPool_(threadPool), tasks_(std::move(tasks)), latch_(tasks_.size()) {}
+  WhenAllRangeAwaitable(const WhenAllRangeAwaitable &) = delete;
+  /**
+   * Only valid before being awaited.
+   */
+  WhenAllRangeAwaitable(WhenAllRangeAwaitable &&other) noexcept
+      : threadPool_(other.threadPool_), tasks_(std::move(other.tasks_)), latch_(tasks_.size()) {}
+  auto operator=(const WhenAllRangeAwaitable &) -> WhenAllRangeAwaitable & = delete;
+  auto operator=(WhenAllRangeAwaitable &&) -> WhenAllRangeAwaitable &      = delete;
+  ~WhenAllRangeAwaitable()                                                = default;
+
+  struct Awaitable {
+    auto await_ready() const noexcept -> bool { return whenAll_.tasks_.empty(); }
+
+    template <typename awaiting_promise_type>
+    auto await_suspend(std::coroutine_handle<awaiting_promise_type> awaitingCoroutine) noexcept -> bool {
+      if constexpr (std::derived_from<awaiting_promise_type, PromiseBase>) {
+        whenAll_.inherit_cancellation(awaitingCoroutine.promise());
+      }
+      return whenAll_.start(awaitingCoroutine);
+    }
+
+    auto await_resume() -> result_type { return whenAll_.results(); }
+
+    WhenAllRangeAwaitable &whenAll_;
+  };
+
+  auto operator co_await() && noexcept -> Awaitable { return Awaitable {*this}; }
+
+private:
+  auto start(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool {
+    for (auto &task : tasks_) { task.promise().continuation(latch_); }
+    auto handles = tasks_ | std::views::transform([](Task<return_type> &task) -> std::coroutine_handle<> {
+      return task.handle();
+    });
+    return whenAllStart(latch_, threadPool_, handles, awaitingCoroutine);
+  }
+
+  auto inherit_cancellation(const PromiseBase &parent) noexcept -> void {
+    for (auto &task : tasks_) { task.promise().inherit_cancellation(parent); }
+  }
+
+  auto results() -> result_type {
+    if constexpr (std::is_void_v<return_type>) {
+      for (auto &task : tasks_) { task.promise().result(); }
+    } else {
+      result_type results {};
+      results.reserve(tasks_.size());
+      for (auto &task : tasks_) {
+        if constexpr (std::is_reference_v<return_type>) {
+          auto &&value = task.promise().result();
+          results.emplace_back(value);
+        } else {
+          results.emplace_back(std::move(task).promise().result());
+        }
+      }
+      return results;
+    }
+  }
+
+  ThreadPool *threadPool_ {nullptr};
+  std::vector<Task<return_type>> tasks_;
+  WhenAllLatch latch_;
+};
+}  // namespace detail
+
+/**
+ * Awaits all tasks, they run concurrently if they suspend, e.g. by scheduling themselves onto a
+ * thread pool.  The children complete straight into a shared countdown latch, no wrapper
+ * coroutine or other allocation is needed per child.  Every task must be valid and not started yet.
+ * The tasks inherit the awaiting task's stop token and deadline, see coro::this_task.
+ * @param tasks The tasks to await.
+ * @return An awaitable producing a tuple of the task results, std::monostate for void tasks.
+ *         Awaiting it rethrows the first exception of the children in argument order, after all
+ *         of them completed.
+ */
+template <typename... return_types>
+[[nodiscard]] auto when_all(Task<return_types>... tasks) -> detail::WhenAllTupleAwaitable<return_types...> {
+  return detail::WhenAllTupleAwaitable<return_types...> {nullptr, std::move(tasks)...};
+}
+
+/**
+ * Same as above, the tasks are started on threadPool with a single batched resume() so they run in
+ * parallel.  Tasks the thread pool does not accept run inline on the awaiting thread.
+ */
+template <typename... return_types>
+[[nodiscard]] auto when_all(ThreadPool &threadPool, Task<return_types>... tasks)
+    -> detail::WhenAllTupleAwaitable<return_types...> {
+  return detail::WhenAllTupleAwaitable<return_types...> {&threadPool, std::move(tasks)...};
+}
+
+/**
+ * Awaits all tasks of a range, the tasks are moved out of it.  See the variadic when_all().
+ * @return An awaitable producing a vector of the task results in range order, std::reference_wrapper
+ *         for reference results and void for void tasks.
+ */
+template <detail::task_range range_type,
+    typename return_type = typename detail::TaskTraits<std::ranges::range_value_t<range_type>>::result_type>
+[[nodiscard]] auto when_all(range_type &&tasks) -> detail::WhenAllRangeAwaitable<return_type> {
+  return detail::WhenAllRangeAwaitable<return_type> {nullptr, detail::toTaskVector(std::forward<range_type>(tasks))};
+}
+
+/**
+ * Same as above, the tasks are started on threadPool with a single batched resume().
+ */
+template <detail::task_range range_type,
+    typename return_type = typename detail::TaskTraits<std::ranges::range_value_t<range_type>>::result_type>
+[[nodiscard]] auto when_all(ThreadPool &threadPool, range_type &&tasks) -> detail::WhenAllRangeAwaitable<return_type> {
+  return detail::WhenAllRangeAwaitable<return_type> {
+      &threadPool, detail::toTaskVector(std::forward<range_type>(tasks))};
+}
+}  // namespace coro
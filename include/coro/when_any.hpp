@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <coro/detail/task_range.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+
+namespace coro {
+/**
+ * The result of when_any(): the index of the child that completed first and its value.  Only the
+ * index for void tasks.
+ */
+template <typename return_type>
+using WhenAnyResult =
+    std::conditional_t<std::is_void_v<return_type>, std::size_t, std::pair<std::size_t, return_type>>;
+
+namespace detail {
+/**
+ * Shared by a when_any() and its children, allocated once.  The first child to complete claims
+ * the result with a single compare-and-swap, every later child only drops its reference.
+ */
+template <typename return_type>
+class WhenAnyState {
+public:
+  using stored_type = std::conditional_t<std::is_void_v<return_type>, std::monostate,
+      std::conditional_t<std::is_reference_v<return_type>, std::remove_reference_t<return_type> *, return_type>>;
+
+  explicit WhenAnyState(std::stop_source stopSource) noexcept : stopSource_(std::move(stopSource)) {}
+
+  /**
+   * Called by each child upon completing, does nothing unless it is the first.  The winner requests
+   * the losers to stop and resumes the awaiting coroutine inline if it already suspended.
+   */
+  template <typename... value_type>
+  auto complete(std::size_t index, value_type &&...value) -> void {
+    std::size_t expected {noWinner_};
+    if (!winner_.compare_exchange_strong(expected, index, std::memory_order::acq_rel, std::memory_order::relaxed)) {
+      return;
+    }
+
+    try {
+      if constexpr (std::is_reference_v<return_type>) {
+        value_.emplace(std::addressof(value)...);
+      } else {
+        value_.emplace(std::forward<value_type>(value)...);
+      }
+    } catch (...) {
+      exception_ = std::current_exception();
+    }
+    finish();
+  }
+
+  auto fail(std::size_t index, std::exception_ptr exception) noexcept -> void {
+    std::size_t expected {noWinner_};
+    if (!winner_.compare_exchange_strong(expected, index, std::memory_order::acq_rel, std::memory_order::relaxed)) {
+      return;
+    }
+
+    exception_ = std::move(exception);
+    finish();
+  }
+
+  auto operator co_await() noexcept {
+    struct Awaitable {
+      auto await_ready() const noexcept -> bool {
+        return state_.awaiting_.load(std::memory_order::acquire) == completed();
+      }
+
+      auto await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool {
+        void *expected {nullptr};
+        return state_.awaiting_.compare_exchange_strong(
+            expected, awaitingCoroutine.address(), std::memory_order::acq_rel, std::memory_order::acquire);
+      }
+
+      auto await_resume() -> WhenAnyResult<return_type> { return state_.result(); }
+
+      WhenAnyState &state_;
+    };
+
+    return Awaitable {*this};
+  }
+
+private:
+  static constexpr std::size_t noWinner_ = std::numeric_limits<std::size_t>::max();
+
+  /// Marks awaiting_ once the result is available.
+  static auto completed() noexcept -> void * { return reinterpret_cast<void *>(std::uintptr_t {1}); }
+
+  auto finish() noexcept -> void {
+    stopSource_.request_stop();
+    auto *awaiting = awaiting_.exchange(completed(), std::memory_order::acq_rel);
+    if (awaiting != nullptr) { std::coroutine_handle<>::from_address(awaiting).resume(); }
+  }
+
+  auto result() -> WhenAnyResult<return_type> {
+    if (exception_) { std::rethrow_exception(exception_); }
+
+    auto index = winner_.load(std::memory_order::relaxed);
+    if constexpr (std::is_void_v<return_type>) {
+      return index;
+    } else if constexpr (std::is_reference_v<return_type>) {
+      return {index, static_cast<return_type>(**value_)};
+    } else {
+      return {index, std::move(*value_)};
+    }
+  }
+
+  std::stop_source stopSource_;
+  std::atomic<std::size_t> winner_ {noWinner_};
+  /// The awaiting coroutine's address, or completed() once the winner published its result.
+  std::atomic<void *> awaiting_ {nullptr};
+  std::optional<stored_type> value_ {};
+  std::exception_ptr exception_ {nullptr};
+};
+
+template <typename return_type>
+auto makeWhenAnyTask(std::shared_ptr<WhenAnyState<return_type>> state, std::size_t index, Task<return_type> task)
+    -> Task<void> {
+  try {
+    if constexpr (std::is_void_v<return_type>) {
+      co_await std::move(task);
+      state->complete(index);
+    } else {
+      state->complete(index, co_await std::move(task));
+    }
+  } catch (...) {
+    state->fail(index, std::current_exception());
+  }
+}
+
+template <typename return_type>
+auto whenAny(ThreadPool &threadPool, std::stop_source stopSource, std::vector<Task<return_type>> tasks)
+    -> Task<WhenAnyResult<return_type>> {
+  if (tasks.empty()) { throw std::invalid_argument {"coro::when_any requires at least one task"}; }
+
+  // The tasks run detached, they observe the race's stop token and the awaiting task's deadline.
+  // A stop requested on the awaiting task is forwarded to the race while it is undecided.
+  auto deadline    = co_await this_task::deadline();
+  auto parentToken = co_await this_task::stop_token();
+  for (auto &task : tasks) {
+    if (!task.promise().stop_token().stop_possible()) { task.promise().stop_token(stopSource.get_token()); }
+    task.promise().deadline(std::min(task.promise().deadline(), deadline));
+  }
+  std::stop_callback forwardStop {parentToken, [stopSource]() noexcept { stopSource.request_stop(); }};
+
+  auto state = std::make_shared<WhenAnyState<return_type>>(std::move(stopSource));
+  std::size_t spawned {0};
+  for (std::size_t index = 0; index < tasks.size(); ++index) {
+    if (threadPool.spawn(makeWhenAnyTask(state, index, std::move(tasks[index])))) { ++spawned; }
+  }
+  if (spawned == 0) { throw std::runtime_error {"coro::when_any unable to spawn any task onto the thread pool"}; }
+
+  co_return co_await *state;
+}
+}  // namespace detail
+
+/**
+ * Runs the tasks on threadPool and completes as soon as the first of them completes, by returning
+ * or by throwing.  The others are asked to stop through stopSource, tasks without a stop token of
+ * their own observe it through coro::this_task::stop_requested().  They keep running detached until
+ * they notice, so anything they reference must outlive them.  A stop requested on the awaiting
+ * task is forwarded to stopSource and its deadline applies to the tasks as well.
+ * @param threadPool The thread pool to spawn the tasks onto.
+ * @param stopSource Stopped once the first task completed.
+ * @param tasks The tasks to race, all of the same type.
+ * @return The index and result of the first task to complete.
+ * @throw Rethrows the exception of the first task to complete if it failed.  std::runtime_error if
+ *        none of the tasks could be spawned.
+ */
+template <typename return_type, std::same_as<Task<return_type>>... tasks_type>
+[[nodiscard]] auto when_any(ThreadPool &threadPool, std::stop_source stopSource, Task<return_type> first,
+    tasks_type... rest) -> Task<WhenAnyResult<return_type>> {
+  std::vector<Task<return_type>> tasks {};
+  tasks.reserve(1 + sizeof...(rest));
+  tasks.emplace_back(std::move(first));
+  (tasks.emplace_back(std::move(rest)), ...);
+  return detail::whenAny(threadPool, std::move(stopSource), std::move(tasks));
+}
+
+/**
+ * Same as above for a non-empty range of tasks, the tasks are moved out of it.
+ * @throw std::invalid_argument If the range is empty.
+ */
+template <detail::task_range range_type,
+    typename return_type = typename detail::TaskTraits<std::ranges::range_value_t<range_type>>::result_type>
+[[nodiscard]] auto when_any(ThreadPool &threadPool, std::stop_source stopSource, range_type &&tasks)
+    -> Task<WhenAnyResult<return_type>> {
+  return detail::whenAny(
+      threadPool, std::move(stopSource), detail::toTaskVector(std::forward<range_type>(tasks)));
+}
+}  // namespace coro
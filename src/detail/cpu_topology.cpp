@@ -0,0 +1,134 @@
+#include <coro/detail/cpu_topology.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+namespace coro::detail {
+namespace {
+/// Cpus from here on can't be pinned to, parseCpuList() skips them.
+#if defined(__linux__)
+constexpr uint32_t cpuLimit = CPU_SETSIZE;
+#else
+constexpr uint32_t cpuLimit = 1024;
+#endif
+
+/**
+ * @return The cpus the calling thread may run on, every cpu up to the hardware concurrency if unknown.
+ */
+auto allowedCpus() -> std::vector<uint32_t> {
+  std::vector<uint32_t> cpus {};
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) { cpus.emplace_back(cpu); }
+    }
+  }
+#endif
+  if (cpus.empty()) {
+    for (uint32_t cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) { cpus.emplace_back(cpu); }
+  }
+  return cpus;
+}
+}  // namespace
+
+auto CpuTopology::detect() -> CpuTopology {
+  auto allowed = allowedCpus();
+  CpuTopology topology {};
+
+#if defined(__linux__)
+  std::error_code ec {};
+  std::vector<std::pair<uint32_t, std::vector<uint32_t>>> nodes {};
+  for (const auto &entry : std::filesystem::directory_iterator {"/sys/devices/system/node", ec}) {
+    auto name = entry.path().filename().string();
+    uint32_t id {0};
+    if (!name.starts_with("node") ||
+        std::from_chars(name.data() + 4, name.data() + name.size(), id).ec != std::errc {}) {
+      continue;
+    }
+
+    std::ifstream file {entry.path() / "cpulist"};
+    std::string list {};
+    if (!std::getline(file, list)) { continue; }
+
+    auto cpus = parseCpuList(list);
+    std::erase_if(cpus, [&](uint32_t cpu) { return !std::ranges::binary_search(allowed, cpu); });
+    if (!cpus.empty()) { nodes.emplace_back(id, std::move(cpus)); }
+  }
+
+  std::ranges::sort(nodes, {}, &std::pair<uint32_t, std::vector<uint32_t>>::first);
+  for (auto &[id, cpus] : nodes) { topology.nodes_.emplace_back(std::move(cpus)); }
+#endif
+
+  if (topology.nodes_.empty()) { topology.nodes_.emplace_back(std::move(allowed)); }
+  return topology;
+}
+
+auto CpuTopology::parseCpuList(std::string_view list) -> std::vector<uint32_t> {
+  std::vector<uint32_t> cpus {};
+  while (!list.empty()) {
+    auto comma = list.find(',');
+    auto entry = list.substr(0, comma);
+    list       = comma == std::string_view::npos ? std::string_view {} : list.substr(comma + 1);
+
+    while (!entry.empty() && (entry.back() == '\n' || entry.back() == ' ')) { entry.remove_suffix(1); }
+    while (!entry.empty() && entry.front() == ' ') { entry.remove_prefix(1); }
+
+    uint32_t first {0};
+    auto [end, ec] = std::from_chars(entry.data(), entry.data() + entry.size(), first);
+    if (ec != std::errc {}) { continue; }
+
+    auto last = first;
+    if (end != entry.data() + entry.size()) {
+      if (*end != '-') { continue; }
+      auto range = std::from_chars(end + 1, entry.data() + entry.size(), last);
+      if (range.ec != std::errc {} || range.ptr != entry.data() + entry.size() || last < first) { continue; }
+    }
+    if (last >= cpuLimit) { continue; }
+    for (auto cpu = first; cpu <= last; ++cpu) { cpus.emplace_back(cpu); }
+  }
+
+  std::ranges::sort(cpus);
+  auto duplicates = std::ranges::unique(cpus);
+  cpus.erase(duplicates.begin(), duplicates.end());
+  return cpus;
+}
+
+auto CpuTopology::nodeOf(uint32_t cpu) const noexcept -> std::size_t {
+  for (std::size_t node = 0; node < nodes_.size(); ++node) {
+    if (std::ranges::find(nodes_[node], cpu) != nodes_[node].end()) { return node; }
+  }
+  return nodes_.size();
+}
+
+auto pinCurrentThread(uint32_t cpu) noexcept -> bool {
+#if defined(__linux__)
+  if (cpu >= CPU_SETSIZE) { return false; }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  static_cast<void>(cpu);
+  return false;
+#endif
+}
+
+auto currentCpu() noexcept -> int {
+#if defined(__linux__)
+  return sched_getcpu();
+#else
+  return -1;
+#endif
+}
+}  // namespace coro::detail
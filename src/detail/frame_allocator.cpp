@@ -0,0 +1,281 @@
+#include <coro/detail/frame_allocator.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace coro::detail {
+namespace {
+constexpr std::size_t classCount =
+    RecyclingFrameAllocator::maxRecycledSize_ / RecyclingFrameAllocator::sizeClassGranularity_;
+
+class ThreadCache;
+
+/**
+ * Precedes every frame so deallocate() can find the owning cache, its size keeps the frame
+ * itself at the default new alignment.
+ */
+struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) FrameHeader {
+  union {
+    /// The cache the block belongs to, nullptr for blocks that bypass the free lists.
+    ThreadCache *owner_;
+    /// Free list link while the block is not handed out.
+    FrameHeader *next_;
+  };
+  std::size_t sizeClass_;
+};
+
+auto blockSize(std::size_t sizeClass) noexcept -> std::size_t {
+  return sizeof(FrameHeader) + (sizeClass + 1) * RecyclingFrameAllocator::sizeClassGranularity_;
+}
+
+/// Marks the remote free list of a cache whose thread has exited.
+const auto closedList = reinterpret_cast<FrameHeader *>(std::uintptr_t {1});
+
+/**
+ * The free lists of one thread.  The cache is reference counted by its owning thread plus every
+ * block it created that still exists, so it outlives its thread while frames it handed out are
+ * still alive on other threads.
+ */
+class ThreadCache {
+public:
+  auto allocate(std::size_t sizeClass) -> FrameHeader * {
+    bump(allocations_);
+
+    auto *header = free_[sizeClass];
+    if (header == nullptr) {
+      reclaimRemote();
+      header = free_[sizeClass];
+    }
+
+    if (header != nullptr) {
+      free_[sizeClass] = header->next_;
+      --freeCount_[sizeClass];
+      localBytes_.store(localBytes_.load(std::memory_order::relaxed) - blockSize(sizeClass), std::memory_order::relaxed);
+      bump(recycled_);
+    } else {
+      header = static_cast<FrameHeader *>(::operator new(blockSize(sizeClass)));
+      header->sizeClass_ = sizeClass;
+      references_.fetch_add(1, std::memory_order::relaxed);
+    }
+
+    header->owner_ = this;
+    return header;
+  }
+
+  /**
+   * Owner thread only.
+   */
+  auto release(FrameHeader *header) noexcept -> void {
+    auto sizeClass = header->sizeClass_;
+    if (freeCount_[sizeClass] >= RecyclingFrameAllocator::maxCachedPerClass_) {
+      destroy(header);
+      return;
+    }
+
+    header->next_    = free_[sizeClass];
+    free_[sizeClass] = header;
+    ++freeCount_[sizeClass];
+    localBytes_.store(localBytes_.load(std::memory_order::relaxed) + blockSize(sizeClass), std::memory_order::relaxed);
+  }
+
+  /**
+   * Any thread but the owner.
+   */
+  static auto releaseRemote(ThreadCache *cache, FrameHeader *header) noexcept -> void {
+    // Counted before the block is published, once it is the owner may retire and free the cache.
+    // A retired cache's counters are no longer read, counting a block it then destroys is harmless.
+    cache->remoteFrees_.fetch_add(1, std::memory_order::relaxed);
+    cache->remoteBytes_.fetch_add(blockSize(header->sizeClass_), std::memory_order::relaxed);
+
+    auto *head = cache->remote_.load(std::memory_order::acquire);
+    do {
+      if (head == closedList) {
+        // The owner is gone, nobody would ever reclaim the block.
+        cache->destroy(header);
+        return;
+      }
+      header->next_ = head;
+    } while (!cache->remote_.compare_exchange_weak(
+        head, header, std::memory_order::release, std::memory_order::acquire));
+  }
+
+  /**
+   * Owner thread only, upon exiting.  Returns all cached blocks to the heap and drops the
+   * owner's reference.
+   */
+  auto retire() noexcept -> void {
+    for (std::size_t sizeClass = 0; sizeClass < classCount; ++sizeClass) {
+      while (auto *header = free_[sizeClass]) {
+        free_[sizeClass] = header->next_;
+        destroy(header);
+      }
+      freeCount_[sizeClass] = 0;
+    }
+
+    auto *remote = remote_.exchange(closedList, std::memory_order::acquire);
+    while (remote != nullptr) {
+      auto *next = remote->next_;
+      destroy(remote);
+      remote = next;
+    }
+
+    localBytes_.store(0, std::memory_order::relaxed);
+    remoteBytes_.store(0, std::memory_order::relaxed);
+    unreference();
+  }
+
+  auto collect(FrameAllocatorStats &stats) const noexcept -> void {
+    stats.allocations_ += allocations_.load(std::memory_order::relaxed);
+    stats.recycled_ += recycled_.load(std::memory_order::relaxed);
+    stats.remoteFrees_ += remoteFrees_.load(std::memory_order::relaxed);
+    stats.bytesRetained_ += localBytes_.load(std::memory_order::relaxed) + remoteBytes_.load(std::memory_order::relaxed);
+  }
+
+private:
+  /// Owner-only counters are published with a plain store, no read-modify-write needed.
+  static auto bump(std::atomic<uint64_t> &counter) noexcept -> void {
+    counter.store(counter.load(std::memory_order::relaxed) + 1, std::memory_order::relaxed);
+  }
+
+  /**
+   * Moves blocks other threads released into the local free lists.
+   */
+  auto reclaimRemote() noexcept -> void {
+    if (remote_.load(std::memory_order::relaxed) == nullptr) { return; }
+
+    auto *remote = remote_.exchange(nullptr, std::memory_order::acquire);
+    std::size_t bytes {0};
+    while (remote != nullptr) {
+      auto *next = remote->next_;
+      bytes += blockSize(remote->sizeClass_);
+      release(remote);
+      remote = next;
+    }
+    remoteBytes_.fetch_sub(std::min(bytes, remoteBytes_.load(std::memory_order::relaxed)), std::memory_order::relaxed);
+  }
+
+  auto destroy(FrameHeader *header) noexcept -> void {
+    ::operator delete(header);
+    unreference();
+  }
+
+  auto unreference() noexcept -> void;
+
+  std::array<FrameHeader *, classCount> free_ {};
+  std::array<std::size_t, classCount> freeCount_ {};
+  std::atomic<FrameHeader *> remote_ {nullptr};
+  /// The owning thread plus every block created by this cache that was not returned to the heap.
+  std::atomic<std::size_t> references_ {1};
+
+  std::atomic<uint64_t> allocations_ {0};
+  std::atomic<uint64_t> recycled_ {0};
+  std::atomic<uint64_t> remoteFrees_ {0};
+  std::atomic<std::size_t> localBytes_ {0};
+  std::atomic<std::size_t> remoteBytes_ {0};
+};
+
+/**
+ * The caches of all live threads, for stats().
+ */
+struct Registry {
+  std::mutex mutex_;
+  std::vector<ThreadCache *> caches_;
+  /// Counters of caches whose thread has exited.
+  FrameAllocatorStats retired_;
+};
+
+auto registry() -> Registry & {
+  static auto *instance = new Registry {};
+  return *instance;
+}
+
+auto ThreadCache::unreference() noexcept -> void {
+  if (references_.fetch_sub(1, std::memory_order::acq_rel) == 1) { delete this; }
+}
+
+thread_local ThreadCache *tCache {nullptr};
+thread_local bool tRetired {false};
+
+/**
+ * Retires the calling thread's cache on thread exit.
+ */
+struct CacheHolder {
+  ~CacheHolder() {
+    auto *cache = tCache;
+    tCache      = nullptr;
+    tRetired    = true;
+    if (cache == nullptr) { return; }
+
+    {
+      auto &reg = registry();
+      std::scoped_lock lk {reg.mutex_};
+      std::erase(reg.caches_, cache);
+      FrameAllocatorStats stats {};
+      cache->collect(stats);
+      reg.retired_.allocations_ += stats.allocations_;
+      reg.retired_.recycled_ += stats.recycled_;
+      reg.retired_.remoteFrees_ += stats.remoteFrees_;
+    }
+    cache->retire();
+  }
+};
+
+thread_local CacheHolder tHolder;
+
+auto currentCache() -> ThreadCache * {
+  if (tCache != nullptr || tRetired) [[likely]] { return tCache; }
+
+  auto *cache = new ThreadCache {};
+  {
+    auto &reg = registry();
+    std::scoped_lock lk {reg.mutex_};
+    reg.caches_.push_back(cache);
+  }
+  // Touch the holder so its destructor runs on thread exit.
+  static_cast<void>(&tHolder);
+  tCache = cache;
+  return cache;
+}
+}  // namespace
+
+auto RecyclingFrameAllocator::allocate(std::size_t size) -> void * {
+  ThreadCache *cache = size <= maxRecycledSize_ ? currentCache() : nullptr;
+  if (cache == nullptr) {
+    // Too large to recycle or the thread is exiting.
+    auto *header       = static_cast<FrameHeader *>(::operator new(sizeof(FrameHeader) + size));
+    header->owner_     = nullptr;
+    header->sizeClass_ = 0;
+    return header + 1;
+  }
+
+  auto sizeClass = size == 0 ? 0 : (size - 1) / sizeClassGranularity_;
+  return cache->allocate(sizeClass) + 1;
+}
+
+auto RecyclingFrameAllocator::deallocate(void *ptr, std::size_t) noexcept -> void {
+  if (ptr == nullptr) { return; }
+
+  auto *header = static_cast<FrameHeader *>(ptr) - 1;
+  auto *owner  = header->owner_;
+  if (owner == nullptr) {
+    ::operator delete(header);
+  } else if (owner == tCache) {
+    owner->release(header);
+  } else {
+    ThreadCache::releaseRemote(owner, header);
+  }
+}
+
+auto RecyclingFrameAllocator::stats() noexcept -> FrameAllocatorStats {
+  auto &reg = registry();
+  std::scoped_lock lk {reg.mutex_};
+  auto stats = reg.retired_;
+  for (const auto *cache : reg.caches_) { cache->collect(stats); }
+  return stats;
+}
+}  // namespace coro::detail
@@ -0,0 +1,146 @@
+#include <coro/detail/io_uring.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace coro::detail {
+namespace {
+auto ringAt(void *ring, uint32_t offset) noexcept -> uint32_t * {
+  return reinterpret_cast<uint32_t *>(static_cast<std::byte *>(ring) + offset);
+}
+
+/// The kernel reads and writes the ring indexes concurrently.
+auto loadAcquire(uint32_t *value) noexcept -> uint32_t {
+  return std::atomic_ref<uint32_t> {*value}.load(std::memory_order::acquire);
+}
+
+auto storeRelease(uint32_t *value, uint32_t desired) noexcept -> void {
+  std::atomic_ref<uint32_t> {*value}.store(desired, std::memory_order::release);
+}
+
+auto enter(int fd, uint32_t toSubmit, uint32_t minComplete, uint32_t flags) noexcept -> int {
+  auto result = static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+  return result < 0 ? -errno : result;
+}
+
+auto registerResource(int fd, unsigned opcode, const void *arg, unsigned count) noexcept -> int {
+  return syscall(__NR_io_uring_register, fd, opcode, arg, count) < 0 ? -errno : 0;
+}
+}  // namespace
+
+auto IoUring::create(uint32_t entries) -> std::unique_ptr<IoUring> {
+  io_uring_params params {};
+  auto fd = static_cast<int>(syscall(__NR_io_uring_setup, std::max(entries, 1u), &params));
+  if (fd < 0) { return nullptr; }
+
+  std::unique_ptr<IoUring> ring {new IoUring {}};
+  ring->fd_      = fd;
+  ring->entries_ = params.sq_entries;
+
+  ring->sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  ring->cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  auto singleMmap   = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (singleMmap) { ring->sqRingSize_ = ring->cqRingSize_ = std::max(ring->sqRingSize_, ring->cqRingSize_); }
+
+  auto map = [fd](std::size_t size, off_t offset) -> void * {
+    auto *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    return address == MAP_FAILED ? nullptr : address;
+  };
+  ring->sqRing_ = map(ring->sqRingSize_, IORING_OFF_SQ_RING);
+  if (ring->sqRing_ == nullptr) { return nullptr; }
+  ring->cqRing_ = singleMmap ? ring->sqRing_ : map(ring->cqRingSize_, IORING_OFF_CQ_RING);
+  if (ring->cqRing_ == nullptr) { return nullptr; }
+  ring->sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+  ring->sqes_     = static_cast<io_uring_sqe *>(map(ring->sqesSize_, IORING_OFF_SQES));
+  if (ring->sqes_ == nullptr) { return nullptr; }
+
+  ring->sqHead_       = ringAt(ring->sqRing_, params.sq_off.head);
+  ring->sqTailShared_ = ringAt(ring->sqRing_, params.sq_off.tail);
+  ring->sqFlags_      = ringAt(ring->sqRing_, params.sq_off.flags);
+  ring->sqMask_       = *ringAt(ring->sqRing_, params.sq_off.ring_mask);
+  ring->sqArray_      = ringAt(ring->sqRing_, params.sq_off.array);
+  ring->cqHead_       = ringAt(ring->cqRing_, params.cq_off.head);
+  ring->cqTail_       = ringAt(ring->cqRing_, params.cq_off.tail);
+  ring->cqMask_       = *ringAt(ring->cqRing_, params.cq_off.ring_mask);
+  ring->cqes_         = static_cast<std::byte *>(ring->cqRing_) + params.cq_off.cqes;
+  ring->sqTail_       = *ring->sqTailShared_;
+  return ring;
+}
+
+IoUring::~IoUring() {
+  if (sqes_ != nullptr) { munmap(sqes_, sqesSize_); }
+  if (cqRing_ != nullptr && cqRing_ != sqRing_) { munmap(cqRing_, cqRingSize_); }
+  if (sqRing_ != nullptr) { munmap(sqRing_, sqRingSize_); }
+  if (fd_ >= 0) { close(fd_); }
+}
+
+auto IoUring::get_sqe() noexcept -> io_uring_sqe * {
+  if (sqTail_ - loadAcquire(sqHead_) >= entries_) { return nullptr; }
+
+  auto index      = sqTail_ & sqMask_;
+  sqArray_[index] = index;
+  auto *sqe       = &sqes_[index];
+  std::memset(sqe, 0, sizeof(io_uring_sqe));
+  ++sqTail_;
+  return sqe;
+}
+
+auto IoUring::unsubmitted() const noexcept -> uint32_t { return sqTail_ - loadAcquire(sqHead_); }
+
+auto IoUring::submit(uint32_t waitFor) noexcept -> int {
+  storeRelease(sqTailShared_, sqTail_);
+  auto toSubmit = unsubmitted();
+  // Completions the kernel could not post to a full completion queue are flushed by GETEVENTS.
+  auto overflow = (std::atomic_ref<uint32_t> {*sqFlags_}.load(std::memory_order::relaxed) & IORING_SQ_CQ_OVERFLOW) != 0;
+  if (toSubmit == 0 && waitFor == 0 && !overflow) { return 0; }
+  return enter(fd_, toSubmit, waitFor, waitFor > 0 || overflow ? IORING_ENTER_GETEVENTS : 0);
+}
+
+auto IoUring::reap(std::span<Completion> completions) noexcept -> std::size_t {
+  auto head = *cqHead_;
+  auto tail = loadAcquire(cqTail_);
+  std::size_t count {0};
+  for (; head != tail && count < completions.size(); ++head, ++count) {
+    const auto &cqe     = static_cast<const io_uring_cqe *>(cqes_)[head & cqMask_];
+    completions[count] = Completion {cqe.user_data, cqe.res};
+  }
+  storeRelease(cqHead_, head);
+  return count;
+}
+
+auto IoUring::register_buffers(std::span<const std::span<std::byte>> buffers) noexcept -> int {
+  if (buffersRegistered_) {
+    registerResource(fd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+    buffersRegistered_ = false;
+  }
+  if (buffers.empty()) { return 0; }
+
+  std::vector<iovec> iovecs {};
+  iovecs.reserve(buffers.size());
+  for (auto buffer : buffers) { iovecs.emplace_back(iovec {buffer.data(), buffer.size()}); }
+  auto result        = registerResource(fd_, IORING_REGISTER_BUFFERS, iovecs.data(), iovecs.size());
+  buffersRegistered_ = result == 0;
+  return result;
+}
+
+auto IoUring::register_files(std::span<const int> fds) noexcept -> int {
+  if (filesRegistered_) {
+    registerResource(fd_, IORING_UNREGISTER_FILES, nullptr, 0);
+    filesRegistered_ = false;
+  }
+  if (fds.empty()) { return 0; }
+
+  auto result      = registerResource(fd_, IORING_REGISTER_FILES, fds.data(), fds.size());
+  filesRegistered_ = result == 0;
+  return result;
+}
+}  // namespace coro::detail
@@ -15,11 +15,15 @@ auto PromiseSelfDeleting::operator=(PromiseSelfDeleting &&other) -> PromiseSelfD
   return *this;
 }
 
-auto PromiseSelfDeleting::get_return_object() -> TaskSelfDeleting { return TaskSelfDeleting(*this); }
+auto PromiseSelfDeleting::get_return_object() -> TaskSelfDeleting {
+  trace(TraceEvent::Spawn, std::coroutine_handle<PromiseSelfDeleting>::from_promise(*this).address());
+  return TaskSelfDeleting(*this);
+}
 
 auto PromiseSelfDeleting::initial_suspend() -> std::suspend_always { return std::suspend_always {}; }
 
 auto PromiseSelfDeleting::final_suspend() noexcept -> std::suspend_never {
+  trace(TraceEvent::SelfDelete, std::coroutine_handle<PromiseSelfDeleting>::from_promise(*this).address());
   // Notify the task_container<executor_t> that this coroutine has completed
   if (executorSize_ != nullptr) { executorSize_->fetch_sub(1, std::memory_order_release); }
   return std::suspend_never {};
@@ -49,8 +53,14 @@ auto TaskSelfDeleting::operator=(TaskSelfDeleting &&other) -> TaskSelfDeleting &
   return *this;
 }
 
-auto make_task_self_deleting(coro::Task<void> user_task) -> TaskSelfDeleting {
-  co_await user_task;
+auto makeTaskSelfDeleting(coro::Task<void> userTask) -> TaskSelfDeleting {
+  co_await userTask;
+  co_return;
+}
+
+auto makeTaskSelfDeleting(std::allocator_arg_t, std::pmr::polymorphic_allocator<>, coro::Task<void> userTask)
+    -> TaskSelfDeleting {
+  co_await userTask;
   co_return;
 }
 
@@ -0,0 +1,144 @@
+#include <coro/detail/timer_wheel.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace coro::detail {
+TimerWheel::TimerWheel(Clock::duration tick, Clock::time_point start) noexcept
+    : tick_(std::max(tick, Clock::duration {1})), start_(start) {
+  for (auto &list : lists_) { list.prev_ = list.next_ = &list; }
+}
+
+auto TimerWheel::insert(TimerNode &timer, Clock::time_point deadline) noexcept -> void {
+  timer.expiry_ = 0;
+  if (deadline > start_) {
+    // Rounded up so a timer never expires early.
+    auto elapsed  = deadline - start_;
+    timer.expiry_ = static_cast<uint64_t>(elapsed / tick_ + (elapsed % tick_ != Clock::duration {0} ? 1 : 0));
+  }
+  link(timer);
+  ++size_;
+}
+
+auto TimerWheel::erase(TimerNode &timer) noexcept -> void {
+  timer.prev_->next_ = timer.next_;
+  timer.next_->prev_ = timer.prev_;
+  timer.prev_        = nullptr;
+  timer.next_        = nullptr;
+  if (timer.list_ < overflow_ && lists_[timer.list_].next_ == &lists_[timer.list_]) {
+    occupied_[timer.list_ / slots_] &= ~(uint64_t {1} << (timer.list_ % slots_));
+  }
+  --size_;
+}
+
+auto TimerWheel::advance(Clock::time_point now, std::vector<TimerNode *> &expired) -> void {
+  auto target = now <= start_ ? 0 : static_cast<uint64_t>((now - start_) / tick_);
+  expire(take(due_), expired);
+
+  while (current_ < target) {
+    auto next = size_ > 0 ? next_tick() : std::numeric_limits<uint64_t>::max();
+    if (next > target) {
+      // Nothing expires or moves down a level in between, every timer keeps its slot.
+      current_ = target;
+      break;
+    }
+    current_ = next;
+    process(expired);
+  }
+}
+
+auto TimerWheel::next_deadline() const noexcept -> Clock::time_point {
+  if (size_ == 0) { return Clock::time_point::max(); }
+  if (lists_[due_].next_ != &lists_[due_]) { return start_ + tick_ * static_cast<Clock::rep>(current_); }
+
+  auto next = next_tick();
+  if (next >= static_cast<uint64_t>((Clock::time_point::max() - start_) / tick_)) { return Clock::time_point::max(); }
+  return start_ + tick_ * static_cast<Clock::rep>(next);
+}
+
+auto TimerWheel::link(TimerNode &timer) noexcept -> void {
+  uint16_t list {due_};
+  if (timer.expiry_ > current_) {
+    auto level = static_cast<std::size_t>(std::bit_width(timer.expiry_ ^ current_) - 1) / slotBits_;
+    if (level >= levels_) {
+      list = overflow_;
+    } else {
+      auto slot = (timer.expiry_ >> (level * slotBits_)) & (slots_ - 1);
+      list      = static_cast<uint16_t>(level * slots_ + slot);
+      occupied_[level] |= uint64_t {1} << slot;
+    }
+  }
+
+  auto &head        = lists_[list];
+  timer.list_       = list;
+  timer.next_       = &head;
+  timer.prev_       = head.prev_;
+  head.prev_->next_ = &timer;
+  head.prev_        = &timer;
+}
+
+auto TimerWheel::take(uint16_t list) noexcept -> TimerNode * {
+  auto &head = lists_[list];
+  if (head.next_ == &head) { return nullptr; }
+
+  auto *first       = head.next_;
+  head.prev_->next_ = nullptr;
+  head.prev_ = head.next_ = &head;
+  if (list < overflow_) { occupied_[list / slots_] &= ~(uint64_t {1} << (list % slots_)); }
+  return first;
+}
+
+auto TimerWheel::next_tick() const noexcept -> uint64_t {
+  auto next = std::numeric_limits<uint64_t>::max();
+  for (std::size_t level = 0; level < levels_; ++level) {
+    auto shift    = level * slotBits_;
+    auto position = (current_ >> shift) & (slots_ - 1);
+    // Timers are only ever linked into slots ahead of the current position.
+    auto ahead = position + 1 == slots_ ? 0 : occupied_[level] >> (position + 1) << (position + 1);
+    if (ahead == 0) { continue; }
+
+    auto base = current_ >> (shift + slotBits_) << (shift + slotBits_);
+    next      = std::min(next, base | (static_cast<uint64_t>(std::countr_zero(ahead)) << shift));
+  }
+
+  if (lists_[overflow_].next_ != &lists_[overflow_]) {
+    constexpr auto span = levels_ * slotBits_;
+    next                = std::min(next, ((current_ >> span) + 1) << span);
+  }
+  return next;
+}
+
+auto TimerWheel::process(std::vector<TimerNode *> &expired) -> void {
+  auto relink = [this](TimerNode *timer) {
+    while (timer != nullptr) {
+      auto *next = timer->next_;
+      link(*timer);
+      timer = next;
+    }
+  };
+
+  // Top down, a timer moving down a level lands in a slot the wheel reaches later, or is due.
+  constexpr auto span = levels_ * slotBits_;
+  if ((current_ & ((uint64_t {1} << span) - 1)) == 0) { relink(take(overflow_)); }
+  for (auto level = levels_ - 1; level > 0; --level) {
+    auto shift = level * slotBits_;
+    if ((current_ & ((uint64_t {1} << shift) - 1)) != 0) { continue; }
+    relink(take(static_cast<uint16_t>(level * slots_ + ((current_ >> shift) & (slots_ - 1)))));
+  }
+
+  expire(take(static_cast<uint16_t>(current_ & (slots_ - 1))), expired);
+  expire(take(due_), expired);
+}
+
+auto TimerWheel::expire(TimerNode *timer, std::vector<TimerNode *> &expired) -> void {
+  while (timer != nullptr) {
+    auto *next   = timer->next_;
+    timer->prev_ = nullptr;
+    timer->next_ = nullptr;
+    expired.emplace_back(timer);
+    --size_;
+    timer = next;
+  }
+}
+}  // namespace coro::detail
@@ -0,0 +1,68 @@
+#include <coro/detail/waiter_list.hpp>
+#include <coro/thread_pool.hpp>
+
+#include <array>
+#include <span>
+
+namespace coro::detail {
+namespace {
+/// The waiters resumeInline() queued while the thread was already resuming waiters.
+constinit thread_local Waiter *tDeferredHead {nullptr};
+constinit thread_local Waiter *tDeferredTail {nullptr};
+constinit thread_local bool tResumingInline {false};
+}  // namespace
+
+auto resumeInline(Waiter *waiters) noexcept -> void {
+  if (waiters == nullptr) { return; }
+  if (tDeferredTail == nullptr) {
+    tDeferredHead = waiters;
+  } else {
+    tDeferredTail->next_ = waiters;
+  }
+  while (waiters->next_ != nullptr) { waiters = waiters->next_; }
+  tDeferredTail = waiters;
+  if (tResumingInline) { return; }
+
+  tResumingInline = true;
+  while (auto *waiter = tDeferredHead) {
+    // The waiter's frame may be gone once it resumed.
+    tDeferredHead = waiter->next_;
+    if (tDeferredHead == nullptr) { tDeferredTail = nullptr; }
+    waiter->awaitingCoroutine_.resume();
+  }
+  tResumingInline = false;
+}
+
+auto resumeWaiters(ThreadPool *threadPool, Waiter *waiters) noexcept -> void {
+  if (threadPool == nullptr) {
+    resumeInline(waiters);
+    return;
+  }
+
+  std::array<Waiter *, 256> nodes;
+  std::array<std::coroutine_handle<>, 256> batch;
+  std::size_t count {0};
+  auto flush = [&]() {
+    // A single waiter may go to the calling executor's next slot, a batch is spread over the pool.
+    auto resumed = count == 1 ? static_cast<std::size_t>(threadPool->resume(batch[0]))
+                              : threadPool->resume(std::span {batch.data(), count});
+    // The ones the thread pool refused were not resumed, their frames are still there.
+    for (auto i = resumed; i + 1 < count; ++i) { nodes[i]->next_ = nodes[i + 1]; }
+    if (resumed < count) {
+      nodes[count - 1]->next_ = nullptr;
+      resumeInline(nodes[resumed]);
+    }
+    count = 0;
+  };
+
+  while (waiters != nullptr) {
+    // The waiter's frame may be gone once it resumed.
+    auto *next     = waiters->next_;
+    nodes[count]   = waiters;
+    batch[count++] = waiters->awaitingCoroutine_;
+    if (count == batch.size()) { flush(); }
+    waiters = next;
+  }
+  if (count > 0) { flush(); }
+}
+}  // namespace coro::detail
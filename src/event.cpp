@@ -0,0 +1,92 @@
+#include <coro/event.hpp>
+
+#include <utility>
+
+namespace coro {
+auto Event::WaitOperation::await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool {
+  awaitingCoroutine_ = awaitingCoroutine;
+  auto *state        = event_.state_.load(std::memory_order::acquire);
+  while (true) {
+    if (state == signalled()) {
+      // Set in the meantime, an auto reset event must be reset by whoever gets through.
+      if (event_.mode_ == ResetMode::Manual ||
+          event_.state_.compare_exchange_weak(state, nullptr, std::memory_order::acquire, std::memory_order::acquire)) {
+        return false;
+      }
+      continue;
+    }
+
+    next_ = static_cast<detail::Waiter *>(state);
+    if (event_.state_.compare_exchange_weak(
+            state, static_cast<detail::Waiter *>(this), std::memory_order::release, std::memory_order::acquire)) {
+      return true;
+    }
+  }
+}
+
+auto Event::set() noexcept -> void {
+  if (mode_ == ResetMode::Manual) {
+    auto *waiters = state_.exchange(signalled(), std::memory_order::acq_rel);
+    if (waiters != signalled()) {
+      detail::resumeWaiters(threadPool_, detail::reverseWaiters(static_cast<detail::Waiter *>(waiters)));
+    }
+    return;
+  }
+
+  // Only the set() taking pending_ off zero releases waiters, the others leave theirs to it.
+  if (pending_.fetch_add(1, std::memory_order::acq_rel) != 0) { return; }
+
+  detail::Waiter *released {nullptr};
+  detail::Waiter *releasedTail {nullptr};
+  uint64_t claimed {1};
+  auto count  = claimed;
+  auto *state = state_.load(std::memory_order::acquire);
+  while (true) {
+    while (count > 0) {
+      if (waiters_ == nullptr) {
+        if (state == nullptr || state == signalled()) { break; }
+        if (!state_.compare_exchange_weak(state, nullptr, std::memory_order::acq_rel, std::memory_order::acquire)) {
+          continue;
+        }
+        // Only the waiters that arrived since the previous take are reversed.
+        waiters_ = detail::reverseWaiters(static_cast<detail::Waiter *>(state));
+        state    = nullptr;
+      }
+
+      auto *waiter  = std::exchange(waiters_, waiters_->next_);
+      waiter->next_ = nullptr;
+      if (releasedTail != nullptr) {
+        releasedTail->next_ = waiter;
+      } else {
+        released = waiter;
+      }
+      releasedTail = waiter;
+      --count;
+    }
+
+    // Nobody waits, the event stays set for the next waiter unless one arrived in the meantime.
+    if (count > 0 && state != signalled() &&
+        !state_.compare_exchange_weak(state, signalled(), std::memory_order::acq_rel, std::memory_order::acquire)) {
+      continue;
+    }
+    // Sets made meanwhile by the other set() calls.
+    count   = pending_.fetch_sub(claimed, std::memory_order::acq_rel) - claimed;
+    claimed = count;
+    if (count == 0) { break; }
+  }
+
+  detail::resumeWaiters(threadPool_, released);
+}
+
+auto Event::reset() noexcept -> void {
+  auto *expected = signalled();
+  state_.compare_exchange_strong(expected, nullptr, std::memory_order::acq_rel, std::memory_order::relaxed);
+}
+
+auto Event::try_consume() noexcept -> bool {
+  auto *state = state_.load(std::memory_order::acquire);
+  if (state != signalled()) { return false; }
+  return mode_ == ResetMode::Manual ||
+         state_.compare_exchange_strong(state, nullptr, std::memory_order::acquire, std::memory_order::relaxed);
+}
+}  // namespace coro
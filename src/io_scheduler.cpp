@@ -0,0 +1,592 @@
+#include <coro/io_scheduler.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+
+#include <linux/io_uring.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace coro {
+namespace {
+constexpr auto epollEvents(PollOp op) noexcept -> uint32_t {
+  switch (op) {
+    case PollOp::Read: return EPOLLIN;
+    case PollOp::Write: return EPOLLOUT;
+    case PollOp::ReadWrite: return EPOLLIN | EPOLLOUT;
+  }
+  return 0;
+}
+
+constexpr auto pollStatus(uint32_t events) noexcept -> PollStatus {
+  if ((events & (EPOLLIN | EPOLLOUT)) != 0) { return PollStatus::Event; }
+  if ((events & EPOLLERR) != 0) { return PollStatus::Error; }
+  return PollStatus::Closed;
+}
+}  // namespace
+
+IoScheduler::PollOperation::PollOperation(
+    IoScheduler &scheduler, int fd, PollOp op, std::chrono::steady_clock::time_point deadline) noexcept
+    : scheduler_(scheduler), fd_(fd), op_(op), deadline_(deadline) {}
+
+auto IoScheduler::PollOperation::await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool {
+  // The poll may complete and its frame be gone as soon as the lock is released.
+  auto &scheduler    = scheduler_;
+  awaitingCoroutine_ = awaitingCoroutine;
+  auto earlier       = false;
+  {
+    // Held across the registration so the I/O thread can't complete the poll before it is linked.
+    std::scoped_lock lk {scheduler.mutex_};
+    if (cancelled_ || scheduler.shutdownRequested_.load(std::memory_order::acquire)) {
+      status_ = PollStatus::Closed;
+      return false;
+    }
+
+    if (!sleep_) {
+      epoll_event event {};
+      event.events   = epollEvents(op_) | EPOLLRDHUP | EPOLLONESHOT;
+      event.data.ptr = this;
+      if (epoll_ctl(scheduler.epollFd_, EPOLL_CTL_ADD, fd_, &event) != 0) {
+        status_ = PollStatus::Error;
+        return false;
+      }
+    }
+
+    if (deadline_ != Clock::time_point::max()) {
+      scheduler.timers_.insert(timer_, deadline_);
+      earlier = deadline_ < scheduler.waitDeadline_;
+    }
+    next_ = std::exchange(scheduler.pending_, this);
+    if (next_ != nullptr) { next_->prev_ = this; }
+    scheduler.size_.fetch_add(1, std::memory_order::release);
+  }
+
+  // The I/O thread may already be waiting past the new deadline.
+  if (earlier) { scheduler.wake(); }
+  return true;
+}
+
+auto IoScheduler::TimeoutOperation::await_resume() noexcept -> bool {
+  std::scoped_lock lk {scheduler_.mutex_};
+  // Timed out, cancelled or shut down before the task completed, the runner forgets this operation.
+  if (!completed_ && runner_ != nullptr) { *runner_ = nullptr; }
+  return completed_;
+}
+
+IoScheduler::IoOperation::IoOperation(IoScheduler &scheduler, Kind kind, IoFile file, void *buffer,
+    std::size_t length, int64_t offset, uint32_t flags) noexcept
+    : scheduler_(scheduler), kind_(kind), file_(file), buffer_(buffer),
+      length_(std::min<std::size_t>(length, std::numeric_limits<uint32_t>::max())), offset_(offset), flags_(flags),
+      poll_(scheduler, -1, PollOp::Read, Clock::time_point::max()) {}
+
+auto IoScheduler::IoOperation::await_ready() noexcept -> bool {
+  auto &scheduler = scheduler_;
+  if (scheduler.ring_ != nullptr) { return false; }
+
+  poll_.fd_ = file_.fd_;
+  if (file_.fixed_) {
+    std::scoped_lock lk {scheduler.mutex_};
+    auto index = static_cast<std::size_t>(file_.fd_);
+    poll_.fd_  = index < scheduler.files_.size() ? scheduler.files_[index] : -1;
+  }
+  result_ = perform();
+  return result_ != -EAGAIN;
+}
+
+auto IoScheduler::IoOperation::await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool {
+  // The operation may complete and its frame be gone as soon as the lock is released.
+  auto &scheduler = scheduler_;
+  if (scheduler.ring_ == nullptr) {
+    poll_.op_ = kind_ == Kind::Write || kind_ == Kind::WriteFixed || kind_ == Kind::Send ? PollOp::Write : PollOp::Read;
+    return poll_.await_suspend(awaitingCoroutine);
+  }
+
+  awaitingCoroutine_ = awaitingCoroutine;
+  auto first         = false;
+  {
+    std::scoped_lock lk {scheduler.mutex_};
+    if (scheduler.shutdownRequested_.load(std::memory_order::acquire)) {
+      result_ = -ECANCELED;
+      return false;
+    }
+
+    auto &ring = *scheduler.ring_;
+    auto *sqe  = ring.get_sqe();
+    if (sqe == nullptr) {
+      // Full of entries the I/O thread did not get to yet.
+      ring.submit();
+      sqe = ring.get_sqe();
+    }
+    if (sqe == nullptr) {
+      result_ = -EBUSY;
+      return false;
+    }
+
+    // Indexed by Kind.
+    constexpr std::array<uint8_t, 8> opcodes {IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED,
+        IORING_OP_WRITE_FIXED, IORING_OP_RECV, IORING_OP_SEND, IORING_OP_ACCEPT, IORING_OP_FSYNC};
+    sqe->opcode    = opcodes[static_cast<std::size_t>(kind_)];
+    sqe->fd        = file_.fd_;
+    sqe->flags     = file_.fixed_ ? IOSQE_FIXED_FILE : 0;
+    sqe->user_data = reinterpret_cast<uint64_t>(this);
+    switch (kind_) {
+      case Kind::Read:
+      case Kind::Write:
+      case Kind::ReadFixed:
+      case Kind::WriteFixed:
+        sqe->addr = reinterpret_cast<uint64_t>(buffer_);
+        sqe->len  = static_cast<uint32_t>(length_);
+        // All ones reads or writes at the current file position.
+        sqe->off       = static_cast<uint64_t>(offset_);
+        sqe->buf_index = static_cast<uint16_t>(flags_);
+        break;
+      case Kind::Recv:
+      case Kind::Send:
+        sqe->addr      = reinterpret_cast<uint64_t>(buffer_);
+        sqe->len       = static_cast<uint32_t>(length_);
+        sqe->msg_flags = flags_;
+        break;
+      case Kind::Accept: sqe->accept_flags = flags_; break;
+      case Kind::Fsync: sqe->fsync_flags = flags_ != 0 ? IORING_FSYNC_DATASYNC : 0; break;
+    }
+
+    next_ = std::exchange(scheduler.inFlight_, this);
+    if (next_ != nullptr) { next_->prev_ = this; }
+    scheduler.size_.fetch_add(1, std::memory_order::release);
+    // Later entries ride along with the first one's wakeup, the I/O thread submits them all at once.
+    first = ring.unsubmitted() == 1;
+  }
+
+  if (first) { scheduler.wake(); }
+  return true;
+}
+
+auto IoScheduler::IoOperation::await_resume() noexcept -> IoResult {
+  if (result_ == -EAGAIN && scheduler_.ring_ == nullptr) {
+    result_ = perform();
+    // Still not ready since the poll was completed by shutdown().
+    if (result_ == -EAGAIN && poll_.status_ == PollStatus::Closed) { result_ = -ECANCELED; }
+  }
+  return IoResult {result_};
+}
+
+auto IoScheduler::IoOperation::perform() noexcept -> int64_t {
+  auto fd = poll_.fd_;
+  ssize_t result {-1};
+  switch (kind_) {
+    case Kind::Read:
+    case Kind::ReadFixed:
+      result = offset_ < 0 ? ::read(fd, buffer_, length_) : ::pread(fd, buffer_, length_, offset_);
+      break;
+    case Kind::Write:
+    case Kind::WriteFixed:
+      result = offset_ < 0 ? ::write(fd, buffer_, length_) : ::pwrite(fd, buffer_, length_, offset_);
+      break;
+    case Kind::Recv: result = ::recv(fd, buffer_, length_, static_cast<int>(flags_) | MSG_DONTWAIT); break;
+    case Kind::Send: result = ::send(fd, buffer_, length_, static_cast<int>(flags_) | MSG_DONTWAIT); break;
+    case Kind::Accept: result = ::accept4(fd, nullptr, nullptr, static_cast<int>(flags_)); break;
+    case Kind::Fsync: result = flags_ != 0 ? ::fdatasync(fd) : ::fsync(fd); break;
+  }
+  return result < 0 ? -errno : result;
+}
+
+auto IoScheduler::ScheduleOperation::await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool {
+  auto &scheduler = scheduler_;
+  {
+    std::scoped_lock lk {scheduler.mutex_};
+    if (scheduler.shutdownRequested_.load(std::memory_order::acquire)) {
+      scheduler.size_.fetch_sub(1, std::memory_order::release);
+      return false;
+    }
+    scheduler.scheduled_.emplace_back(awaitingCoroutine);
+  }
+  scheduler.wake();
+  return true;
+}
+
+IoScheduler::IoScheduler(Options &&opts, PrivateConstructor)
+    : opts_(std::move(opts)), timers_(std::max(opts_.timerTick_, std::chrono::milliseconds {1})) {
+  if (opts_.executionStrategy_ == ExecutionStrategy::ThreadPool && opts_.threadPool_ == nullptr) {
+    opts_.threadPool_ = coro::ThreadPool::makeShared();
+  }
+  opts_.maxEvents_ = std::max<std::size_t>(opts_.maxEvents_, 1);
+  events_          = std::make_unique<epoll_event[]>(opts_.maxEvents_);
+
+  epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epollFd_ < 0) { throw std::system_error {errno, std::system_category(), "coro::IoScheduler epoll_create1"}; }
+
+  eventFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (eventFd_ < 0) {
+    auto error = errno;
+    close(epollFd_);
+    throw std::system_error {error, std::system_category(), "coro::IoScheduler eventfd"};
+  }
+
+  epoll_event event {};
+  event.events   = EPOLLIN;
+  event.data.ptr = &eventFd_;
+  if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, eventFd_, &event) != 0) {
+    auto error = errno;
+    close(eventFd_);
+    close(epollFd_);
+    throw std::system_error {error, std::system_category(), "coro::IoScheduler epoll_ctl"};
+  }
+
+  if (opts_.backend_ != Backend::Epoll) {
+    ring_ = detail::IoUring::create(opts_.ringEntries_);
+    if (ring_ == nullptr && opts_.backend_ == Backend::IoUring) {
+      auto error = errno;
+      close(eventFd_);
+      close(epollFd_);
+      throw std::system_error {error, std::system_category(), "coro::IoScheduler io_uring_setup"};
+    }
+  }
+  if (ring_ != nullptr) {
+    event.data.ptr = ring_.get();
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, ring_->fd(), &event) != 0) {
+      auto error = errno;
+      ring_.reset();
+      close(eventFd_);
+      close(epollFd_);
+      throw std::system_error {error, std::system_category(), "coro::IoScheduler epoll_ctl"};
+    }
+    completions_.resize(opts_.maxEvents_);
+  }
+}
+
+auto IoScheduler::makeShared(Options opts) -> std::shared_ptr<IoScheduler> {
+  auto scheduler = std::make_shared<IoScheduler>(std::move(opts), PrivateConstructor {});
+  if (scheduler->opts_.threadStrategy_ == ThreadStrategy::Spawn) {
+    scheduler->ioThread_ = std::thread {[scheduler = scheduler.get()]() { scheduler->io_thread(); }};
+  }
+  return scheduler;
+}
+
+auto IoScheduler::makeShared() -> std::shared_ptr<IoScheduler> { return makeShared(Options {}); }
+
+IoScheduler::~IoScheduler() {
+  shutdown();
+  ring_.reset();
+  close(eventFd_);
+  close(epollFd_);
+}
+
+auto IoScheduler::schedule() -> ScheduleOperation {
+  if (shutdownRequested_.load(std::memory_order::acquire)) {
+    throw std::runtime_error("coro::IoScheduler is shutting down, unable to schedule new tasks");
+  }
+  size_.fetch_add(1, std::memory_order::release);
+  return ScheduleOperation {*this};
+}
+
+auto IoScheduler::poll(int fd, PollOp op, std::chrono::milliseconds timeout) -> PollOperation {
+  return PollOperation {
+      *this, fd, op, timeout > std::chrono::milliseconds {0} ? Clock::now() + timeout : Clock::time_point::max()};
+}
+
+auto IoScheduler::sleep_for(std::chrono::steady_clock::duration duration) -> SleepOperation {
+  return SleepOperation {*this, duration < Clock::time_point::max() - Clock::now() ? Clock::now() + duration
+                                                                                   : Clock::time_point::max()};
+}
+
+auto IoScheduler::sleep_until(std::chrono::steady_clock::time_point deadline) -> SleepOperation {
+  return SleepOperation {*this, deadline};
+}
+
+auto IoScheduler::read(IoFile file, std::span<std::byte> buffer, int64_t offset) -> IoOperation {
+  return IoOperation {*this, IoOperation::Kind::Read, file, buffer.data(), buffer.size(), offset, 0};
+}
+
+auto IoScheduler::write(IoFile file, std::span<const std::byte> buffer, int64_t offset) -> IoOperation {
+  return IoOperation {
+      *this, IoOperation::Kind::Write, file, const_cast<std::byte *>(buffer.data()), buffer.size(), offset, 0};
+}
+
+auto IoScheduler::read_fixed(IoFile file, std::span<std::byte> buffer, uint16_t bufferIndex, int64_t offset)
+    -> IoOperation {
+  return IoOperation {*this, IoOperation::Kind::ReadFixed, file, buffer.data(), buffer.size(), offset, bufferIndex};
+}
+
+auto IoScheduler::write_fixed(IoFile file, std::span<const std::byte> buffer, uint16_t bufferIndex, int64_t offset)
+    -> IoOperation {
+  return IoOperation {*this, IoOperation::Kind::WriteFixed, file, const_cast<std::byte *>(buffer.data()),
+      buffer.size(), offset, bufferIndex};
+}
+
+auto IoScheduler::recv(IoFile socket, std::span<std::byte> buffer, int flags) -> IoOperation {
+  return IoOperation {
+      *this, IoOperation::Kind::Recv, socket, buffer.data(), buffer.size(), 0, static_cast<uint32_t>(flags)};
+}
+
+auto IoScheduler::send(IoFile socket, std::span<const std::byte> buffer, int flags) -> IoOperation {
+  return IoOperation {*this, IoOperation::Kind::Send, socket, const_cast<std::byte *>(buffer.data()), buffer.size(),
+      0, static_cast<uint32_t>(flags)};
+}
+
+auto IoScheduler::accept(IoFile socket, int flags) -> IoOperation {
+  return IoOperation {*this, IoOperation::Kind::Accept, socket, nullptr, 0, 0, static_cast<uint32_t>(flags)};
+}
+
+auto IoScheduler::fsync(IoFile file, bool dataOnly) -> IoOperation {
+  return IoOperation {*this, IoOperation::Kind::Fsync, file, nullptr, 0, 0, dataOnly ? 1u : 0u};
+}
+
+auto IoScheduler::register_buffers(std::span<const std::span<std::byte>> buffers) -> void {
+  std::scoped_lock lk {mutex_};
+  if (ring_ == nullptr) { return; }
+  if (auto result = ring_->register_buffers(buffers); result < 0) {
+    throw std::system_error {-result, std::system_category(), "coro::IoScheduler register_buffers"};
+  }
+}
+
+auto IoScheduler::register_files(std::span<const int> fds) -> void {
+  std::scoped_lock lk {mutex_};
+  files_.assign(fds.begin(), fds.end());
+  if (ring_ == nullptr) { return; }
+  if (auto result = ring_->register_files(fds); result < 0) {
+    files_.clear();
+    throw std::system_error {-result, std::system_category(), "coro::IoScheduler register_files"};
+  }
+}
+
+auto IoScheduler::process_events(std::chrono::milliseconds timeout) -> std::size_t { return process(timeout); }
+
+auto IoScheduler::shutdown() noexcept -> void {
+  {
+    std::scoped_lock lk {mutex_};
+    if (shutdownRequested_.exchange(true, std::memory_order::acq_rel)) { return; }
+  }
+
+  if (ioThread_.joinable()) {
+    wake();
+    ioThread_.join();
+  } else {
+    drain();
+  }
+}
+
+auto IoScheduler::io_thread() -> void {
+  if (opts_.onIoThreadStart_) { opts_.onIoThreadStart_(); }
+
+  while (!shutdownRequested_.load(std::memory_order::acquire)) { process(std::chrono::milliseconds {-1}); }
+  drain();
+
+  if (opts_.onIoThreadStop_) { opts_.onIoThreadStop_(); }
+}
+
+auto IoScheduler::process(std::chrono::milliseconds timeout) -> std::size_t {
+  {
+    // Never sleep past the earliest deadline.
+    std::scoped_lock lk {mutex_};
+    // One io_uring_enter() for every operation prepared since the last iteration.
+    if (ring_ != nullptr) { ring_->submit(); }
+    auto now = Clock::now();
+    if (!scheduled_.empty() || (ring_ != nullptr && ring_->unsubmitted() > 0)) {
+      timeout = std::chrono::milliseconds {0};
+    } else if (auto deadline = timers_.next_deadline(); deadline != Clock::time_point::max()) {
+      auto untilDeadline = std::chrono::ceil<std::chrono::milliseconds>(std::max(deadline, now) - now);
+      timeout = timeout < std::chrono::milliseconds {0} ? untilDeadline : std::min(timeout, untilDeadline);
+    }
+    waitDeadline_ = timeout < std::chrono::milliseconds {0} ? Clock::time_point::max() : now + timeout;
+  }
+
+  auto waitMs = std::min<std::chrono::milliseconds::rep>(timeout.count(), std::numeric_limits<int>::max());
+  auto count  = epoll_wait(epollFd_, events_.get(), static_cast<int>(opts_.maxEvents_), static_cast<int>(waitMs));
+  if (count < 0) { count = 0; }
+
+  completed_.clear();
+  ready_.clear();
+  {
+    std::scoped_lock lk {mutex_};
+    for (const auto &event : std::span {events_.get(), static_cast<std::size_t>(count)}) {
+      if (event.data.ptr == &eventFd_) {
+        eventfd_t value {0};
+        eventfd_read(eventFd_, &value);
+        wakePending_.store(false, std::memory_order::release);
+        continue;
+      }
+      if (event.data.ptr == ring_.get()) { continue; }
+
+      auto &operation   = *static_cast<PollOperation *>(event.data.ptr);
+      operation.status_ = pollStatus(event.events);
+      unlink(operation);
+      completed_.emplace_back(&operation);
+    }
+
+    expired_.clear();
+    timers_.advance(Clock::now(), expired_);
+    for (auto *timer : expired_) {
+      auto &operation   = *static_cast<PollOperation::Timer *>(timer)->operation_;
+      operation.status_ = PollStatus::Timeout;
+      unlink(operation);
+      completed_.emplace_back(&operation);
+    }
+
+    ready_.swap(scheduled_);
+    if (ring_ != nullptr) { reap(ready_); }
+  }
+
+  for (auto *operation : completed_) {
+    // Disarmed before the coroutine resumes, it may poll the same fd again.
+    if (!operation->sleep_) { epoll_ctl(epollFd_, EPOLL_CTL_DEL, operation->fd_, nullptr); }
+    ready_.emplace_back(operation->awaitingCoroutine_);
+  }
+
+  dispatch(ready_);
+  return ready_.size();
+}
+
+auto IoScheduler::dispatch(const std::vector<std::coroutine_handle<>> &handles) -> void {
+  if (handles.empty()) { return; }
+  size_.fetch_sub(handles.size(), std::memory_order::release);
+
+  std::size_t started {0};
+  if (opts_.executionStrategy_ == ExecutionStrategy::ThreadPool) { started = opts_.threadPool_->resume(handles); }
+  for (auto handle : handles | std::views::drop(started)) { handle.resume(); }
+}
+
+auto IoScheduler::drain() -> void {
+  // Resumed coroutines may schedule again, they are resumed as well until nothing is left.
+  while (true) {
+    std::vector<PollOperation *> completed {};
+    std::vector<std::coroutine_handle<>> ready {};
+    auto inFlight = false;
+    {
+      std::scoped_lock lk {mutex_};
+      while (pending_ != nullptr) {
+        auto &operation   = *pending_;
+        operation.status_ = PollStatus::Closed;
+        unlink(operation);
+        completed.emplace_back(&operation);
+      }
+      ready.swap(scheduled_);
+
+      if (ring_ != nullptr) {
+        for (auto *operation = inFlight_; operation != nullptr; operation = operation->next_) {
+          if (operation->cancelled_) { continue; }
+          auto *sqe = ring_->get_sqe();
+          if (sqe == nullptr) {
+            ring_->submit();
+            sqe = ring_->get_sqe();
+          }
+          if (sqe == nullptr) { break; }
+          // Its own completion carries no user data, the cancelled operation completes with ECANCELED.
+          sqe->opcode           = IORING_OP_ASYNC_CANCEL;
+          sqe->fd               = -1;
+          sqe->addr             = reinterpret_cast<uint64_t>(operation);
+          operation->cancelled_ = true;
+        }
+        ring_->submit();
+        reap(ready);
+        inFlight = inFlight_ != nullptr;
+      }
+    }
+    if (completed.empty() && ready.empty()) {
+      if (!inFlight) { return; }
+      // Nobody prepares entries any more, waiting for the cancellations needs no lock.
+      ring_->submit(1);
+      continue;
+    }
+
+    for (auto *operation : completed) {
+      if (!operation->sleep_) { epoll_ctl(epollFd_, EPOLL_CTL_DEL, operation->fd_, nullptr); }
+      ready.emplace_back(operation->awaitingCoroutine_);
+    }
+    dispatch(ready);
+  }
+}
+
+auto IoScheduler::reap(std::vector<std::coroutine_handle<>> &ready) noexcept -> std::size_t {
+  std::size_t count {0};
+  while (true) {
+    auto harvested = ring_->reap(completions_);
+    for (const auto &completion : std::span {completions_.data(), harvested}) {
+      if (completion.userData_ == 0) { continue; }
+
+      auto &operation   = *reinterpret_cast<IoOperation *>(completion.userData_);
+      operation.result_ = completion.result_;
+      unlink(operation);
+      ready.emplace_back(operation.awaitingCoroutine_);
+      ++count;
+    }
+    if (harvested < completions_.size()) { return count; }
+  }
+}
+
+auto IoScheduler::cancel(PollOperation &operation) noexcept -> void {
+  {
+    std::scoped_lock lk {mutex_};
+    if (operation.prev_ == nullptr && pending_ != &operation) {
+      // Not registered yet, or already completed.
+      operation.cancelled_ = true;
+      return;
+    }
+
+    operation.status_ = PollStatus::Closed;
+    unlink(operation);
+    // Still counted by size_, it moves from the pending polls to the scheduled coroutines.
+    scheduled_.emplace_back(operation.awaitingCoroutine_);
+  }
+  wake();
+}
+
+auto IoScheduler::complete_timeout(TimeoutOperation *&operation) noexcept -> std::coroutine_handle<> {
+  std::scoped_lock lk {mutex_};
+  if (operation == nullptr) { return nullptr; }
+
+  auto &poll = operation->sleep_.poll_;
+  if (poll.prev_ == nullptr && pending_ != &poll) {
+    if (poll.cancelled_ || poll.status_ != PollStatus::Error) {
+      // Expired, cancelled or shut down, possibly on the same tick: the operation gives up anyway.
+      operation->runner_ = nullptr;
+      operation          = nullptr;
+      return nullptr;
+    }
+    // Not registered yet, the operation won't suspend.
+    operation->completed_ = true;
+    poll.cancelled_       = true;
+    return std::noop_coroutine();
+  }
+
+  operation->completed_ = true;
+  unlink(poll);
+  size_.fetch_sub(1, std::memory_order::release);
+  return poll.awaitingCoroutine_;
+}
+
+auto IoScheduler::unlink(PollOperation &operation) noexcept -> void {
+  if (operation.timer_.linked()) { timers_.erase(operation.timer_); }
+
+  if (operation.prev_ != nullptr) {
+    operation.prev_->next_ = operation.next_;
+  } else {
+    pending_ = operation.next_;
+  }
+  if (operation.next_ != nullptr) { operation.next_->prev_ = operation.prev_; }
+  operation.prev_ = nullptr;
+  operation.next_ = nullptr;
+}
+
+auto IoScheduler::unlink(IoOperation &operation) noexcept -> void {
+  if (operation.prev_ != nullptr) {
+    operation.prev_->next_ = operation.next_;
+  } else {
+    inFlight_ = operation.next_;
+  }
+  if (operation.next_ != nullptr) { operation.next_->prev_ = operation.prev_; }
+  operation.prev_ = nullptr;
+  operation.next_ = nullptr;
+}
+
+auto IoScheduler::wake() noexcept -> void {
+  if (!wakePending_.exchange(true, std::memory_order::acq_rel)) { eventfd_write(eventFd_, 1); }
+}
+}  // namespace coro
@@ -0,0 +1,46 @@
+#include <coro/mutex.hpp>
+
+namespace coro {
+auto Mutex::LockOperation::await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool {
+  awaitingCoroutine_ = awaitingCoroutine;
+  auto *state        = mutex_.state_.load(std::memory_order::acquire);
+  while (true) {
+    if (state == unlocked()) {
+      // Released in the meantime, take it without suspending.
+      if (mutex_.state_.compare_exchange_weak(
+              state, nullptr, std::memory_order::acquire, std::memory_order::acquire)) {
+        return false;
+      }
+      continue;
+    }
+
+    next_ = static_cast<detail::Waiter *>(state);
+    if (mutex_.state_.compare_exchange_weak(state, static_cast<detail::Waiter *>(this), std::memory_order::release,
+            std::memory_order::acquire)) {
+      return true;
+    }
+  }
+}
+
+auto Mutex::try_lock() noexcept -> bool {
+  auto *expected = unlocked();
+  return state_.compare_exchange_strong(expected, nullptr, std::memory_order::acquire, std::memory_order::relaxed);
+}
+
+auto Mutex::unlock() noexcept -> void {
+  auto *waiter = waiters_;
+  if (waiter == nullptr) {
+    void *expected {nullptr};
+    if (state_.compare_exchange_strong(expected, unlocked(), std::memory_order::release, std::memory_order::relaxed)) {
+      return;
+    }
+
+    // Take every waiter pushed since and put them in FIFO order.
+    waiter = detail::reverseWaiters(static_cast<detail::Waiter *>(state_.exchange(nullptr, std::memory_order::acquire)));
+  }
+
+  waiters_      = waiter->next_;
+  waiter->next_ = nullptr;
+  if (threadPool_ == nullptr || !threadPool_->resume(waiter->awaitingCoroutine_)) { detail::resumeInline(waiter); }
+}
+}  // namespace coro
@@ -0,0 +1,91 @@
+#include <coro/semaphore.hpp>
+
+#include <utility>
+
+namespace coro {
+auto Semaphore::AcquireOperation::await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool {
+  awaitingCoroutine_ = awaitingCoroutine;
+  auto state         = semaphore_.state_.load(std::memory_order::acquire);
+  while (true) {
+    if (isUnits(state)) {
+      if (unitCount(state) > 0) {
+        // Released in the meantime, take a unit without suspending.
+        if (semaphore_.state_.compare_exchange_weak(
+                state, state - 2, std::memory_order::acquire, std::memory_order::acquire)) {
+          return false;
+        }
+        continue;
+      }
+      next_ = nullptr;
+    } else {
+      next_ = reinterpret_cast<detail::Waiter *>(state);
+    }
+
+    auto *waiter = static_cast<detail::Waiter *>(this);
+    if (semaphore_.state_.compare_exchange_weak(state, reinterpret_cast<std::uintptr_t>(waiter),
+                                                std::memory_order::release, std::memory_order::acquire)) {
+      return true;
+    }
+  }
+}
+
+auto Semaphore::try_acquire() noexcept -> bool {
+  auto state = state_.load(std::memory_order::relaxed);
+  while (isUnits(state) && unitCount(state) > 0) {
+    if (state_.compare_exchange_weak(state, state - 2, std::memory_order::acquire, std::memory_order::relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+auto Semaphore::release(std::ptrdiff_t count) noexcept -> void {
+  // Only the release() taking pending_ off zero hands out units, the others leave theirs to it.
+  if (count <= 0 || pending_.fetch_add(count, std::memory_order::acq_rel) != 0) { return; }
+
+  detail::Waiter *released {nullptr};
+  detail::Waiter *releasedTail {nullptr};
+  auto claimed = count;
+  auto state   = state_.load(std::memory_order::acquire);
+  while (true) {
+    while (count > 0) {
+      if (waiters_ == nullptr) {
+        if (isUnits(state)) { break; }
+        if (!state_.compare_exchange_weak(state, units(0), std::memory_order::acq_rel, std::memory_order::acquire)) {
+          continue;
+        }
+        // Only the waiters that arrived since the previous take are reversed.
+        waiters_ = detail::reverseWaiters(reinterpret_cast<detail::Waiter *>(state));
+        state    = units(0);
+      }
+
+      auto *waiter  = std::exchange(waiters_, waiters_->next_);
+      waiter->next_ = nullptr;
+      if (releasedTail != nullptr) {
+        releasedTail->next_ = waiter;
+      } else {
+        released = waiter;
+      }
+      releasedTail = waiter;
+      --count;
+    }
+
+    // Nobody waits, the rest becomes available unless a waiter arrived in the meantime.
+    if (count > 0 && !state_.compare_exchange_weak(state, units(unitCount(state) + count),
+                         std::memory_order::acq_rel, std::memory_order::acquire)) {
+      continue;
+    }
+    // Units released meanwhile by the other release() calls.
+    count   = pending_.fetch_sub(claimed, std::memory_order::acq_rel) - claimed;
+    claimed = count;
+    if (count == 0) { break; }
+  }
+
+  detail::resumeWaiters(threadPool_, released);
+}
+
+auto Semaphore::available() const noexcept -> std::ptrdiff_t {
+  auto state = state_.load(std::memory_order::acquire);
+  return isUnits(state) ? unitCount(state) : 0;
+}
+}  // namespace coro
@@ -0,0 +1,110 @@
+#include <coro/shared_mutex.hpp>
+
+namespace coro {
+auto SharedMutex::LockOperation::await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> bool {
+  awaitingCoroutine_ = awaitingCoroutine;
+  std::scoped_lock lk {mutex_.waitMutex_};
+  auto state = mutex_.state_.load(std::memory_order::acquire);
+  while (true) {
+    auto available = shared_ ? (state & (writer_ | waiting_)) == 0 : state == 0;
+    if (available) {
+      // Released in the meantime, take it without suspending.
+      if (mutex_.state_.compare_exchange_weak(
+              state, shared_ ? state + 1 : writer_, std::memory_order::acquire, std::memory_order::acquire)) {
+        return false;
+      }
+      continue;
+    }
+
+    // From here on every unlock takes the slow path and finds this waiter queued.
+    if ((state & waiting_) != 0) { break; }
+    if (mutex_.state_.compare_exchange_weak(
+            state, state | waiting_, std::memory_order::acq_rel, std::memory_order::acquire)) {
+      break;
+    }
+  }
+
+  if (mutex_.tail_ != nullptr) {
+    mutex_.tail_->next_ = this;
+  } else {
+    mutex_.head_ = this;
+  }
+  mutex_.tail_ = this;
+  return true;
+}
+
+auto SharedMutex::try_lock() noexcept -> bool {
+  uint64_t expected {0};
+  return state_.compare_exchange_strong(expected, writer_, std::memory_order::acquire, std::memory_order::relaxed);
+}
+
+auto SharedMutex::try_lock_shared() noexcept -> bool {
+  auto state = state_.load(std::memory_order::relaxed);
+  while ((state & (writer_ | waiting_)) == 0) {
+    if (state_.compare_exchange_weak(state, state + 1, std::memory_order::acquire, std::memory_order::relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+auto SharedMutex::unlock() noexcept -> void {
+  uint64_t expected {writer_};
+  if (state_.compare_exchange_strong(expected, 0, std::memory_order::release, std::memory_order::relaxed)) { return; }
+
+  std::unique_lock lk {waitMutex_};
+  wake(lk);
+}
+
+auto SharedMutex::unlock_shared() noexcept -> void {
+  auto state = state_.load(std::memory_order::relaxed);
+  while ((state & waiting_) == 0) {
+    if (state_.compare_exchange_weak(state, state - 1, std::memory_order::release, std::memory_order::relaxed)) {
+      return;
+    }
+  }
+
+  std::unique_lock lk {waitMutex_};
+  // Only changed under waitMutex_ while waiting_ is set.
+  state = state_.fetch_sub(1, std::memory_order::acq_rel) - 1;
+  if ((state & ~waiting_) == 0) { wake(lk); }
+}
+
+auto SharedMutex::wake(std::unique_lock<std::mutex> &lk) noexcept -> void {
+  // waiting_ is only set while the queue is not empty.
+  auto *first = head_;
+  auto *last  = first;
+  uint64_t state {writer_};
+  if (first->shared_) {
+    state = 1;
+    while (last->next_ != nullptr && static_cast<LockOperation *>(last->next_)->shared_) {
+      last = static_cast<LockOperation *>(last->next_);
+      ++state;
+    }
+  }
+
+  head_ = static_cast<LockOperation *>(last->next_);
+  if (head_ == nullptr) {
+    tail_ = nullptr;
+  } else {
+    state |= waiting_;
+  }
+  last->next_ = nullptr;
+  state_.store(state, std::memory_order::release);
+  lk.unlock();
+
+  if (threadPool_ == nullptr) {
+    detail::resumeInline(first);
+    return;
+  }
+  for (detail::Waiter *waiter = first; waiter != nullptr;) {
+    // The waiter's frame may be gone once it resumed.
+    auto *next = waiter->next_;
+    if (!threadPool_->resume(waiter->awaitingCoroutine_)) {
+      waiter->next_ = nullptr;
+      detail::resumeInline(waiter);
+    }
+    waiter = next;
+  }
+}
+}  // namespace coro
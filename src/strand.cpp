@@ -0,0 +1,61 @@
+#include <coro/strand.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace coro {
+namespace {
+/// The strand whose drainer runs on this thread, nullptr outside any strand.
+constinit thread_local const Strand *tCurrentStrand {nullptr};
+}  // namespace
+
+Strand::Strand(ThreadPool &threadPool, uint32_t drainBatch)
+    : threadPool_(threadPool), drainBatch_(std::max(drainBatch, 1u)), drainer_(drain()) {}
+
+auto Strand::ScheduleOperation::await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> void {
+  node_.handle_ = awaitingCoroutine;
+  strand_.post(node_);
+}
+
+auto Strand::running_in_this_thread() const noexcept -> bool { return tCurrentStrand == this; }
+
+auto Strand::post(detail::StrandNode &node) noexcept -> void {
+  // Counted before it is linked so the drainer never runs a coroutine that is not counted yet,
+  // a drainer seeing pending_ ahead of the queue tries again in its next batch.
+  auto idle = pending_.fetch_add(1, std::memory_order::acq_rel) == 0;
+  queue_.push(node);
+  if (!idle) { return; }
+
+  // Activated by this coroutine, running the drainer next on this executor keeps it warm.
+  auto drainer = drainer_.handle();
+  if (!threadPool_.resume(drainer)) { drainer.resume(); }
+}
+
+auto Strand::Reschedule::await_suspend(std::coroutine_handle<> drainer) noexcept -> bool {
+  // Once the strand is idle another thread may resume the drainer, its frame holding this awaiter.
+  auto &strand = strand_;
+  auto ran     = ran_;
+  if (strand.pending_.fetch_sub(ran, std::memory_order::acq_rel) == ran) { return true; }
+
+  // Still busy, queue behind the other work rather than in the executor's next slot.
+  std::coroutine_handle<> handles[] {drainer};
+  return strand.threadPool_.resume(handles) != 0;
+}
+
+auto Strand::drain() -> Task<void> {
+  while (true) {
+    uint64_t ran {0};
+    auto *outer = std::exchange(tCurrentStrand, this);
+    while (ran < drainBatch_) {
+      // Empty, or the next coroutine is still being linked in and the next batch picks it up.
+      auto *node = queue_.pop();
+      if (node == nullptr) { break; }
+      ++ran;
+      // The node lives in the coroutine's frame, it is gone once the coroutine resumes.
+      node->handle_.resume();
+    }
+    tCurrentStrand = outer;
+    co_await Reschedule {*this, ran};
+  }
+}
+}  // namespace coro
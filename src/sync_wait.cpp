@@ -0,0 +1,41 @@
+#include <coro/sync_wait.hpp>
+
+#include <thread>
+
+#if defined(__linux__)
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace coro::detail {
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "the futex word is the atomic itself");
+
+auto SyncWaitEvent::set() noexcept -> void {
+  auto *address = &state_;
+  if (state_.exchange(signaled_, std::memory_order::acq_rel) != sleeping_) { return; }
+
+  // The event may be gone already, a futex wake on an address nobody waits on does nothing and
+  // one landing on a reused address is a spurious wakeup its waiter tolerates.
+#if defined(__linux__)
+  ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(address), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+  static_cast<void>(address);
+#endif
+}
+
+auto SyncWaitEvent::wait() noexcept -> void {
+  auto state = unset_;
+  if (!state_.compare_exchange_strong(state, sleeping_, std::memory_order::acquire, std::memory_order::acquire)) {
+    return;
+  }
+  while (state_.load(std::memory_order::acquire) == sleeping_) {
+#if defined(__linux__)
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&state_), FUTEX_WAIT_PRIVATE, sleeping_, nullptr, nullptr, 0);
+#else
+    // Without a futex to wake by address set() can't notify, poll instead.
+    std::this_thread::yield();
+#endif
+  }
+}
+}  // namespace coro::detail
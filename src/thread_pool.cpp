@@ -1,54 +1,348 @@
 #include <atomic>
 #include <coro/thread_pool.hpp>
+#include <coro/trace.hpp>
+#include <coro/detail/cpu_topology.hpp>
+#include <coro/detail/mpmc_queue.hpp>
 #include <coro/detail/task_self_deleting.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
 #include <stdexcept>
+#include <string>
+#include <thread>
 
 namespace coro {
-ThreadPool::ScheduleOperation::ScheduleOperation(ThreadPool &_tp) noexcept : threadPool_(_tp) {}
+#if defined(CORO_THREAD_POOL_METRICS)
+namespace detail {
+struct TimedHandle {
+  std::coroutine_handle<> handle_ {nullptr};
+  /// When the handle was queued in steady_clock nanoseconds, 0 if its queue wait is not timed.
+  uint64_t enqueuedNs_ {0};
 
-auto ThreadPool::ScheduleOperation::await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept -> void {
-  threadPool_.schedule_impl(awaitingCoroutine);
+  explicit operator bool() const noexcept { return handle_ != nullptr; }
+};
+}  // namespace detail
+#endif
+
+namespace {
+/// Tells the core this is a spin-wait loop.
+inline auto cpuRelax() noexcept -> void {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield");
+#endif
+}
+
+/// The thread pool owning the calling executor thread, if any.
+thread_local ThreadPool *tCurrentPool {nullptr};
+/// The calling executor thread's idx within tCurrentPool.
+thread_local std::size_t tCurrentWorker {0};
+
+constexpr auto laneIndex(ThreadPool::Priority priority) noexcept -> std::size_t {
+  return static_cast<std::size_t>(priority);
+}
+
+#if defined(CORO_THREAD_POOL_METRICS)
+auto nowNs() noexcept -> uint64_t {
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+/// Owner-only counters are published with a plain store, no read-modify-write needed.
+auto bump(std::atomic<uint64_t> &counter, uint64_t value = 1) noexcept -> void {
+  counter.store(counter.load(std::memory_order::relaxed) + value, std::memory_order::relaxed);
+}
+
+auto timed(std::coroutine_handle<> handle) noexcept -> detail::QueuedHandle { return {handle, nowNs()}; }
+auto untimed(std::coroutine_handle<> handle) noexcept -> detail::QueuedHandle { return {handle, 0}; }
+auto handleOf(const detail::QueuedHandle &queued) noexcept -> std::coroutine_handle<> { return queued.handle_; }
+
+/**
+ * The metrics of one executor.  Written by the executor only, on cache lines of their own so
+ * metrics() readers and thieves touching the executor's local deque never share them.
+ */
+struct alignas(64) ExecutorMetrics {
+  std::atomic<uint64_t> executed_ {0};
+  std::atomic<uint64_t> steals_ {0};
+  std::atomic<uint64_t> parks_ {0};
+  std::atomic<uint64_t> wakeups_ {0};
+  std::atomic<uint64_t> busyNs_ {0};
+  std::atomic<uint64_t> idleNs_ {0};
+  detail::AtomicLatencyHistogram queueWait_ {};
+  detail::AtomicLatencyHistogram runTime_ {};
+};
+#else
+constexpr auto timed(std::coroutine_handle<> handle) noexcept -> detail::QueuedHandle { return handle; }
+constexpr auto untimed(std::coroutine_handle<> handle) noexcept -> detail::QueuedHandle { return handle; }
+constexpr auto handleOf(detail::QueuedHandle queued) noexcept -> std::coroutine_handle<> { return queued; }
+#endif
+}  // namespace
+
+struct ThreadPool::Worker {
+  explicit Worker(std::size_t capacity) : local_(capacity) {}
+
+  /// Only used by SchedulePolicy::WorkStealing, holds normal priority coroutines only.
+  detail::WorkStealingDeque local_;
+  /// Cheap per executor state for picking steal victims.
+  uint64_t rng_ {0};
+  /// Dequeues since the last aged one, see Options::agingInterval_.
+  uint32_t sinceAged_ {0};
+  /// The index of the executor's node in nodes_.
+  std::size_t node_ {0};
+  /// The cpu the executor is pinned to, -1 if it is not pinned.
+  int cpu_ {-1};
+  /// Coroutines run from next_ in a row, see Options::nextSlotBudget_.
+  uint32_t nextStreak_ {0};
+  /// The address of the coroutine to run next, written by the executor, taken by itself or by an
+  /// executor about to park.  Counted in queued_ and its node's normal priority depth_.
+  alignas(64) std::atomic<void *> next_ {nullptr};
+#if defined(CORO_THREAD_POOL_METRICS)
+  ExecutorMetrics metrics_ {};
+#endif
+};
+
+struct ThreadPool::Lane {
+  explicit Lane(std::size_t capacity) : queue_(capacity) {}
+
+  /// The shared FIFO queue, in work-stealing mode the normal lane only receives submissions from
+  /// outside of the thread pool and local deque overflows.
+  detail::BoundedMpmcQueue<detail::QueuedHandle> queue_;
+  /// Executor thread submissions that did not fit into queue_ and came with their own ReadyNode,
+  /// e.g. a ScheduleOperation, guarded by waitMutex_.
+  detail::IntrusiveQueue<detail::ReadyNode> linked_;
+  /// The other executor thread submissions that did not fit into queue_, guarded by waitMutex_.
+  std::deque<detail::QueuedHandle> overflow_;
+  /// linked_.size() + overflow_.size(), readable without the lock.
+  std::atomic<std::size_t> overflowSize_ {0};
+  /// The number of coroutines waiting at this priority, including the normal priority ones in the
+  /// executors' local deques.  Counted before a handle is published, like queued_.
+  alignas(64) std::atomic<std::size_t> depth_ {0};
+};
+
+struct ThreadPool::Node {
+  explicit Node(std::size_t capacity) : lanes_ {Lane {capacity}, Lane {capacity}, Lane {capacity}} {}
+
+  /// Indexed by Priority.
+  std::array<Lane, priorityCount> lanes_;
+  /// The indexes of the executors running on this node.
+  std::vector<std::size_t> workers_;
+};
+
+ThreadPool::ScheduleOperation::ScheduleOperation(ThreadPool &_tp, Priority priority, bool runNext) noexcept
+    : threadPool_(_tp), priority_(priority), runNext_(runNext) {}
+
+auto ThreadPool::ScheduleOperation::await_suspend(std::coroutine_handle<> awaitingCoroutine) -> void {
+  if (!threadPool_.schedule_impl(awaitingCoroutine, priority_, &node_, runNext_)) {
+    threadPool_.size_.fetch_sub(1, std::memory_order::release);
+    throw std::runtime_error("coro::thread_pool submission queue is full, unable to schedule new tasks");
+  }
 }
 
-ThreadPool::ThreadPool(Options &&opts, PrivateConstructor) : opts_(opts) { threads_.reserve(opts_.threadCount_); }
+ThreadPool::ThreadPool(Options &&opts, PrivateConstructor) : opts_(opts) {
+  threads_.reserve(opts_.threadCount_);
+  workers_.reserve(opts_.threadCount_);
+  for (uint32_t i = 0; i < opts_.threadCount_; ++i) {
+    auto &worker = workers_.emplace_back(std::make_unique<Worker>(opts_.localQueueCapacity_));
+    worker->rng_ = i + 1;
+  }
+
+  auto pinned = !opts_.cpus_.empty() || opts_.affinity_ != AffinityPolicy::None;
+  detail::CpuTopology topology {};
+  if (pinned) {
+    topology = opts_.nodeCpus_.empty() ? detail::CpuTopology::detect() : detail::CpuTopology {opts_.nodeCpus_};
+    std::erase_if(topology.nodes_, [](const auto &cpus) { return cpus.empty(); });
+    pinned = !topology.nodes_.empty();
+  }
+
+  // Place each executor on a cpu and a topology node, compact placement fills the nodes in order.
+  std::vector<std::pair<uint32_t, std::size_t>> compact {};
+  if (pinned && opts_.cpus_.empty() && opts_.affinity_ == AffinityPolicy::Compact) {
+    for (std::size_t node = 0; node < topology.nodes_.size(); ++node) {
+      for (auto cpu : topology.nodes_[node]) { compact.emplace_back(cpu, node); }
+    }
+  }
+
+  std::vector<std::size_t> topologyNode(opts_.threadCount_, 0);
+  for (std::size_t i = 0; i < workers_.size() && pinned; ++i) {
+    if (!opts_.cpus_.empty()) {
+      auto cpu        = opts_.cpus_[i % opts_.cpus_.size()];
+      auto node       = topology.nodeOf(cpu);
+      workers_[i]->cpu_ = static_cast<int>(cpu);
+      topologyNode[i] = node == topology.nodes_.size() ? 0 : node;
+    } else if (opts_.affinity_ == AffinityPolicy::Compact) {
+      auto [cpu, node]  = compact[i % compact.size()];
+      workers_[i]->cpu_ = static_cast<int>(cpu);
+      topologyNode[i]   = node;
+    } else {
+      auto node         = i % topology.nodes_.size();
+      auto &cpus        = topology.nodes_[node];
+      workers_[i]->cpu_ = static_cast<int>(cpus[(i / topology.nodes_.size()) % cpus.size()]);
+      topologyNode[i]   = node;
+    }
+  }
+
+  // One queue node per topology node that has executors, unless everything shares a single one.
+  std::vector<std::size_t> queueNode(pinned && opts_.numaAware_ ? topology.nodes_.size() : 1, workers_.size());
+  for (std::size_t i = 0; i < workers_.size(); ++i) {
+    auto &index = queueNode[opts_.numaAware_ ? topologyNode[i] : 0];
+    if (index == workers_.size()) {
+      index = nodes_.size();
+      nodes_.emplace_back(std::make_unique<Node>(opts_.submissionQueueCapacity_));
+    }
+    workers_[i]->node_ = index;
+    nodes_[index]->workers_.emplace_back(i);
+  }
+  if (nodes_.empty()) { nodes_.emplace_back(std::make_unique<Node>(opts_.submissionQueueCapacity_)); }
+
+  if (nodes_.size() > 1) {
+    for (std::size_t node = 0; node < topology.nodes_.size(); ++node) {
+      if (queueNode[node] == workers_.size()) { continue; }
+      for (auto cpu : topology.nodes_[node]) {
+        if (cpu >= cpuNode_.size()) { cpuNode_.resize(cpu + 1, nodes_.size()); }
+        if (cpuNode_[cpu] == nodes_.size()) { cpuNode_[cpu] = queueNode[node]; }
+      }
+    }
+  }
+}
 
 auto ThreadPool::makeShared(Options opts) -> std::shared_ptr<ThreadPool> {
   auto tp = std::make_shared<ThreadPool>(std::move(opts), PrivateConstructor {});
   // Initialize once the shared pointer is constructor so it can be captured for
   // the background threads.
-  for (uint32_t i = 0; i < tp->opts_.threadCount_; ++i) { tp->executor(i); }
+  for (uint32_t i = 0; i < tp->opts_.threadCount_; ++i) {
+    tp->threads_.emplace_back([tp = tp.get(), i]() { tp->executor(i); });
+  }
   return tp;
 }
+
+auto ThreadPool::makeShared() -> std::shared_ptr<ThreadPool> { return makeShared(Options {}); }
+
 ThreadPool::~ThreadPool() { shutdown(); }
 
-auto ThreadPool::schedule() -> ScheduleOperation {
+auto ThreadPool::schedule(Priority priority) -> ScheduleOperation {
+  size_.fetch_add(1, std::memory_order::release);
+  if (!shutdownRequested_.load(std::memory_order::acquire)) {
+    return ScheduleOperation {*this, priority};
+  } else {
+    size_.fetch_sub(1, std::memory_order::release);
+    throw std::runtime_error("coro::thread_pool is shutting down, unable to schedule new tasks");
+  }
+}
+
+auto ThreadPool::schedule_local() -> ScheduleOperation {
   size_.fetch_add(1, std::memory_order::release);
   if (!shutdownRequested_.load(std::memory_order::acquire)) {
-    return ScheduleOperation {*this};
+    return ScheduleOperation {*this, Priority::Normal, true};
   } else {
     size_.fetch_sub(1, std::memory_order::release);
     throw std::runtime_error("coro::thread_pool is shutting down, unable to schedule new tasks");
   }
 }
 
-auto ThreadPool::spawn(coro::Task<void> &&task) noexcept -> bool {
+auto ThreadPool::spawn(coro::Task<void> &&task, Priority priority) noexcept -> bool {
+  auto wrapperTask = detail::makeTaskSelfDeleting(std::move(task));
+  return spawn_impl(wrapperTask, priority);
+}
+
+auto ThreadPool::spawn(std::allocator_arg_t, std::pmr::polymorphic_allocator<> allocator, coro::Task<void> &&task,
+    Priority priority) noexcept -> bool {
+  auto wrapperTask = detail::makeTaskSelfDeleting(std::allocator_arg, allocator, std::move(task));
+  return spawn_impl(wrapperTask, priority);
+}
+
+auto ThreadPool::spawn_impl(detail::TaskSelfDeleting &wrapperTask, Priority priority) noexcept -> bool {
+  size_.fetch_add(1, std::memory_order::release);
+  wrapperTask.promise().executor_size(size_);
   size_.fetch_add(1, std::memory_order::release);
+  if (shutdownRequested_.load(std::memory_order::acquire) ||
+      !schedule_impl(wrapperTask.handle(), priority, &wrapperTask.promise().ready_node())) {
+    // Never started, so the frame will not delete itself.
+    wrapperTask.handle().destroy();
+    size_.fetch_sub(2, std::memory_order::release);
+    return false;
+  }
+  return true;
+}
+
+auto ThreadPool::prepare_spawn(coro::Task<void> &&task) -> std::coroutine_handle<> {
   auto wrapperTask = detail::makeTaskSelfDeleting(std::move(task));
+  size_.fetch_add(1, std::memory_order::release);
   wrapperTask.promise().executor_size(size_);
-  return resume(wrapperTask.handle());
+  return wrapperTask.handle();
+}
+
+auto ThreadPool::spawn_batch(std::span<const std::coroutine_handle<>> handles, Priority priority) noexcept
+    -> std::size_t {
+  std::size_t spawned {0};
+  if (!shutdownRequested_.load(std::memory_order::acquire)) { spawned = submit(handles, priority); }
+
+  for (auto handle : handles.subspan(spawned)) {
+    // Never started, so the frame will not delete itself.
+    handle.destroy();
+    size_.fetch_sub(1, std::memory_order::release);
+  }
+  return spawned;
 }
 
-auto ThreadPool::resume(std::coroutine_handle<> handle) noexcept -> bool {
+auto ThreadPool::submit(std::span<const std::coroutine_handle<>> handles, Priority priority) noexcept
+    -> std::size_t {
+  size_.fetch_add(handles.size(), std::memory_order::release);
+  auto queued = enqueue_batch(handles, priority);
+  if (queued < handles.size()) { size_.fetch_sub(handles.size() - queued, std::memory_order::release); }
+  return queued;
+}
+
+auto ThreadPool::resume(std::coroutine_handle<> handle, Priority priority) noexcept -> bool {
   if (handle == nullptr || handle.done()) { return false; }
   size_.fetch_add(1, std::memory_order::release);
-  if (shutdownRequested_.load(std::memory_order_acquire)) {
+  if (shutdownRequested_.load(std::memory_order_acquire) || !schedule_impl(handle, priority, nullptr, true)) {
     size_.fetch_sub(1, std::memory_order::release);
     return false;
   }
-  schedule_impl(handle);
   return true;
 }
 
+auto ThreadPool::queue_size(Priority priority) const noexcept -> std::size_t {
+  std::size_t size {0};
+  for (const auto &node : nodes_) { size += node->lanes_[laneIndex(priority)].depth_.load(std::memory_order::acquire); }
+  return size;
+}
+
+auto ThreadPool::Metrics::total() const noexcept -> WorkerMetrics {
+  WorkerMetrics total {};
+  for (const auto &worker : workers_) {
+    total.executed_ += worker.executed_;
+    total.steals_ += worker.steals_;
+    total.parks_ += worker.parks_;
+    total.wakeups_ += worker.wakeups_;
+    total.busy_ += worker.busy_;
+    total.idle_ += worker.idle_;
+  }
+  return total;
+}
+
+auto ThreadPool::metrics() const -> Metrics {
+  Metrics metrics {};
+  metrics.workers_.resize(workers_.size());
+#if defined(CORO_THREAD_POOL_METRICS)
+  for (std::size_t i = 0; i < workers_.size(); ++i) {
+    const auto &from = workers_[i]->metrics_;
+    auto &to         = metrics.workers_[i];
+    to.executed_     = from.executed_.load(std::memory_order::relaxed);
+    to.steals_       = from.steals_.load(std::memory_order::relaxed);
+    to.parks_        = from.parks_.load(std::memory_order::relaxed);
+    to.wakeups_      = from.wakeups_.load(std::memory_order::relaxed);
+    to.busy_         = std::chrono::nanoseconds {from.busyNs_.load(std::memory_order::relaxed)};
+    to.idle_         = std::chrono::nanoseconds {from.idleNs_.load(std::memory_order::relaxed)};
+    from.queueWait_.add_to(metrics.queueWait_);
+    from.runTime_.add_to(metrics.runTime_);
+  }
+#endif
+  return metrics;
+}
+
 auto ThreadPool::shutdown() noexcept -> void {
   if (shutdownRequested_.exchange(true, std::memory_order::acq_rel) == false) {
     {
@@ -65,50 +359,374 @@ auto ThreadPool::shutdown() noexcept -> void {
 }
 
 auto ThreadPool::executor(std::size_t idx) -> void {
+  tCurrentPool   = this;
+  tCurrentWorker = idx;
+  if (auto cpu = workers_[idx]->cpu_; cpu >= 0) { detail::pinCurrentThread(static_cast<uint32_t>(cpu)); }
+  if constexpr (trace::enabled) {
+    trace::set_thread_name("coro::ThreadPool executor " + std::to_string(idx));
+  }
   if (opts_.onThreadStart_) { opts_.onThreadStart_(idx); }
 
+  auto run = [&](detail::QueuedHandle queued) {
+    auto handle = handleOf(queued);
+    detail::trace(detail::TraceEvent::ResumeBegin, handle.address());
+#if defined(CORO_THREAD_POOL_METRICS)
+    auto &metrics = workers_[idx]->metrics_;
+    auto start    = nowNs();
+    if (queued.enqueuedNs_ != 0) { metrics.queueWait_.record(start - std::min(start, queued.enqueuedNs_)); }
+    handle.resume();
+    auto ran = nowNs() - start;
+    metrics.runTime_.record(ran);
+    bump(metrics.busyNs_, ran);
+    bump(metrics.executed_);
+#else
+    handle.resume();
+#endif
+    detail::trace(detail::TraceEvent::ResumeEnd, handle.address());
+    size_.fetch_sub(1, std::memory_order::release);
+  };
+
   // Process until shutdown is requested
   while (!shutdownRequested_.load(std::memory_order::acquire)) {
-    std::unique_lock lk {waitMutex_};
-    waitCv_.wait(lk, [&]() { return !queue_.empty() || shutdownRequested_.load(std::memory_order::acquire); });
-
-    if (queue_.empty()) { continue; }
-
-    auto handle = queue_.front();
-    queue_.pop_front();
-    lk.unlock();
+    auto queued = dequeue(idx);
+    if (!queued) {
+#if defined(CORO_THREAD_POOL_METRICS)
+      auto idleStart = nowNs();
+      queued         = idle(idx);
+      bump(workers_[idx]->metrics_.idleNs_, nowNs() - idleStart);
+#else
+      queued = idle(idx);
+#endif
+      if (!queued) { continue; }
+    }
 
-    // Release the lock while executing the coroutine
-    handle.resume();
-    size_.fetch_sub(1, std::memory_order::release);
+    run(queued);
   }
 
   // Process until there are no ready tasks left
   while (size_.load(std::memory_order::acquire)) {
-    std::unique_lock lk {waitMutex_};
     // size_ will only drop to zero once all executing coroutines are finished
-    // but the queue could be empty for threads that finished early
+    // but the queues could be empty for threads that finished early
+    auto queued = dequeue(idx);
+    if (!queued) { break; }
 
-    if (queue_.empty()) { break; }
+    run(queued);
+  }
 
-    auto handle = queue_.front();
-    queue_.pop_front();
-    lk.unlock();
+  if (opts_.onThreadStop_) { opts_.onThreadStop_(idx); }
+  tCurrentPool = nullptr;
+}
 
-    // Release the lock while executing the coroutine
-    handle.resume();
-    size_.fetch_sub(1, std::memory_order::release);
+auto ThreadPool::schedule_impl(
+    std::coroutine_handle<> handle, Priority priority, detail::ReadyNode *node, bool runNext) noexcept -> bool {
+  if (runNext && priority == Priority::Normal && opts_.nextSlotBudget_ != 0 && tCurrentPool == this) {
+    // The executor runs it itself, only a displaced coroutine needs another one.
+    if (enqueue_next(handle)) { wake(1); }
+    return true;
   }
 
-  if (opts_.onThreadStop_) { opts_.onThreadStop_(idx); }
+  if (!enqueue(handle, priority, node)) { return false; }
+  wake(1);
+  return true;
+}
+
+auto ThreadPool::enqueue(std::coroutine_handle<> handle, Priority priority, detail::ReadyNode *node) noexcept
+    -> bool {
+  detail::trace(detail::TraceEvent::Schedule, handle.address(), this);
+  auto &lane = submission_node().lanes_[laneIndex(priority)];
+  // Counted before the handle is visible so a parking executor never misses it, see park().
+  queued_.fetch_add(1, std::memory_order::seq_cst);
+  lane.depth_.fetch_add(1, std::memory_order::relaxed);
+  if (publish(lane, handle, priority, node)) { return true; }
+
+  // Outside callers can be told to back off, see Options::submissionQueueCapacity_.
+  lane.depth_.fetch_sub(1, std::memory_order::relaxed);
+  queued_.fetch_sub(1, std::memory_order::relaxed);
+  return false;
+}
+
+auto ThreadPool::publish(Lane &lane, std::coroutine_handle<> handle, Priority priority, detail::ReadyNode *node) noexcept
+    -> bool {
+  auto onExecutor = tCurrentPool == this;
+  if (opts_.policy_ == SchedulePolicy::WorkStealing && onExecutor && priority == Priority::Normal) {
+    if (workers_[tCurrentWorker]->local_.push(handle)) { return true; }
+  }
+
+  if (lane.queue_.try_push(timed(handle))) { return true; }
+  if (!onExecutor) { return false; }
+
+  // A continuation produced by an executor can't be refused without losing it.
+  std::scoped_lock lk {waitMutex_};
+  if (node != nullptr) {
+    node->handle_ = handle;
+#if defined(CORO_THREAD_POOL_METRICS)
+    node->enqueuedNs_ = nowNs();
+#endif
+    lane.linked_.push_back(*node);
+  } else {
+    lane.overflow_.emplace_back(timed(handle));
+  }
+  lane.overflowSize_.fetch_add(1, std::memory_order::release);
+  return true;
+}
+
+auto ThreadPool::enqueue_next(std::coroutine_handle<> handle) noexcept -> bool {
+  detail::trace(detail::TraceEvent::Schedule, handle.address(), this);
+  auto &self = *workers_[tCurrentWorker];
+  auto &lane = nodes_[self.node_]->lanes_[laneIndex(Priority::Normal)];
+  queued_.fetch_add(1, std::memory_order::seq_cst);
+  lane.depth_.fetch_add(1, std::memory_order::relaxed);
+
+  auto *displaced = self.next_.exchange(handle.address(), std::memory_order::acq_rel);
+  if (displaced == nullptr) { return false; }
+
+  // Already counted, and queued by an executor so it can't be refused.
+  publish(lane, std::coroutine_handle<>::from_address(displaced), Priority::Normal, nullptr);
+  return true;
 }
 
-auto ThreadPool::schedule_impl(std::coroutine_handle<> handle) noexcept -> void {
-  if (handle == nullptr || handle.done()) { return; }
-  {
-    std::scoped_lock lk(waitMutex_);
-    queue_.emplace_back(handle);
-    waitCv_.notify_one();
+auto ThreadPool::enqueue_batch(std::span<const std::coroutine_handle<>> handles, Priority priority) noexcept
+    -> std::size_t {
+  if constexpr (trace::enabled) {
+    for (auto handle : handles) { detail::trace(detail::TraceEvent::Schedule, handle.address(), this); }
+  }
+  auto &lane = submission_node().lanes_[laneIndex(priority)];
+  queued_.fetch_add(handles.size(), std::memory_order::seq_cst);
+  lane.depth_.fetch_add(handles.size(), std::memory_order::relaxed);
+
+#if defined(CORO_THREAD_POOL_METRICS)
+  std::array<detail::QueuedHandle, batchSize_> stamped;
+  auto now = nowNs();
+  std::ranges::transform(handles, stamped.begin(), [now](auto handle) { return detail::QueuedHandle {handle, now}; });
+  std::span<const detail::QueuedHandle> values {stamped.data(), handles.size()};
+#else
+  auto values = handles;
+#endif
+
+  auto pushed = lane.queue_.try_push_bulk(values.data(), values.size());
+  if (pushed == values.size()) { return pushed; }
+
+  auto remaining = values.size() - pushed;
+  if (tCurrentPool != this) {
+    lane.depth_.fetch_sub(remaining, std::memory_order::relaxed);
+    queued_.fetch_sub(remaining, std::memory_order::relaxed);
+    return pushed;
+  }
+
+  std::scoped_lock lk {waitMutex_};
+  lane.overflow_.insert(lane.overflow_.end(), values.begin() + pushed, values.end());
+  lane.overflowSize_.fetch_add(remaining, std::memory_order::release);
+  return handles.size();
+}
+
+auto ThreadPool::submission_node() noexcept -> Node & {
+  if (tCurrentPool == this) { return *nodes_[workers_[tCurrentWorker]->node_]; }
+  if (nodes_.size() == 1) { return *nodes_.front(); }
+
+  auto cpu = detail::currentCpu();
+  if (cpu >= 0 && static_cast<std::size_t>(cpu) < cpuNode_.size() && cpuNode_[cpu] < nodes_.size()) {
+    return *nodes_[cpuNode_[cpu]];
+  }
+  return *nodes_[nextNode_.fetch_add(1, std::memory_order::relaxed) % nodes_.size()];
+}
+
+auto ThreadPool::dequeue_lane(Node &node, Priority priority) noexcept -> detail::QueuedHandle {
+  auto &lane = node.lanes_[laneIndex(priority)];
+  if (lane.depth_.load(std::memory_order::acquire) == 0) { return {}; }
+
+  // The overflow is older than anything currently in the shared queue, drain it first.
+  if (lane.overflowSize_.load(std::memory_order::acquire) > 0) {
+    std::scoped_lock lk {waitMutex_};
+    if (auto *linked = lane.linked_.pop_front()) {
+      lane.overflowSize_.fetch_sub(1, std::memory_order::release);
+#if defined(CORO_THREAD_POOL_METRICS)
+      return {linked->handle_, linked->enqueuedNs_};
+#else
+      return linked->handle_;
+#endif
+    }
+    if (!lane.overflow_.empty()) {
+      auto queued = lane.overflow_.front();
+      lane.overflow_.pop_front();
+      lane.overflowSize_.fetch_sub(1, std::memory_order::release);
+      return queued;
+    }
+  }
+
+  detail::QueuedHandle queued {};
+  lane.queue_.try_pop(queued);
+  return queued;
+}
+
+auto ThreadPool::dequeue(std::size_t idx) noexcept -> detail::QueuedHandle {
+  auto taken = [this](detail::QueuedHandle queued, Node &node, Priority priority) {
+    node.lanes_[laneIndex(priority)].depth_.fetch_sub(1, std::memory_order::relaxed);
+    queued_.fetch_sub(1, std::memory_order::relaxed);
+    return queued;
+  };
+  auto workStealing = opts_.policy_ == SchedulePolicy::WorkStealing;
+
+  auto &self = *workers_[idx];
+  auto &home = *nodes_[self.node_];
+  auto next  = [&]() -> detail::QueuedHandle {
+    if (self.next_.load(std::memory_order::relaxed) == nullptr) { return {}; }
+    auto *address = self.next_.exchange(nullptr, std::memory_order::acquire);
+    if (address == nullptr) { return {}; }
+    return taken(untimed(std::coroutine_handle<>::from_address(address)), home, Priority::Normal);
+  };
+  if (self.nextStreak_ < opts_.nextSlotBudget_) {
+    if (auto queued = next()) {
+      ++self.nextStreak_;
+      return queued;
+    }
+  }
+  self.nextStreak_ = 0;
+
+  auto aged = opts_.agingInterval_ != 0 && ++self.sinceAged_ >= opts_.agingInterval_;
+  if (aged) {
+    // Serve the lanes bottom up once so a busy higher lane can't starve the lower ones.
+    self.sinceAged_ = 0;
+    for (auto priority : {Priority::Low, Priority::Normal, Priority::High}) {
+      if (auto queued = dequeue_lane(home, priority)) { return taken(queued, home, priority); }
+    }
+  } else if (auto queued = dequeue_lane(home, Priority::High)) {
+    // High priority work is never in the local deques, so it goes ahead of them.
+    return taken(queued, home, Priority::High);
+  }
+
+  if (workStealing) {
+    if (auto handle = self.local_.pop()) { return taken(untimed(handle), home, Priority::Normal); }
+  }
+
+  if (queued_.load(std::memory_order::acquire) == 0) { return {}; }
+
+  if (!aged) {
+    for (auto priority : {Priority::Normal, Priority::Low}) {
+      if (auto queued = dequeue_lane(home, priority)) { return taken(queued, home, priority); }
+    }
+  }
+
+  // xorshift64, only needs to spread the victims around.
+  self.rng_ ^= self.rng_ << 13;
+  self.rng_ ^= self.rng_ >> 7;
+  self.rng_ ^= self.rng_ << 17;
+
+  // Steal within the node first, the coroutine's memory is most likely local to it.
+  auto steal = [&](const std::vector<std::size_t> &victims) -> detail::QueuedHandle {
+    auto count = victims.size();
+    auto start = static_cast<std::size_t>(self.rng_ % count);
+    for (std::size_t i = 0; i < count; ++i) {
+      auto victim = victims[(start + i) % count];
+      if (victim == idx) { continue; }
+      if (auto handle = workers_[victim]->local_.steal()) {
+#if defined(CORO_THREAD_POOL_METRICS)
+        bump(self.metrics_.steals_);
+#endif
+        return taken(untimed(handle), *nodes_[workers_[victim]->node_], Priority::Normal);
+      }
+    }
+    return {};
+  };
+  if (workStealing) {
+    if (auto queued = steal(home.workers_)) { return queued; }
+  }
+
+  // Only then take work from the other nodes, starting with the next one.
+  for (std::size_t i = 1; i < nodes_.size(); ++i) {
+    auto &remote = *nodes_[(self.node_ + i) % nodes_.size()];
+    for (auto priority : {Priority::High, Priority::Normal, Priority::Low}) {
+      if (auto queued = dequeue_lane(remote, priority)) { return taken(queued, remote, priority); }
+    }
+    if (workStealing) {
+      if (auto queued = steal(remote.workers_)) { return queued; }
+    }
+  }
+
+  // The budget ran out but there is nothing else to run.
+  return next();
+}
+
+auto ThreadPool::steal_next(std::size_t idx) noexcept -> detail::QueuedHandle {
+  for (std::size_t i = 1; i < workers_.size(); ++i) {
+    auto &victim = *workers_[(idx + i) % workers_.size()];
+    if (victim.next_.load(std::memory_order::relaxed) == nullptr) { continue; }
+    if (auto *address = victim.next_.exchange(nullptr, std::memory_order::acquire)) {
+      nodes_[victim.node_]->lanes_[laneIndex(Priority::Normal)].depth_.fetch_sub(1, std::memory_order::relaxed);
+      queued_.fetch_sub(1, std::memory_order::relaxed);
+      return untimed(std::coroutine_handle<>::from_address(address));
+    }
+  }
+  return {};
+}
+
+auto ThreadPool::idle(std::size_t idx) -> detail::QueuedHandle {
+  spinning_.fetch_add(1, std::memory_order::seq_cst);
+
+  auto found = [&](detail::QueuedHandle queued) {
+    if (queued) {
+      // The last spinner found work, producers may have skipped waking anyone on its behalf.
+      if (spinning_.fetch_sub(1, std::memory_order::seq_cst) == 1 && queued_.load(std::memory_order::seq_cst) > 0) {
+        wake(1);
+      }
+    }
+    return queued;
+  };
+  auto poll = [&]() -> detail::QueuedHandle {
+    if (queued_.load(std::memory_order::relaxed) == 0) { return {}; }
+    return found(dequeue(idx));
+  };
+
+  for (uint32_t i = 0; i < opts_.idleSpinCount_ && !shutdownRequested_.load(std::memory_order::relaxed); ++i) {
+    cpuRelax();
+    if (auto queued = poll()) { return queued; }
+  }
+
+  for (uint32_t i = 0; i < opts_.idleYieldCount_ && !shutdownRequested_.load(std::memory_order::relaxed); ++i) {
+    std::this_thread::yield();
+    if (auto queued = poll()) { return queued; }
+  }
+
+  // Only once out of spins, the owners of the next slots usually get to them first.
+  if (auto queued = found(steal_next(idx))) { return queued; }
+
+  spinning_.fetch_sub(1, std::memory_order::seq_cst);
+  park(idx);
+  return {};
+}
+
+auto ThreadPool::park(std::size_t idx) -> void {
+  std::unique_lock lk {waitMutex_};
+  // Announce the intent to sleep before the final check, a producer either sees a sleeper
+  // and notifies under the lock or this executor sees the producer's queued_ increment.
+  sleeping_.fetch_add(1, std::memory_order::seq_cst);
+  if (queued_.load(std::memory_order::seq_cst) == 0 && !shutdownRequested_.load(std::memory_order::acquire)) {
+    waitCv_.wait(lk);
+#if defined(CORO_THREAD_POOL_METRICS)
+    auto &metrics = workers_[idx]->metrics_;
+    bump(metrics.parks_);
+    if (queued_.load(std::memory_order::relaxed) > 0) { bump(metrics.wakeups_); }
+#endif
+  }
+  sleeping_.fetch_sub(1, std::memory_order::relaxed);
+}
+
+auto ThreadPool::wake(uint64_t count) noexcept -> void {
+  if (count == 0) { return; }
+
+  auto sleeping = sleeping_.load(std::memory_order::seq_cst);
+  if (sleeping == 0) { return; }
+
+  // Spinning executors pick the work up without a futex wake, they re-check queued_ before
+  // parking so skipping them here can't strand a handle.
+  auto spinning = spinning_.load(std::memory_order::seq_cst);
+  if (count <= spinning) { return; }
+  count -= spinning;
+
+  std::scoped_lock lk {waitMutex_};
+  if (count >= sleeping) {
+    waitCv_.notify_all();
+  } else {
+    for (uint64_t i = 0; i < count; ++i) { waitCv_.notify_one(); }
   }
 }
 }  // namespace coro
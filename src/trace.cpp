@@ -0,0 +1,273 @@
+#include <coro/trace.hpp>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace coro {
+#if defined(CORO_TRACING)
+namespace detail {
+constinit thread_local TraceBuffer *tTraceBuffer {nullptr};
+}  // namespace detail
+
+namespace {
+auto nowNs() noexcept -> uint64_t {
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+struct Registry {
+  std::mutex mutex_ {};
+  std::vector<std::unique_ptr<detail::TraceBuffer>> buffers_ {};
+  uint32_t nextThreadId_ {1};
+  /// The buffers of exited threads waiting for the next flush.
+  std::size_t retired_ {0};
+  /// The unflushed events of the retired buffers dropped beyond TraceBuffer::maxRetired_.
+  uint64_t dropped_ {0};
+  /// Both clocks when tracing started, event ticks are converted to nanoseconds since then.
+  uint64_t startTicks_ {detail::TraceBuffer::ticks()};
+  uint64_t startNs_ {nowNs()};
+};
+
+auto traceRegistry() -> Registry & {
+  // Never destroyed, threads may still record while static destructors run.
+  static auto *registry = new Registry {};
+  return *registry;
+}
+
+/**
+ * Retires the thread's buffer when the thread exits, kept apart from tTraceBuffer so recording
+ * does not go through the thread_local initialization guard.  A buffer with nothing left to flush
+ * is freed right away, the others wait for the next flush up to TraceBuffer::maxRetired_ of them.
+ */
+struct BufferRetirer {
+  ~BufferRetirer() {
+    auto *buffer = std::exchange(detail::tTraceBuffer, nullptr);
+    if (buffer == nullptr) { return; }
+
+    auto &registry = traceRegistry();
+    std::scoped_lock lk {registry.mutex_};
+    auto &buffers = registry.buffers_;
+    if (buffer->head_.load(std::memory_order::relaxed) == buffer->flushed_) {
+      std::erase_if(buffers, [buffer](const auto &registered) { return registered.get() == buffer; });
+      return;
+    }
+
+    buffer->retired_ = true;
+    if (++registry.retired_ <= detail::TraceBuffer::maxRetired_) { return; }
+    // Bounds the memory held for threads that exited without being flushed, about 1.5 MB each.
+    auto oldest = std::ranges::find_if(buffers, [](const auto &registered) { return registered->retired_; });
+    registry.dropped_ += (*oldest)->head_.load(std::memory_order::relaxed) - (*oldest)->flushed_;
+    buffers.erase(oldest);
+    --registry.retired_;
+  }
+};
+thread_local BufferRetirer tBufferRetirer {};
+
+/**
+ * An event copied out of a TraceBuffer::Slot.
+ */
+struct CopiedEvent {
+  uint64_t ticks_;
+  uintptr_t coroutine_;
+  uintptr_t other_;
+};
+
+/**
+ * Writes the events as Chrome trace event objects, separated by commas.
+ */
+class ChromeTraceWriter {
+public:
+  ChromeTraceWriter(std::ostream &out, double nsPerTick, uint64_t startTicks)
+      : out_(out), nsPerTick_(nsPerTick), startTicks_(startTicks) {}
+
+  /**
+   * The following events were recorded by the thread, named name unless it is empty.
+   */
+  auto thread(uint32_t threadId, const std::string &name) -> void {
+    threadId_ = threadId;
+    depth_    = 0;
+    if (name.empty()) { return; }
+
+    std::string escaped {};
+    for (auto c : name) {
+      if (c == '"' || c == '\\') { escaped += '\\'; }
+      if (static_cast<unsigned char>(c) >= 0x20) { escaped += c; }
+    }
+    object(R"("name":"thread_name","ph":"M","args":{"name":"%s"})", escaped.c_str());
+  }
+
+  /**
+   * @return False if the event was skipped.
+   */
+  auto write(const CopiedEvent &copied) -> bool {
+    auto event     = static_cast<detail::TraceEvent>(copied.other_ & 0xff);
+    auto other     = copied.other_ >> 8;
+    auto coroutine = copied.coroutine_;
+
+    // Microseconds since tracing started, with nanosecond precision.
+    auto elapsed = copied.ticks_ > startTicks_ ? copied.ticks_ - startTicks_ : 0;
+    auto ns      = static_cast<uint64_t>(static_cast<double>(elapsed) * nsPerTick_);
+    char ts[32];
+    std::snprintf(ts, sizeof(ts), "%" PRIu64 ".%03" PRIu64, ns / 1000, ns % 1000);
+
+    switch (event) {
+      case detail::TraceEvent::Schedule:
+        instant("schedule", ts, coroutine, "pool", other);
+        flow("s", ts, coroutine);
+        break;
+      case detail::TraceEvent::ResumeBegin:
+        ++depth_;
+        object(R"("name":"resume","ph":"B","ts":%s,"args":{"coroutine":"0x%)" PRIxPTR R"("})", ts, coroutine);
+        flow("f", ts, coroutine);
+        break;
+      case detail::TraceEvent::ResumeEnd:
+        // The matching begin was overwritten or went out with the previous flush.
+        if (depth_ == 0) { return false; }
+        --depth_;
+        object(R"("ph":"E","ts":%s)", ts);
+        break;
+      case detail::TraceEvent::Suspend: instant("suspend", ts, coroutine, "on", other); break;
+      case detail::TraceEvent::Continuation: instant("continuation", ts, coroutine, "continuation", other); break;
+      case detail::TraceEvent::Spawn: instant("spawn", ts, coroutine, nullptr, 0); break;
+      case detail::TraceEvent::SelfDelete: instant("self delete", ts, coroutine, nullptr, 0); break;
+      default: return false;
+    }
+    return true;
+  }
+
+private:
+  template <typename... arg_types>
+  auto object(const char *format, arg_types... args) -> void {
+    char fields[256];
+    std::snprintf(fields, sizeof(fields), format, args...);
+    out_ << (std::exchange(first_, false) ? "\n" : ",\n") << R"({"cat":"coro","pid":1,"tid":)" << threadId_ << ','
+         << fields << '}';
+  }
+
+  auto instant(const char *name, const char *ts, uintptr_t coroutine, const char *otherName, uintptr_t other)
+      -> void {
+    char args[96];
+    auto length = std::snprintf(args, sizeof(args), R"("coroutine":"0x%)" PRIxPTR R"(")", coroutine);
+    if (otherName != nullptr) {
+      std::snprintf(args + length, sizeof(args) - length, R"(,"%s":"0x%)" PRIxPTR R"(")", otherName, other);
+    }
+    object(R"("name":"%s","ph":"i","s":"t","ts":%s,"args":{%s})", name, ts, args);
+  }
+
+  /**
+   * Links the schedule of a coroutine to its resumption.
+   */
+  auto flow(const char *phase, const char *ts, uintptr_t coroutine) -> void {
+    object(R"("name":"queued","ph":"%s","bp":"e","ts":%s,"id":"0x%)" PRIxPTR R"(")", phase, ts, coroutine);
+  }
+
+  std::ostream &out_;
+  double nsPerTick_;
+  uint64_t startTicks_;
+  uint32_t threadId_ {0};
+  /// The resumptions begun and not ended yet on the current thread.
+  std::size_t depth_ {0};
+  /// No comma before the first object.
+  bool first_ {true};
+};
+}  // namespace
+
+auto detail::registerTraceBuffer() noexcept -> TraceBuffer * {
+  auto &registry = traceRegistry();
+  std::scoped_lock lk {registry.mutex_};
+  try {
+    auto &buffer = registry.buffers_.emplace_back(std::make_unique<TraceBuffer>(registry.nextThreadId_));
+    ++registry.nextThreadId_;
+    // Touching the retirer registers its destructor for this thread.
+    static_cast<void>(tBufferRetirer);
+    tTraceBuffer = buffer.get();
+  } catch (...) { return nullptr; }
+  return tTraceBuffer;
+}
+#endif
+
+namespace trace {
+auto set_thread_name([[maybe_unused]] std::string_view name) -> void {
+#if defined(CORO_TRACING)
+  auto *buffer = detail::tTraceBuffer != nullptr ? detail::tTraceBuffer : detail::registerTraceBuffer();
+  if (buffer == nullptr) { return; }
+  std::scoped_lock lk {traceRegistry().mutex_};
+  buffer->name_ = name;
+#endif
+}
+
+auto write_chrome_trace(std::ostream &out) -> std::size_t {
+  std::size_t written {0};
+  uint64_t lost {0};
+  out << R"({"displayTimeUnit":"ns","traceEvents":[)";
+#if defined(CORO_TRACING)
+  auto &registry = traceRegistry();
+  std::scoped_lock lk {registry.mutex_};
+
+  // Maps the cycle counter onto the steady clock over the whole time traced so far.
+  auto ticks     = detail::TraceBuffer::ticks() - registry.startTicks_;
+  auto ns        = nowNs() - registry.startNs_;
+  auto nsPerTick = ticks == 0 ? 1.0 : static_cast<double>(ns) / static_cast<double>(ticks);
+
+  constexpr auto capacity = detail::TraceBuffer::capacity_;
+  ChromeTraceWriter writer {out, nsPerTick, registry.startTicks_};
+  std::vector<CopiedEvent> copied {};
+  for (auto &buffer : registry.buffers_) {
+    writer.thread(buffer->threadId_, buffer->name_);
+
+    // A retired buffer's events are all visible, its owner retired it under the mutex.
+    auto retired = buffer->retired_;
+    auto head    = buffer->head_.load(std::memory_order::acquire);
+    auto from    = std::max(buffer->flushed_, head > capacity ? head - capacity : 0);
+    lost += from - buffer->flushed_;
+
+    copied.clear();
+    for (auto i = from; i < head; ++i) {
+      auto &slot = buffer->slots_[i & (capacity - 1)];
+      copied.emplace_back(slot.ticks_.load(std::memory_order::relaxed),
+          slot.coroutine_.load(std::memory_order::relaxed), slot.other_.load(std::memory_order::relaxed));
+    }
+
+    // The owner kept recording meanwhile, the slots it reused may have been copied torn.  The owner's
+    // release fence before its slot stores pairs with this acquire fence: having copied any store of
+    // the event of index j, head_ reads at least j.  The slot of index reused - capacity may thus
+    // be half overwritten already, the ones before it certainly are.
+    std::atomic_thread_fence(std::memory_order::acquire);
+    auto reused = buffer->head_.load(std::memory_order::relaxed);
+    auto valid  = std::max(from, reused >= capacity ? reused - capacity + 1 : 0);
+    lost += std::min(valid, head) - from;
+    for (auto i = valid; i < head; ++i) {
+      if (writer.write(copied[i - from])) { ++written; }
+    }
+    buffer->flushed_ = head;
+    if (retired) {
+      buffer.reset();
+      --registry.retired_;
+    }
+  }
+  std::erase(registry.buffers_, nullptr);
+  lost += std::exchange(registry.dropped_, 0);
+#endif
+  out << "\n],\"otherData\":{\"lostEvents\":" << lost << "}}\n";
+  return written;
+}
+
+auto write_chrome_trace(const std::filesystem::path &path) -> std::size_t {
+  std::ofstream out {path, std::ios::trunc};
+  if (!out) { throw std::runtime_error {"coro::trace unable to open " + path.string()}; }
+  auto written = write_chrome_trace(out);
+  out.flush();
+  if (!out) { throw std::runtime_error {"coro::trace unable to write " + path.string()}; }
+  return written;
+}
+}  // namespace trace
+}  // namespace coro
@@ -0,0 +1,165 @@
+#include <coro/channel.hpp>
+#include <coro/sync_wait.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/when_all.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(ChannelTest, TrySendAndRecvInOrder) {
+  coro::Channel<std::string> channel {3};
+  EXPECT_EQ(channel.capacity(), 4);
+  EXPECT_TRUE(channel.empty());
+
+  for (int i = 0; i < 4; ++i) { EXPECT_TRUE(channel.try_send(std::to_string(i))); }
+  std::string rejected {"rejected"};
+  EXPECT_FALSE(channel.try_send(std::move(rejected)));
+  EXPECT_EQ(rejected, "rejected");
+  EXPECT_EQ(channel.size(), 4);
+
+  for (int i = 0; i < 4; ++i) { EXPECT_EQ(channel.try_recv(), std::to_string(i)); }
+  EXPECT_EQ(channel.try_recv(), std::nullopt);
+}
+
+TEST(ChannelTest, BatchedSendAndRecv) {
+  coro::Channel<std::unique_ptr<int>> channel {8};
+  std::vector<std::unique_ptr<int>> values {};
+  for (int i = 0; i < 10; ++i) { values.emplace_back(std::make_unique<int>(i)); }
+
+  EXPECT_EQ(channel.try_send_n(values), 8);
+  EXPECT_EQ(values[7], nullptr);
+  ASSERT_NE(values[8], nullptr);
+
+  std::vector<std::unique_ptr<int>> received(5);
+  EXPECT_EQ(channel.try_recv_n(received), 5);
+  for (int i = 0; i < 5; ++i) { EXPECT_EQ(*received[i], i); }
+  EXPECT_EQ(channel.try_send_n(std::span {values}.subspan(8)), 2);
+
+  received.resize(10);
+  EXPECT_EQ(channel.try_recv_n(received), 5);
+  EXPECT_EQ(*received[0], 5);
+  EXPECT_EQ(*received[4], 9);
+  EXPECT_EQ(channel.try_recv_n(received), 0);
+}
+
+TEST(ChannelTest, SendSuspendsWhileFull) {
+  coro::Channel<int> channel {2};
+  std::vector<int> sent {};
+  auto sender = [](coro::Channel<int> &channel, std::vector<int> &sent) -> coro::Task<void> {
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_TRUE(co_await channel.send(i));
+      sent.emplace_back(i);
+    }
+  };
+
+  auto task = sender(channel, sent);
+  task.resume();
+  EXPECT_EQ(sent, (std::vector<int> {0, 1}));
+  EXPECT_FALSE(task.is_ready());
+
+  // Receiving makes room and resumes the sender inline, which fills the channel again.
+  EXPECT_EQ(channel.try_recv(), 0);
+  EXPECT_EQ(sent, (std::vector<int> {0, 1, 2}));
+  EXPECT_EQ(channel.try_recv(), 1);
+  EXPECT_TRUE(task.is_ready());
+  EXPECT_EQ(channel.try_recv(), 2);
+  EXPECT_EQ(channel.try_recv(), 3);
+}
+
+TEST(ChannelTest, RecvSuspendsWhileEmptyAndCloseWakesIt) {
+  coro::Channel<int> channel {4};
+  std::vector<std::optional<int>> received {};
+  auto receiver = [](coro::Channel<int> &channel, std::vector<std::optional<int>> &received) -> coro::Task<void> {
+    while (true) {
+      auto value = co_await channel.recv();
+      received.emplace_back(value);
+      if (!value) { break; }
+    }
+  };
+
+  auto task = receiver(channel, received);
+  task.resume();
+  EXPECT_TRUE(received.empty());
+
+  EXPECT_TRUE(channel.try_send(7));
+  EXPECT_EQ(received, (std::vector<std::optional<int>> {7}));
+
+  channel.close();
+  EXPECT_TRUE(task.is_ready());
+  EXPECT_EQ(received, (std::vector<std::optional<int>> {7, std::nullopt}));
+  EXPECT_FALSE(channel.try_send(8));
+}
+
+TEST(ChannelTest, CloseDrainsBufferedValuesAndFailsSenders) {
+  coro::Channel<int> channel {2};
+  auto sender = [](coro::Channel<int> &channel) -> coro::Task<bool> { co_return co_await channel.send(3); };
+
+  EXPECT_TRUE(channel.try_send(1));
+  EXPECT_TRUE(channel.try_send(2));
+  auto blocked = sender(channel);
+  blocked.resume();
+  EXPECT_FALSE(blocked.is_ready());
+
+  channel.close();
+  ASSERT_TRUE(blocked.is_ready());
+  EXPECT_FALSE(blocked.promise().result());
+
+  auto receive = [](coro::Channel<int> &channel) -> coro::Task<std::optional<int>> {
+    co_return co_await channel.recv();
+  };
+  EXPECT_EQ(coro::sync_wait(receive(channel)), 1);
+  EXPECT_EQ(coro::sync_wait(receive(channel)), 2);
+  EXPECT_EQ(coro::sync_wait(receive(channel)), std::nullopt);
+}
+
+TEST(ChannelTest, PipelineOnThreadPool) {
+  constexpr std::size_t producerCount = 4;
+  constexpr std::size_t consumerCount = 4;
+  constexpr std::size_t valueCount    = 5000;
+  auto tp                             = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 4});
+  coro::Channel<std::size_t> channel {*tp, 16};
+
+  std::atomic<std::size_t> producersLeft {producerCount};
+  std::atomic<std::size_t> sum {0};
+  std::atomic<std::size_t> count {0};
+  auto producer = [](coro::ThreadPool &tp, coro::Channel<std::size_t> &channel,
+                     std::atomic<std::size_t> &producersLeft) -> coro::Task<void> {
+    co_await tp.schedule();
+    for (std::size_t i = 1; i <= valueCount; ++i) { EXPECT_TRUE(co_await channel.send(i)); }
+    if (producersLeft.fetch_sub(1) == 1) { channel.close(); }
+  };
+  auto consumer = [](coro::ThreadPool &tp, coro::Channel<std::size_t> &channel, std::atomic<std::size_t> &sum,
+                     std::atomic<std::size_t> &count) -> coro::Task<void> {
+    co_await tp.schedule();
+    std::array<std::size_t, 8> batch {};
+    while (true) {
+      // Mix batched polling with suspending receives.
+      if (auto received = channel.try_recv_n(batch); received > 0) {
+        for (std::size_t i = 0; i < received; ++i) { sum += batch[i]; }
+        count += received;
+        continue;
+      }
+      auto value = co_await channel.recv();
+      if (!value) { break; }
+      sum += *value;
+      ++count;
+    }
+  };
+
+  std::vector<coro::Task<void>> tasks {};
+  for (std::size_t i = 0; i < producerCount; ++i) { tasks.emplace_back(producer(*tp, channel, producersLeft)); }
+  for (std::size_t i = 0; i < consumerCount; ++i) { tasks.emplace_back(consumer(*tp, channel, sum, count)); }
+  coro::sync_wait(coro::when_all(std::move(tasks)));
+  EXPECT_EQ(count.load(), producerCount * valueCount);
+  EXPECT_EQ(sum.load(), producerCount * valueCount * (valueCount + 1) / 2);
+  tp->shutdown();
+}
@@ -0,0 +1,196 @@
+#include <coro/event.hpp>
+#include <coro/latch.hpp>
+#include <coro/sync_wait.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/when_all.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(EventTest, WaitingOnSetEventDoesNotSuspend) {
+  coro::Event event {coro::Event::ResetMode::Manual, true};
+  auto task = [](coro::Event &event) -> coro::Task<void> { co_await event; };
+
+  auto waiter = task(event);
+  waiter.resume();
+  EXPECT_TRUE(waiter.is_ready());
+  EXPECT_TRUE(event.is_set());
+
+  event.reset();
+  EXPECT_FALSE(event.is_set());
+}
+
+TEST(EventTest, ManualResetReleasesAllWaitersInOrder) {
+  coro::Event event {};
+  std::vector<int> order {};
+  auto task = [](coro::Event &event, std::vector<int> &order, int id) -> coro::Task<void> {
+    co_await event;
+    order.emplace_back(id);
+  };
+
+  std::vector<coro::Task<void>> waiters {};
+  for (int i = 0; i < 4; ++i) {
+    waiters.emplace_back(task(event, order, i));
+    waiters.back().resume();
+  }
+  EXPECT_TRUE(order.empty());
+
+  event.set();
+  EXPECT_EQ(order, (std::vector<int> {0, 1, 2, 3}));
+  EXPECT_TRUE(event.is_set());
+  event.set();
+  EXPECT_EQ(order.size(), 4);
+}
+
+TEST(EventTest, AutoResetReleasesOneWaiterPerSet) {
+  coro::Event event {coro::Event::ResetMode::Auto};
+  std::vector<int> order {};
+  auto task = [](coro::Event &event, std::vector<int> &order, int id) -> coro::Task<void> {
+    co_await event;
+    order.emplace_back(id);
+  };
+
+  std::vector<coro::Task<void>> waiters {};
+  for (int i = 0; i < 3; ++i) {
+    waiters.emplace_back(task(event, order, i));
+    waiters.back().resume();
+  }
+
+  event.set();
+  EXPECT_EQ(order, (std::vector<int> {0}));
+  EXPECT_FALSE(event.is_set());
+  event.set();
+  event.set();
+  EXPECT_EQ(order, (std::vector<int> {0, 1, 2}));
+  EXPECT_FALSE(event.is_set());
+
+  // A set() without waiters is consumed by the next one.
+  event.set();
+  EXPECT_TRUE(event.is_set());
+  auto late = task(event, order, 3);
+  late.resume();
+  EXPECT_TRUE(late.is_ready());
+  EXPECT_FALSE(event.is_set());
+}
+
+TEST(EventTest, LongChainOfAutoResetSetsDoesNotNest) {
+  constexpr std::size_t waiterCount = 200'000;
+  coro::Event event {coro::Event::ResetMode::Auto};
+  std::size_t counter {0};
+  auto task = [](coro::Event &event, std::size_t &counter) -> coro::Task<void> {
+    co_await event;
+    ++counter;
+    event.set();
+  };
+
+  std::vector<coro::Task<void>> waiters {};
+  waiters.reserve(waiterCount);
+  for (std::size_t i = 0; i < waiterCount; ++i) {
+    waiters.emplace_back(task(event, counter));
+    waiters.back().resume();
+  }
+
+  // Every waiter passes the event to the next one, each set() only takes the next waiter.
+  event.set();
+  EXPECT_EQ(counter, waiterCount);
+  EXPECT_TRUE(waiters.back().is_ready());
+  EXPECT_TRUE(event.is_set());
+}
+
+TEST(EventTest, ManualResetOnThreadPool) {
+  constexpr std::size_t taskCount = 256;
+  auto tp                         = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 4});
+  coro::Event event {*tp};
+
+  std::atomic<std::size_t> started {0};
+  auto waiter = [](coro::ThreadPool &tp, coro::Event &event, std::atomic<std::size_t> &started) -> coro::Task<void> {
+    co_await tp.schedule();
+    started.fetch_add(1, std::memory_order::relaxed);
+    co_await event;
+  };
+  auto setter = [](coro::ThreadPool &tp, coro::Event &event, std::atomic<std::size_t> &started) -> coro::Task<void> {
+    co_await tp.schedule();
+    while (started.load(std::memory_order::relaxed) < taskCount / 2) { co_await tp.yield(); }
+    event.set();
+  };
+
+  std::vector<coro::Task<void>> tasks {};
+  for (std::size_t i = 0; i < taskCount; ++i) { tasks.emplace_back(waiter(*tp, event, started)); }
+  tasks.emplace_back(setter(*tp, event, started));
+  coro::sync_wait(coro::when_all(std::move(tasks)));
+  EXPECT_EQ(started.load(), taskCount);
+  tp->shutdown();
+}
+
+TEST(EventTest, AutoResetPassesTheEventOnThreadPool) {
+  constexpr std::size_t taskCount = 256;
+  auto tp                         = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 4});
+  coro::Event event {*tp, coro::Event::ResetMode::Auto, true};
+
+  // Each task holds the event like a lock and sets it again for the next one.
+  std::size_t counter {0};
+  auto task = [](coro::ThreadPool &tp, coro::Event &event, std::size_t &counter) -> coro::Task<void> {
+    co_await tp.schedule();
+    co_await event;
+    ++counter;
+    event.set();
+  };
+
+  std::vector<coro::Task<void>> tasks {};
+  for (std::size_t i = 0; i < taskCount; ++i) { tasks.emplace_back(task(*tp, event, counter)); }
+  coro::sync_wait(coro::when_all(std::move(tasks)));
+  EXPECT_EQ(counter, taskCount);
+  EXPECT_TRUE(event.is_set());
+  tp->shutdown();
+}
+
+TEST(LatchTest, OpensOnceCountedDown) {
+  coro::Latch latch {3};
+  bool done {false};
+  auto task = [](coro::Latch &latch, bool &done) -> coro::Task<void> {
+    co_await latch;
+    done = true;
+  };
+
+  auto waiter = task(latch, done);
+  waiter.resume();
+  latch.count_down();
+  EXPECT_EQ(latch.remaining(), 2);
+  latch.count_down(2);
+  EXPECT_TRUE(done);
+  EXPECT_TRUE(latch.try_wait());
+  EXPECT_EQ(latch.remaining(), 0);
+
+  coro::Latch open {0};
+  EXPECT_TRUE(open.try_wait());
+}
+
+TEST(LatchTest, CountedDownOnThreadPool) {
+  constexpr std::size_t taskCount = 128;
+  auto tp                         = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 4});
+  coro::Latch latch {*tp, static_cast<std::ptrdiff_t>(taskCount)};
+
+  std::atomic<std::size_t> counted {0};
+  auto worker = [](coro::ThreadPool &tp, coro::Latch &latch, std::atomic<std::size_t> &counted) -> coro::Task<void> {
+    co_await tp.schedule();
+    counted.fetch_add(1, std::memory_order::relaxed);
+    latch.count_down();
+  };
+  auto waiter = [](coro::ThreadPool &tp, coro::Latch &latch, std::atomic<std::size_t> &counted) -> coro::Task<void> {
+    co_await tp.schedule();
+    co_await latch;
+    EXPECT_EQ(counted.load(std::memory_order::relaxed), std::size_t {taskCount});
+  };
+
+  std::vector<coro::Task<void>> tasks {};
+  for (std::size_t i = 0; i < taskCount; ++i) {
+    tasks.emplace_back(worker(*tp, latch, counted));
+    tasks.emplace_back(waiter(*tp, latch, counted));
+  }
+  coro::sync_wait(coro::when_all(std::move(tasks)));
+  tp->shutdown();
+}
@@ -0,0 +1,88 @@
+#include <coro/detail/frame_allocator.hpp>
+#include <coro/task.hpp>
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using coro::detail::RecyclingFrameAllocator;
+
+TEST(FrameAllocatorTest, SameThreadFreeIsRecycled) {
+  auto before = RecyclingFrameAllocator::stats();
+
+  auto *first = RecyclingFrameAllocator::allocate(200);
+  RecyclingFrameAllocator::deallocate(first, 200);
+  EXPECT_GE(RecyclingFrameAllocator::stats().bytesRetained_, 200);
+
+  // Same size class, served from the free list.
+  auto *second = RecyclingFrameAllocator::allocate(250);
+  EXPECT_EQ(first, second);
+  RecyclingFrameAllocator::deallocate(second, 250);
+
+  auto after = RecyclingFrameAllocator::stats();
+  EXPECT_EQ(after.allocations_ - before.allocations_, 2);
+  EXPECT_GE(after.recycled_ - before.recycled_, 1);
+  EXPECT_GT(after.hitRate(), 0.0);
+}
+
+TEST(FrameAllocatorTest, FramesAreAligned) {
+  for (std::size_t size : {1, 24, 64, 100, 4096}) {
+    auto *ptr = RecyclingFrameAllocator::allocate(size);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % __STDCPP_DEFAULT_NEW_ALIGNMENT__, 0);
+    RecyclingFrameAllocator::deallocate(ptr, size);
+  }
+}
+
+TEST(FrameAllocatorTest, RemoteFreeReturnsToOwner) {
+  void *allocated {nullptr};
+  void *reallocated {nullptr};
+  std::atomic<int> step {0};
+
+  std::thread owner {[&]() {
+    allocated = RecyclingFrameAllocator::allocate(128);
+    step      = 1;
+    step.notify_all();
+    step.wait(1);
+    reallocated = RecyclingFrameAllocator::allocate(128);
+    RecyclingFrameAllocator::deallocate(reallocated, 128);
+  }};
+
+  step.wait(0);
+  auto before = RecyclingFrameAllocator::stats();
+  RecyclingFrameAllocator::deallocate(allocated, 128);
+  EXPECT_EQ(RecyclingFrameAllocator::stats().remoteFrees_ - before.remoteFrees_, 1);
+  step = 2;
+  step.notify_all();
+  owner.join();
+
+  EXPECT_EQ(allocated, reallocated);
+}
+
+TEST(FrameAllocatorTest, FreeAfterOwnerThreadExited) {
+  void *allocated {nullptr};
+  std::thread owner {[&]() { allocated = RecyclingFrameAllocator::allocate(64); }};
+  owner.join();
+
+  // The owner's cache is kept alive by the outstanding frame and released with it.
+  RecyclingFrameAllocator::deallocate(allocated, 64);
+}
+
+#if defined(CORO_RECYCLE_FRAMES)
+TEST(FrameAllocatorTest, TaskFramesAreRecycled) {
+  auto make = []() -> coro::Task<int> { co_return 42; };
+  {
+    auto warmup = make();
+  }
+
+  auto before = RecyclingFrameAllocator::stats();
+  for (int i = 0; i < 10; ++i) {
+    auto task = make();
+    task.resume();
+    EXPECT_EQ(task.promise().result(), 42);
+  }
+  auto after = RecyclingFrameAllocator::stats();
+
+  EXPECT_EQ(after.allocations_ - before.allocations_, 10);
+  EXPECT_EQ(after.recycled_ - before.recycled_, 10);
+}
+#endif
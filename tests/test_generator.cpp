@@ -0,0 +1,182 @@
+#include <coro/async_generator.hpp>
+#include <coro/generator.hpp>
+#include <coro/sync_wait.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <latch>
+#include <memory_resource>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+static_assert(std::ranges::input_range<coro::Generator<int>>);
+static_assert(coro::concepts::range_of<coro::Generator<std::coroutine_handle<>>, std::coroutine_handle<>>);
+
+namespace {
+auto iota(std::size_t count) -> coro::Generator<const std::size_t> {
+  for (std::size_t i = 0; i < count; ++i) { co_yield i; }
+}
+
+/// Counts the objects alive, to check that nothing is copied.
+struct Tracked {
+  static inline int live_ {0};
+  static inline int copies_ {0};
+
+  explicit Tracked(int value) : value_(value) { ++live_; }
+  Tracked(const Tracked &other) : value_(other.value_) {
+    ++live_;
+    ++copies_;
+  }
+  ~Tracked() { --live_; }
+
+  int value_;
+};
+}  // namespace
+
+TEST(GeneratorTest, YieldsLazilyInOrder) {
+  std::vector<int> trace {};
+  auto generator = [](std::vector<int> &trace) -> coro::Generator<int> {
+    for (int i = 0; i < 3; ++i) {
+      trace.emplace_back(-i);
+      co_yield i;
+    }
+  }(trace);
+  EXPECT_TRUE(trace.empty());
+
+  for (auto &value : generator) { trace.emplace_back(value); }
+  EXPECT_EQ(trace, (std::vector<int> {0, 0, -1, 1, -2, 2}));
+}
+
+TEST(GeneratorTest, YieldsReferencesWithoutCopies) {
+  Tracked::copies_ = 0;
+  auto generator   = []() -> coro::Generator<Tracked> {
+    Tracked kept {1};
+    co_yield kept;
+    EXPECT_EQ(kept.value_, 10);
+    co_yield Tracked {2};
+  }();
+
+  auto it = generator.begin();
+  it->value_ *= 10;
+  ++it;
+  EXPECT_EQ(it->value_, 2);
+  EXPECT_EQ(Tracked::live_, 2);
+  ++it;
+  EXPECT_TRUE(it == generator.end());
+  EXPECT_EQ(Tracked::copies_, 0);
+  EXPECT_EQ(Tracked::live_, 0);
+}
+
+TEST(GeneratorTest, WorksWithRangeAdaptorsAndIsUnbounded) {
+  auto naturals = []() -> coro::Generator<std::size_t> {
+    for (std::size_t i = 0;; ++i) { co_yield i; }
+  }();
+
+  std::vector<std::size_t> evens {};
+  for (auto value : naturals | std::views::filter([](std::size_t v) { return v % 2 == 0; }) | std::views::take(4)) {
+    evens.emplace_back(value);
+  }
+  EXPECT_EQ(evens, (std::vector<std::size_t> {0, 2, 4, 6}));
+
+  // A long stream keeps a single frame alive.
+  std::size_t sum {0};
+  for (auto value : iota(1'000'000)) { sum += value; }
+  EXPECT_EQ(sum, std::size_t {999'999} * 1'000'000 / 2);
+}
+
+TEST(GeneratorTest, RethrowsFromTheIncrement) {
+  auto generator = []() -> coro::Generator<int> {
+    co_yield 1;
+    throw std::runtime_error {"generator failed"};
+  }();
+
+  auto it = generator.begin();
+  EXPECT_EQ(*it, 1);
+  EXPECT_THROW(++it, std::runtime_error);
+  EXPECT_TRUE(it == generator.end());
+}
+
+TEST(GeneratorTest, FrameFromMemoryResource) {
+  std::pmr::monotonic_buffer_resource arena {};
+  auto generator = [](std::allocator_arg_t, std::pmr::memory_resource *, int count) -> coro::Generator<int> {
+    for (int i = 0; i < count; ++i) { co_yield i; }
+  }(std::allocator_arg, &arena, 3);
+
+  int sum {0};
+  for (auto value : generator) { sum += value; }
+  EXPECT_EQ(sum, 3);
+}
+
+TEST(GeneratorTest, FeedsThreadPoolResume) {
+  constexpr std::size_t taskCount = 64;
+  auto tp                         = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 2});
+
+  std::latch done {taskCount};
+  auto task = [](std::latch &done) -> coro::Task<void> {
+    done.count_down();
+    co_return;
+  };
+  std::vector<coro::Task<void>> tasks {};
+  for (std::size_t i = 0; i < taskCount; ++i) { tasks.emplace_back(task(done)); }
+
+  auto handles = [](std::vector<coro::Task<void>> &tasks) -> coro::Generator<std::coroutine_handle<>> {
+    for (auto &task : tasks) { co_yield task.handle(); }
+  }(tasks);
+  EXPECT_EQ(tp->resume(handles), taskCount);
+  done.wait();
+  tp->shutdown();
+}
+
+TEST(AsyncGeneratorTest, AwaitsBetweenYields) {
+  auto tp     = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 2});
+  auto square = [](std::size_t value) -> coro::Task<std::size_t> { co_return value * value; };
+  auto stream = [](coro::ThreadPool &tp, auto square, std::size_t count) -> coro::AsyncGenerator<std::size_t> {
+    for (std::size_t i = 0; i < count; ++i) {
+      co_await tp.schedule();
+      auto value = co_await square(i);
+      co_yield value;
+    }
+  };
+  auto consume = [](coro::AsyncGenerator<std::size_t> generator) -> coro::Task<std::vector<std::size_t>> {
+    std::vector<std::size_t> values {};
+    for (auto it = co_await generator.begin(); it != generator.end(); co_await ++it) { values.emplace_back(*it); }
+    co_return values;
+  };
+
+  auto values = coro::sync_wait(consume(stream(*tp, square, 5)));
+  EXPECT_EQ(values, (std::vector<std::size_t> {0, 1, 4, 9, 16}));
+  tp->shutdown();
+}
+
+TEST(AsyncGeneratorTest, YieldsReferencesAndRethrows) {
+  auto consume = [](coro::AsyncGenerator<std::string> generator) -> coro::Task<std::string> {
+    std::string joined {};
+    try {
+      for (auto it = co_await generator.begin(); it != generator.end(); co_await ++it) {
+        joined += *it;
+        it->clear();
+      }
+    } catch (const std::runtime_error &e) { joined += e.what(); }
+    co_return joined;
+  };
+  auto stream = []() -> coro::AsyncGenerator<std::string> {
+    std::string value {"a"};
+    co_yield value;
+    // The consumer cleared the value through the reference.
+    EXPECT_TRUE(value.empty());
+    co_yield std::string {"b"};
+    throw std::runtime_error {"!"};
+  };
+
+  EXPECT_EQ(coro::sync_wait(consume(stream())), "ab!");
+
+  auto empty = []() -> coro::AsyncGenerator<std::string> { co_return; };
+  EXPECT_EQ(coro::sync_wait(consume(empty())), "");
+}
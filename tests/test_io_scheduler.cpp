@@ -0,0 +1,685 @@
+#include <coro/io_scheduler.hpp>
+#include <coro/sync_wait.hpp>
+#include <coro/task.hpp>
+#include <coro/when_all.hpp>
+#include <coro/detail/timer_wheel.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <optional>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+/// Owns a pair of connected, non-blocking fds: a pipe, a socketpair or a loopback connection.
+struct FdPair {
+  static auto pipe() -> FdPair {
+    FdPair pair {};
+    EXPECT_EQ(::pipe2(pair.fds_.data(), O_NONBLOCK | O_CLOEXEC), 0);
+    return pair;
+  }
+
+  static auto socketPair() -> FdPair {
+    FdPair pair {};
+    EXPECT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, pair.fds_.data()), 0);
+    return pair;
+  }
+
+  FdPair() = default;
+  FdPair(FdPair &&other) noexcept : fds_(std::exchange(other.fds_, {-1, -1})) {}
+  FdPair(const FdPair &)                     = delete;
+  auto operator=(const FdPair &) -> FdPair & = delete;
+  auto operator=(FdPair &&) -> FdPair &      = delete;
+  ~FdPair() {
+    for (auto fd : fds_) {
+      if (fd >= 0) { ::close(fd); }
+    }
+  }
+
+  auto read() const -> int { return fds_[0]; }
+  auto write() const -> int { return fds_[1]; }
+
+  auto close_write() -> void {
+    ::close(fds_[1]);
+    fds_[1] = -1;
+  }
+
+  std::array<int, 2> fds_ {-1, -1};
+};
+}  // namespace
+
+class IoSchedulerTest : public ::testing::TestWithParam<coro::IoScheduler::ExecutionStrategy> {
+protected:
+  auto makeScheduler() -> std::shared_ptr<coro::IoScheduler> {
+    return coro::IoScheduler::makeShared(coro::IoScheduler::Options {
+        .executionStrategy_ = GetParam(),
+        .threadPool_        = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 2})});
+  }
+};
+
+TEST_P(IoSchedulerTest, ScheduleMovesOffTheCallingThread) {
+  auto scheduler = makeScheduler();
+
+  auto task = [](coro::IoScheduler &scheduler) -> coro::Task<std::thread::id> {
+    co_await scheduler.schedule();
+    co_return std::this_thread::get_id();
+  };
+  EXPECT_NE(coro::sync_wait(task(*scheduler)), std::this_thread::get_id());
+  scheduler->shutdown();
+  EXPECT_TRUE(scheduler->empty());
+}
+
+TEST_P(IoSchedulerTest, PollReadOnPipe) {
+  auto scheduler = makeScheduler();
+  auto pipe      = FdPair::pipe();
+
+  auto reader = [](coro::IoScheduler &scheduler, int fd) -> coro::Task<std::string> {
+    co_await scheduler.schedule();
+    auto status = co_await scheduler.poll(fd, coro::PollOp::Read);
+    EXPECT_EQ(status, coro::PollStatus::Event);
+    std::array<char, 16> buffer {};
+    auto bytes = ::read(fd, buffer.data(), buffer.size());
+    co_return std::string(buffer.data(), bytes > 0 ? bytes : 0);
+  };
+  auto writer = [](coro::IoScheduler &scheduler, int fd) -> coro::Task<void> {
+    co_await scheduler.sleep_for(10ms);
+    EXPECT_EQ(::write(fd, "hello", 5), 5);
+  };
+
+  auto [received, written] =
+      coro::sync_wait(coro::when_all(reader(*scheduler, pipe.read()), writer(*scheduler, pipe.write())));
+  EXPECT_EQ(received, "hello");
+  scheduler->shutdown();
+  EXPECT_TRUE(scheduler->empty());
+}
+
+TEST_P(IoSchedulerTest, PollTimesOut) {
+  auto scheduler = makeScheduler();
+  auto pipe      = FdPair::pipe();
+
+  auto task = [](coro::IoScheduler &scheduler, int fd) -> coro::Task<coro::PollStatus> {
+    co_return co_await scheduler.poll(fd, coro::PollOp::Read, 20ms);
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(coro::sync_wait(task(*scheduler, pipe.read())), coro::PollStatus::Timeout);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+
+  // The fd was disarmed, it can be polled again.
+  EXPECT_EQ(::write(pipe.write(), "x", 1), 1);
+  EXPECT_EQ(coro::sync_wait(task(*scheduler, pipe.read())), coro::PollStatus::Event);
+  scheduler->shutdown();
+}
+
+TEST_P(IoSchedulerTest, EarlierTimeoutInterruptsTheWait) {
+  auto scheduler = makeScheduler();
+  auto slow      = FdPair::pipe();
+  auto fast      = FdPair::pipe();
+
+  auto task = [](coro::IoScheduler &scheduler, int fd,
+                  std::chrono::milliseconds timeout) -> coro::Task<coro::PollStatus> {
+    co_return co_await scheduler.poll(fd, coro::PollOp::Read, timeout);
+  };
+  // Times out long before the first poll and unblocks it by closing its pipe.
+  auto closer = [&task](coro::IoScheduler &scheduler, FdPair &fast, FdPair &slow) -> coro::Task<coro::PollStatus> {
+    auto status = co_await task(scheduler, fast.read(), 10ms);
+    slow.close_write();
+    co_return status;
+  };
+
+  auto start           = std::chrono::steady_clock::now();
+  auto [first, second] = coro::sync_wait(
+      coro::when_all(task(*scheduler, slow.read(), 10s), closer(*scheduler, fast, slow)));
+  EXPECT_EQ(first, coro::PollStatus::Closed);
+  EXPECT_EQ(second, coro::PollStatus::Timeout);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+  scheduler->shutdown();
+}
+
+TEST_P(IoSchedulerTest, PollWriteOnSocketPair) {
+  auto scheduler = makeScheduler();
+  auto sockets   = FdPair::socketPair();
+
+  auto task = [](coro::IoScheduler &scheduler, int fd) -> coro::Task<coro::PollStatus> {
+    co_return co_await scheduler.poll(fd, coro::PollOp::Write, 1s);
+  };
+  EXPECT_EQ(coro::sync_wait(task(*scheduler, sockets.write())), coro::PollStatus::Event);
+  scheduler->shutdown();
+}
+
+TEST_P(IoSchedulerTest, ClosedPeerAndInvalidFd) {
+  auto scheduler = makeScheduler();
+  auto pipe      = FdPair::pipe();
+  pipe.close_write();
+
+  auto task = [](coro::IoScheduler &scheduler, int fd) -> coro::Task<coro::PollStatus> {
+    co_return co_await scheduler.poll(fd, coro::PollOp::Read, 1s);
+  };
+  EXPECT_EQ(coro::sync_wait(task(*scheduler, pipe.read())), coro::PollStatus::Closed);
+  EXPECT_EQ(coro::sync_wait(task(*scheduler, -1)), coro::PollStatus::Error);
+  scheduler->shutdown();
+  EXPECT_TRUE(scheduler->empty());
+}
+
+TEST_P(IoSchedulerTest, LoopbackEcho) {
+  auto scheduler = makeScheduler();
+
+  auto listener = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  ASSERT_GE(listener, 0);
+  sockaddr_in address {};
+  address.sin_family      = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length        = sizeof(address);
+  ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)), 0);
+  ASSERT_EQ(::listen(listener, 4), 0);
+  ASSERT_EQ(::getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length), 0);
+
+  auto server = [](coro::IoScheduler &scheduler, int listener) -> coro::Task<void> {
+    EXPECT_EQ(co_await scheduler.poll(listener, coro::PollOp::Read, 5s), coro::PollStatus::Event);
+    auto connection = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    EXPECT_GE(connection, 0);
+
+    EXPECT_EQ(co_await scheduler.poll(connection, coro::PollOp::Read, 5s), coro::PollStatus::Event);
+    std::array<char, 16> buffer {};
+    auto bytes = ::read(connection, buffer.data(), buffer.size());
+    EXPECT_EQ(co_await scheduler.poll(connection, coro::PollOp::Write, 5s), coro::PollStatus::Event);
+    EXPECT_EQ(::write(connection, buffer.data(), bytes), bytes);
+    ::close(connection);
+  };
+  auto client = [](coro::IoScheduler &scheduler, sockaddr_in address) -> coro::Task<std::string> {
+    auto fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+    EXPECT_EQ(co_await scheduler.poll(fd, coro::PollOp::Write, 5s), coro::PollStatus::Event);
+    EXPECT_EQ(::write(fd, "ping", 4), 4);
+
+    EXPECT_EQ(co_await scheduler.poll(fd, coro::PollOp::Read, 5s), coro::PollStatus::Event);
+    std::array<char, 16> buffer {};
+    auto bytes = ::read(fd, buffer.data(), buffer.size());
+    ::close(fd);
+    co_return std::string(buffer.data(), bytes > 0 ? bytes : 0);
+  };
+
+  auto [served, echoed] = coro::sync_wait(coro::when_all(server(*scheduler, listener), client(*scheduler, address)));
+  EXPECT_EQ(echoed, "ping");
+  ::close(listener);
+  scheduler->shutdown();
+}
+
+TEST_P(IoSchedulerTest, ManyConcurrentPolls) {
+  constexpr std::size_t pollCount = 64;
+  auto scheduler                  = makeScheduler();
+
+  std::vector<FdPair> pipes {};
+  for (std::size_t i = 0; i < pollCount; ++i) { pipes.emplace_back(FdPair::pipe()); }
+
+  std::atomic<std::size_t> events {0};
+  auto task = [](coro::IoScheduler &scheduler, int fd, std::atomic<std::size_t> &events) -> coro::Task<void> {
+    if (co_await scheduler.poll(fd, coro::PollOp::Read, 5s) == coro::PollStatus::Event) { events++; }
+  };
+  auto writer = [](std::vector<FdPair> &pipes) -> coro::Task<void> {
+    for (auto &pipe : pipes) { EXPECT_EQ(::write(pipe.write(), "x", 1), 1); }
+    co_return;
+  };
+
+  std::vector<coro::Task<void>> tasks {};
+  for (auto &pipe : pipes) { tasks.emplace_back(task(*scheduler, pipe.read(), events)); }
+  tasks.emplace_back(writer(pipes));
+  coro::sync_wait(coro::when_all(std::move(tasks)));
+  EXPECT_EQ(events.load(), pollCount);
+  scheduler->shutdown();
+  EXPECT_TRUE(scheduler->empty());
+}
+
+TEST_P(IoSchedulerTest, ShutdownClosesPendingPolls) {
+  auto scheduler = makeScheduler();
+  auto pipe      = FdPair::pipe();
+
+  auto task = [](coro::IoScheduler &scheduler, int fd) -> coro::Task<coro::PollStatus> {
+    co_return co_await scheduler.poll(fd, coro::PollOp::Read);
+  };
+  auto stopper = [](coro::IoScheduler &scheduler) -> coro::Task<void> {
+    while (scheduler.empty()) { std::this_thread::yield(); }
+    scheduler.shutdown();
+    co_return;
+  };
+
+  auto [status, stopped] = coro::sync_wait(coro::when_all(task(*scheduler, pipe.read()), stopper(*scheduler)));
+  EXPECT_EQ(status, coro::PollStatus::Closed);
+  EXPECT_EQ(coro::sync_wait(task(*scheduler, pipe.read())), coro::PollStatus::Closed);
+  EXPECT_THROW(static_cast<void>(scheduler->schedule()), std::runtime_error);
+  EXPECT_TRUE(scheduler->empty());
+}
+
+TEST_P(IoSchedulerTest, SleepForResumesAfterTheDuration) {
+  auto scheduler = makeScheduler();
+
+  auto task = [](coro::IoScheduler &scheduler) -> coro::Task<std::chrono::steady_clock::duration> {
+    auto start = std::chrono::steady_clock::now();
+    co_await scheduler.sleep_for(20ms);
+    co_return std::chrono::steady_clock::now() - start;
+  };
+  EXPECT_GE(coro::sync_wait(task(*scheduler)), 20ms);
+  scheduler->shutdown();
+  EXPECT_TRUE(scheduler->empty());
+}
+
+TEST_P(IoSchedulerTest, ManySleepsResumeByDeadline) {
+  constexpr std::size_t sleepCount = 256;
+  auto scheduler                   = makeScheduler();
+
+  std::atomic<std::size_t> late {0};
+  auto task = [](coro::IoScheduler &scheduler, std::chrono::milliseconds duration,
+                  std::atomic<std::size_t> &late) -> coro::Task<void> {
+    auto deadline = std::chrono::steady_clock::now() + duration;
+    co_await scheduler.sleep_until(deadline);
+    if (std::chrono::steady_clock::now() < deadline) { late++; }
+  };
+
+  std::vector<coro::Task<void>> tasks {};
+  for (std::size_t i = 0; i < sleepCount; ++i) {
+    tasks.emplace_back(task(*scheduler, std::chrono::milliseconds {static_cast<int64_t>(i % 50)}, late));
+  }
+  coro::sync_wait(coro::when_all(std::move(tasks)));
+  EXPECT_EQ(late.load(), 0);
+  scheduler->shutdown();
+  EXPECT_TRUE(scheduler->empty());
+}
+
+TEST_P(IoSchedulerTest, StopTokenCutsSleepShort) {
+  auto scheduler = makeScheduler();
+  std::stop_source stopSource {};
+
+  auto sleeper = [](coro::IoScheduler &scheduler) -> coro::Task<bool> {
+    co_await scheduler.sleep_for(1h);
+    co_return co_await coro::this_task::stop_requested();
+  };
+  auto stopper = [](coro::IoScheduler &scheduler, std::stop_source stopSource) -> coro::Task<void> {
+    while (scheduler.empty()) { std::this_thread::yield(); }
+    stopSource.request_stop();
+    co_return;
+  };
+
+  auto sleeping = sleeper(*scheduler);
+  sleeping.promise().stop_token(stopSource.get_token());
+  auto [stopped, requested] = coro::sync_wait(coro::when_all(std::move(sleeping), stopper(*scheduler, stopSource)));
+  EXPECT_TRUE(stopped);
+  scheduler->shutdown();
+  EXPECT_TRUE(scheduler->empty());
+}
+
+TEST_P(IoSchedulerTest, WithTimeoutReturnsTheValueInTime) {
+  auto scheduler = makeScheduler();
+
+  auto quick = [](coro::IoScheduler &scheduler) -> coro::Task<int> {
+    co_await scheduler.sleep_for(1ms);
+    co_return 42;
+  };
+  auto task = [](coro::IoScheduler &scheduler, coro::Task<int> quick) -> coro::Task<std::optional<int>> {
+    co_return co_await scheduler.with_timeout(std::move(quick), 1h);
+  };
+  EXPECT_EQ(coro::sync_wait(task(*scheduler, quick(*scheduler))), 42);
+
+  auto inline_ = []() -> coro::Task<void> { co_return; };
+  auto voidTask = [](coro::IoScheduler &scheduler, coro::Task<void> inline_) -> coro::Task<bool> {
+    co_return co_await scheduler.with_timeout(std::move(inline_), 1h);
+  };
+  EXPECT_TRUE(coro::sync_wait(voidTask(*scheduler, inline_())));
+
+  // Neither the timer nor the task is left behind.
+  while (!scheduler->empty()) { std::this_thread::yield(); }
+  scheduler->shutdown();
+}
+
+TEST_P(IoSchedulerTest, WithTimeoutGivesUpOnSlowTasks) {
+  auto scheduler = makeScheduler();
+
+  auto slow = [](coro::IoScheduler &scheduler) -> coro::Task<int> {
+    // Cut short once with_timeout() gave up.
+    co_await scheduler.sleep_for(1h);
+    EXPECT_TRUE(co_await coro::this_task::stop_requested());
+    co_return 42;
+  };
+  auto task = [](coro::IoScheduler &scheduler, coro::Task<int> slow)
+      -> coro::Task<std::pair<std::optional<int>, std::chrono::steady_clock::duration>> {
+    auto start  = std::chrono::steady_clock::now();
+    auto result = co_await scheduler.with_timeout(std::move(slow), 20ms);
+    co_return std::pair {result, std::chrono::steady_clock::now() - start};
+  };
+  auto [result, elapsed] = coro::sync_wait(task(*scheduler, slow(*scheduler)));
+  EXPECT_FALSE(result.has_value());
+  EXPECT_GE(elapsed, 20ms);
+  EXPECT_LT(elapsed, 10s);
+
+  auto failing = []() -> coro::Task<int> {
+    throw std::runtime_error {"failed"};
+    co_return 0;
+  };
+  EXPECT_THROW(coro::sync_wait(task(*scheduler, failing())), std::runtime_error);
+
+  while (!scheduler->empty()) { std::this_thread::yield(); }
+  scheduler->shutdown();
+}
+
+TEST_P(IoSchedulerTest, ShutdownCutsSleepsShort) {
+  auto scheduler = makeScheduler();
+
+  auto sleeper = [](coro::IoScheduler &scheduler) -> coro::Task<void> { co_await scheduler.sleep_for(1h); };
+  auto stopper = [](coro::IoScheduler &scheduler) -> coro::Task<void> {
+    while (scheduler.empty()) { std::this_thread::yield(); }
+    scheduler.shutdown();
+    co_return;
+  };
+  coro::sync_wait(coro::when_all(sleeper(*scheduler), stopper(*scheduler)));
+  EXPECT_TRUE(scheduler->empty());
+}
+
+INSTANTIATE_TEST_SUITE_P(Strategies, IoSchedulerTest,
+    ::testing::Values(coro::IoScheduler::ExecutionStrategy::Inline, coro::IoScheduler::ExecutionStrategy::ThreadPool),
+    [](const auto &info) {
+      return info.param == coro::IoScheduler::ExecutionStrategy::Inline ? std::string {"Inline"}
+                                                                         : std::string {"ThreadPool"};
+    });
+
+TEST(IoSchedulerManualTest, ProcessEventsOnTheCallingThread) {
+  auto scheduler = coro::IoScheduler::makeShared(
+      coro::IoScheduler::Options {.threadStrategy_ = coro::IoScheduler::ThreadStrategy::Manual});
+  auto pipe = FdPair::pipe();
+
+  std::thread::id resumedOn {};
+  auto status = coro::PollStatus::Error;
+  auto task   = [](coro::IoScheduler &scheduler, int fd, coro::PollStatus &status,
+                  std::thread::id &resumedOn) -> coro::Task<void> {
+    status    = co_await scheduler.poll(fd, coro::PollOp::Read);
+    resumedOn = std::this_thread::get_id();
+  };
+
+  auto poller = task(*scheduler, pipe.read(), status, resumedOn);
+  poller.resume();
+  EXPECT_EQ(scheduler->size(), 1);
+  EXPECT_EQ(scheduler->process_events(0ms), 0);
+
+  EXPECT_EQ(::write(pipe.write(), "x", 1), 1);
+  EXPECT_EQ(scheduler->process_events(1s), 1);
+  EXPECT_TRUE(poller.is_ready());
+  EXPECT_EQ(status, coro::PollStatus::Event);
+  EXPECT_EQ(resumedOn, std::this_thread::get_id());
+  EXPECT_TRUE(scheduler->empty());
+}
+
+class IoOperationTest : public ::testing::TestWithParam<coro::IoScheduler::Backend> {
+protected:
+  auto makeScheduler() -> std::shared_ptr<coro::IoScheduler> {
+    return coro::IoScheduler::makeShared(coro::IoScheduler::Options {
+        .executionStrategy_ = coro::IoScheduler::ExecutionStrategy::ThreadPool,
+        .threadPool_        = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 2}),
+        .backend_           = GetParam()});
+  }
+};
+
+TEST_P(IoOperationTest, ReadWaitsForThePipe) {
+  auto scheduler = makeScheduler();
+  EXPECT_EQ(scheduler->backend(), GetParam());
+  auto pipe = FdPair::pipe();
+
+  auto reader = [](coro::IoScheduler &scheduler, int fd) -> coro::Task<std::string> {
+    std::array<std::byte, 16> buffer {};
+    auto result = co_await scheduler.read(fd, buffer);
+    EXPECT_TRUE(result.ok()) << result.error().message();
+    co_return std::string(reinterpret_cast<const char *>(buffer.data()), result.ok() ? result.value_ : 0);
+  };
+  auto writer = [](coro::IoScheduler &scheduler, int fd) -> coro::Task<void> {
+    co_await scheduler.sleep_for(10ms);
+    auto result = co_await scheduler.write(fd, std::as_bytes(std::span {"hello", 5}));
+    EXPECT_EQ(result.value_, 5);
+  };
+
+  auto [received, written] =
+      coro::sync_wait(coro::when_all(reader(*scheduler, pipe.read()), writer(*scheduler, pipe.write())));
+  EXPECT_EQ(received, "hello");
+  scheduler->shutdown();
+  EXPECT_TRUE(scheduler->empty());
+}
+
+TEST_P(IoOperationTest, FileWritesAndReadsAtOffsets) {
+  auto scheduler = makeScheduler();
+  auto file      = ::open("/tmp", O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+  ASSERT_GE(file, 0);
+
+  auto task = [](coro::IoScheduler &scheduler, int fd) -> coro::Task<std::string> {
+    EXPECT_EQ((co_await scheduler.write(fd, std::as_bytes(std::span {"abcdef", 6}))).value_, 6);
+    EXPECT_EQ((co_await scheduler.write(fd, std::as_bytes(std::span {"XY", 2}), 2)).value_, 2);
+    EXPECT_TRUE((co_await scheduler.fsync(fd, true)).ok());
+    EXPECT_TRUE((co_await scheduler.fsync(fd)).ok());
+
+    std::array<std::byte, 4> buffer {};
+    auto result = co_await scheduler.read(fd, buffer, 1);
+    co_return std::string(reinterpret_cast<const char *>(buffer.data()), result.ok() ? result.value_ : 0);
+  };
+  EXPECT_EQ(coro::sync_wait(task(*scheduler, file)), "bXYe");
+  ::close(file);
+}
+
+TEST_P(IoOperationTest, SendAndRecvOnSocketPair) {
+  auto scheduler = makeScheduler();
+  auto sockets   = FdPair::socketPair();
+
+  auto receiver = [](coro::IoScheduler &scheduler, int fd) -> coro::Task<std::string> {
+    std::array<std::byte, 16> buffer {};
+    auto result = co_await scheduler.recv(fd, buffer);
+    co_return std::string(reinterpret_cast<const char *>(buffer.data()), result.ok() ? result.value_ : 0);
+  };
+  auto sender = [](coro::IoScheduler &scheduler, int fd) -> coro::Task<void> {
+    co_await scheduler.sleep_for(10ms);
+    EXPECT_EQ((co_await scheduler.send(fd, std::as_bytes(std::span {"ping", 4}))).value_, 4);
+  };
+
+  auto [received, sent] =
+      coro::sync_wait(coro::when_all(receiver(*scheduler, sockets.read()), sender(*scheduler, sockets.write())));
+  EXPECT_EQ(received, "ping");
+  scheduler->shutdown();
+  EXPECT_TRUE(scheduler->empty());
+}
+
+TEST_P(IoOperationTest, AcceptOnLoopback) {
+  auto scheduler = makeScheduler();
+
+  auto listener = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  ASSERT_GE(listener, 0);
+  sockaddr_in address {};
+  address.sin_family      = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length        = sizeof(address);
+  ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)), 0);
+  ASSERT_EQ(::listen(listener, 4), 0);
+  ASSERT_EQ(::getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length), 0);
+
+  auto server = [](coro::IoScheduler &scheduler, int listener) -> coro::Task<void> {
+    auto connection = co_await scheduler.accept(listener, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    EXPECT_TRUE(connection.ok()) << connection.error().message();
+    auto fd = static_cast<int>(connection.value_);
+
+    std::array<std::byte, 16> buffer {};
+    auto received = co_await scheduler.recv(fd, buffer);
+    EXPECT_EQ(received.value_, 4);
+    auto sent = co_await scheduler.send(fd, std::span {buffer}.first(received.ok() ? received.value_ : 0));
+    EXPECT_EQ(sent.value_, 4);
+    ::close(fd);
+  };
+  auto client = [](coro::IoScheduler &scheduler, sockaddr_in address) -> coro::Task<std::string> {
+    auto fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+    EXPECT_EQ(co_await scheduler.poll(fd, coro::PollOp::Write, 5s), coro::PollStatus::Event);
+    EXPECT_EQ((co_await scheduler.send(fd, std::as_bytes(std::span {"ping", 4}))).value_, 4);
+
+    std::array<std::byte, 16> buffer {};
+    auto result = co_await scheduler.recv(fd, buffer);
+    ::close(fd);
+    co_return std::string(reinterpret_cast<const char *>(buffer.data()), result.ok() ? result.value_ : 0);
+  };
+
+  auto [served, echoed] = coro::sync_wait(coro::when_all(server(*scheduler, listener), client(*scheduler, address)));
+  EXPECT_EQ(echoed, "ping");
+  ::close(listener);
+  scheduler->shutdown();
+  EXPECT_TRUE(scheduler->empty());
+}
+
+TEST_P(IoOperationTest, RegisteredBuffersAndFiles) {
+  auto scheduler = makeScheduler();
+  auto pipe      = FdPair::pipe();
+
+  std::array<std::byte, 64> buffer {};
+  std::array<std::span<std::byte>, 1> buffers {buffer};
+  std::array<int, 2> files {pipe.read(), pipe.write()};
+  scheduler->register_buffers(buffers);
+  scheduler->register_files(files);
+
+  auto task = [](coro::IoScheduler &scheduler, std::span<std::byte> buffer) -> coro::Task<std::string> {
+    std::ranges::copy(std::as_bytes(std::span {"fixed", 5}), buffer.begin());
+    auto written = co_await scheduler.write_fixed(coro::IoFile::fixed(1), buffer.first(5), 0);
+    EXPECT_EQ(written.value_, 5);
+
+    auto target = buffer.subspan(32);
+    auto result = co_await scheduler.read_fixed(coro::IoFile::fixed(0), target, 0);
+    EXPECT_TRUE(result.ok()) << result.error().message();
+    co_return std::string(reinterpret_cast<const char *>(target.data()), result.ok() ? result.value_ : 0);
+  };
+  EXPECT_EQ(coro::sync_wait(task(*scheduler, buffer)), "fixed");
+
+  auto invalid = [](coro::IoScheduler &scheduler) -> coro::Task<coro::IoResult> {
+    std::array<std::byte, 4> buffer {};
+    co_return co_await scheduler.read(coro::IoFile::fixed(7), buffer);
+  };
+  EXPECT_FALSE(coro::sync_wait(invalid(*scheduler)).ok());
+  scheduler->shutdown();
+}
+
+TEST_P(IoOperationTest, InvalidFdFailsWithEbadf) {
+  auto scheduler = makeScheduler();
+
+  auto task = [](coro::IoScheduler &scheduler) -> coro::Task<coro::IoResult> {
+    std::array<std::byte, 4> buffer {};
+    co_return co_await scheduler.recv(-1, buffer);
+  };
+  auto result = coro::sync_wait(task(*scheduler));
+  EXPECT_EQ(result.error(), std::error_code(EBADF, std::system_category()));
+  EXPECT_TRUE(scheduler->empty());
+}
+
+TEST_P(IoOperationTest, ShutdownCancelsInFlightOperations) {
+  auto scheduler = makeScheduler();
+  auto sockets   = FdPair::socketPair();
+
+  auto task = [](coro::IoScheduler &scheduler, int fd) -> coro::Task<coro::IoResult> {
+    std::array<std::byte, 4> buffer {};
+    co_return co_await scheduler.recv(fd, buffer);
+  };
+  auto stopper = [](coro::IoScheduler &scheduler) -> coro::Task<void> {
+    while (scheduler.empty()) { std::this_thread::yield(); }
+    scheduler.shutdown();
+    co_return;
+  };
+
+  auto [result, stopped] = coro::sync_wait(coro::when_all(task(*scheduler, sockets.read()), stopper(*scheduler)));
+  EXPECT_EQ(result.error(), std::error_code(ECANCELED, std::system_category()));
+  EXPECT_EQ(coro::sync_wait(task(*scheduler, sockets.read())).error(),
+      std::error_code(ECANCELED, std::system_category()));
+  EXPECT_TRUE(scheduler->empty());
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, IoOperationTest,
+    ::testing::Values(coro::IoScheduler::Backend::Epoll, coro::IoScheduler::Backend::IoUring),
+    [](const auto &info) {
+      return info.param == coro::IoScheduler::Backend::Epoll ? std::string {"Epoll"} : std::string {"IoUring"};
+    });
+
+namespace {
+struct TestTimer : coro::detail::TimerNode {
+  uint64_t deadline_ {0};
+};
+}  // namespace
+
+TEST(TimerWheelTest, ExpiresEachTimerOnItsTickAcrossLevels) {
+  using Clock = coro::detail::TimerWheel::Clock;
+  auto start  = Clock::time_point {};
+  coro::detail::TimerWheel wheel {1ms, start};
+
+  // Spans every level and the overflow, some erased before expiring.
+  std::mt19937_64 random {42};
+  std::vector<TestTimer> timers(4096);
+  for (auto &timer : timers) {
+    timer.deadline_ = random() % (uint64_t {1} << (random() % 27));
+    wheel.insert(timer, start + std::chrono::milliseconds {timer.deadline_});
+  }
+  for (std::size_t i = 0; i < timers.size(); i += 7) { wheel.erase(timers[i]); }
+  EXPECT_EQ(wheel.size(), timers.size() - (timers.size() + 6) / 7);
+
+  std::vector<coro::detail::TimerNode *> expired {};
+  uint64_t now {0};
+  std::size_t steps {0};
+  while (!wheel.empty()) {
+    // Jumping straight to the next deadline takes a few steps per timer at most.
+    auto next = wheel.next_deadline();
+    ASSERT_NE(next, Clock::time_point::max());
+    auto tick = static_cast<uint64_t>((next - start) / 1ms);
+    ASSERT_GE(tick, now);
+    now = tick;
+
+    expired.clear();
+    wheel.advance(next, expired);
+    for (auto *node : expired) {
+      auto &timer = static_cast<TestTimer &>(*node);
+      EXPECT_EQ(timer.deadline_, now);
+      EXPECT_FALSE(timer.linked());
+      timer.deadline_ = std::numeric_limits<uint64_t>::max();
+    }
+    ASSERT_LT(++steps, timers.size() * 5);
+  }
+
+  for (std::size_t i = 0; i < timers.size(); ++i) {
+    EXPECT_EQ(timers[i].deadline_ == std::numeric_limits<uint64_t>::max(), i % 7 != 0) << i;
+  }
+}
+
+TEST(TimerWheelTest, RoundsDeadlinesUpToTheTick) {
+  using Clock = coro::detail::TimerWheel::Clock;
+  auto start  = Clock::time_point {};
+  coro::detail::TimerWheel wheel {10ms, start};
+
+  TestTimer past {};
+  TestTimer rounded {};
+  wheel.insert(past, start - 1s);
+  wheel.insert(rounded, start + 11ms);
+  EXPECT_EQ(wheel.next_deadline(), start);
+
+  std::vector<coro::detail::TimerNode *> expired {};
+  wheel.advance(start + 19ms, expired);
+  ASSERT_EQ(expired.size(), 1);
+  EXPECT_EQ(expired[0], &past);
+  EXPECT_EQ(wheel.next_deadline(), start + 20ms);
+
+  wheel.advance(start + 20ms, expired);
+  ASSERT_EQ(expired.size(), 2);
+  EXPECT_EQ(expired[1], &rounded);
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_EQ(wheel.next_deadline(), Clock::time_point::max());
+}
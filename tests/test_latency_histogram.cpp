@@ -0,0 +1,58 @@
+#include <coro/latency_histogram.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using coro::LatencyHistogram;
+
+TEST(LatencyHistogramTest, BucketsCoverEveryValueWithBoundedError) {
+  for (std::size_t bucket = 0; bucket + 1 < LatencyHistogram::bucketCount_; ++bucket) {
+    EXPECT_EQ(LatencyHistogram::highest_of(bucket) + 1, LatencyHistogram::lowest_of(bucket + 1));
+  }
+  EXPECT_EQ(LatencyHistogram::highest_of(LatencyHistogram::bucketCount_ - 1), std::numeric_limits<uint64_t>::max());
+
+  for (uint64_t value : {0ULL, 1ULL, 15ULL, 16ULL, 31ULL, 32ULL, 1000ULL, 123'456'789ULL, ~0ULL}) {
+    auto bucket = LatencyHistogram::bucket_of(value);
+    EXPECT_LE(LatencyHistogram::lowest_of(bucket), value);
+    EXPECT_GE(LatencyHistogram::highest_of(bucket), value);
+    // Within 1/16th of the value.
+    EXPECT_LE(LatencyHistogram::highest_of(bucket) - LatencyHistogram::lowest_of(bucket), value / 16);
+  }
+}
+
+TEST(LatencyHistogramTest, Percentiles) {
+  LatencyHistogram histogram {};
+  EXPECT_EQ(histogram.percentile(50), 0);
+  EXPECT_EQ(histogram.min(), 0);
+
+  for (uint64_t value = 1; value <= 1000; ++value) { histogram.record(value * 1000); }
+  EXPECT_EQ(histogram.count(), 1000);
+  EXPECT_EQ(histogram.min(), 1000);
+  EXPECT_EQ(histogram.max(), 1'000'000);
+  EXPECT_DOUBLE_EQ(histogram.mean(), 500'500.0);
+
+  auto near = [](uint64_t actual, uint64_t expected) { return actual >= expected && actual <= expected + expected / 16; };
+  EXPECT_TRUE(near(histogram.percentile(50), 500'000)) << histogram.percentile(50);
+  EXPECT_TRUE(near(histogram.percentile(99), 990'000)) << histogram.percentile(99);
+  EXPECT_EQ(histogram.percentile(100), 1'000'000);
+  EXPECT_EQ(histogram.percentile(0), LatencyHistogram::highest_of(LatencyHistogram::bucket_of(1000)));
+}
+
+TEST(LatencyHistogramTest, MergeAndAtomicRecording) {
+  coro::detail::AtomicLatencyHistogram recorder {};
+  std::thread writer {[&]() {
+    for (uint64_t value = 0; value < 10'000; ++value) { recorder.record(value); }
+  }};
+  writer.join();
+
+  LatencyHistogram histogram {};
+  histogram.record(20'000, 10);
+  recorder.add_to(histogram);
+  EXPECT_EQ(histogram.count(), 10'010);
+  EXPECT_EQ(histogram.min(), 0);
+  EXPECT_EQ(histogram.max(), 20'000);
+  EXPECT_EQ(histogram.count(LatencyHistogram::bucket_of(20'000)), 10);
+}
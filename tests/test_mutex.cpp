@@ -0,0 +1,243 @@
+#include <coro/mutex.hpp>
+#include <coro/shared_mutex.hpp>
+#include <coro/sync_wait.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/when_all.hpp>
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+/**
+ * Suspends forever, the test resumes the coroutine through the stored handle.
+ */
+struct Park {
+  std::coroutine_handle<> &handle_;
+
+  auto await_ready() const noexcept -> bool { return false; }
+  auto await_suspend(std::coroutine_handle<> handle) noexcept -> void { handle_ = handle; }
+  auto await_resume() const noexcept -> void {}
+};
+}  // namespace
+
+TEST(MutexTest, TryLockWithoutContention) {
+  coro::Mutex mutex {};
+  EXPECT_TRUE(mutex.try_lock());
+  EXPECT_FALSE(mutex.try_lock());
+  mutex.unlock();
+  EXPECT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+TEST(MutexTest, HandsTheLockToWaitersInOrder) {
+  coro::Mutex mutex {};
+  std::vector<int> order {};
+  auto waiter = [](coro::Mutex &mutex, std::vector<int> &order, int id) -> coro::Task<void> {
+    auto lock = co_await mutex.scoped_lock();
+    order.emplace_back(id);
+  };
+
+  ASSERT_TRUE(mutex.try_lock());
+  std::vector<coro::Task<void>> waiters {};
+  for (int i = 0; i < 4; ++i) {
+    waiters.emplace_back(waiter(mutex, order, i));
+    waiters.back().resume();
+  }
+  EXPECT_TRUE(order.empty());
+
+  // Each waiter runs inline on unlock and hands the lock on when its ScopedLock destructs.
+  mutex.unlock();
+  EXPECT_EQ(order, (std::vector<int> {0, 1, 2, 3}));
+  for (auto &task : waiters) { EXPECT_TRUE(task.is_ready()); }
+  EXPECT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+TEST(MutexTest, ScopedLockReleasesEarly) {
+  coro::Mutex mutex {};
+  auto task = [](coro::Mutex &mutex) -> coro::Task<bool> {
+    auto lock = co_await mutex.scoped_lock();
+    EXPECT_TRUE(lock.owns_lock());
+    lock.unlock();
+    EXPECT_FALSE(lock.owns_lock());
+    co_return mutex.try_lock();
+  };
+
+  EXPECT_TRUE(coro::sync_wait(task(mutex)));
+  mutex.unlock();
+}
+
+TEST(MutexTest, LongChainOfInlineHandoffsDoesNotNest) {
+  constexpr std::size_t waiterCount = 200'000;
+  coro::Mutex mutex {};
+  std::size_t counter {0};
+  auto waiter = [](coro::Mutex &mutex, std::size_t &counter) -> coro::Task<void> {
+    auto lock = co_await mutex.scoped_lock();
+    ++counter;
+  };
+
+  ASSERT_TRUE(mutex.try_lock());
+  std::vector<coro::Task<void>> waiters {};
+  waiters.reserve(waiterCount);
+  for (std::size_t i = 0; i < waiterCount; ++i) {
+    waiters.emplace_back(waiter(mutex, counter));
+    waiters.back().resume();
+  }
+
+  // Every waiter hands the lock to the next one, nested that would overflow the stack.
+  mutex.unlock();
+  EXPECT_EQ(counter, waiterCount);
+  EXPECT_TRUE(waiters.back().is_ready());
+  EXPECT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+TEST(MutexTest, SerializesTasksOnThreadPool) {
+  constexpr std::size_t taskCount      = 64;
+  constexpr std::size_t incrementCount = 500;
+  auto tp                              = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 4});
+  coro::Mutex mutex {*tp};
+
+  // A plain counter, any overlap between holders is a data race.
+  std::size_t counter {0};
+  auto task = [](coro::ThreadPool &tp, coro::Mutex &mutex, std::size_t &counter) -> coro::Task<void> {
+    co_await tp.schedule();
+    for (std::size_t i = 0; i < incrementCount; ++i) {
+      auto lock = co_await mutex.scoped_lock();
+      ++counter;
+    }
+  };
+
+  std::vector<coro::Task<void>> tasks {};
+  for (std::size_t i = 0; i < taskCount; ++i) { tasks.emplace_back(task(*tp, mutex, counter)); }
+  coro::sync_wait(coro::when_all(std::move(tasks)));
+  EXPECT_EQ(counter, taskCount * incrementCount);
+  tp->shutdown();
+}
+
+TEST(SharedMutexTest, TryLockExcludesWritersOnly) {
+  coro::SharedMutex mutex {};
+  EXPECT_TRUE(mutex.try_lock_shared());
+  EXPECT_TRUE(mutex.try_lock_shared());
+  EXPECT_FALSE(mutex.try_lock());
+  mutex.unlock_shared();
+  mutex.unlock_shared();
+
+  EXPECT_TRUE(mutex.try_lock());
+  EXPECT_FALSE(mutex.try_lock_shared());
+  EXPECT_FALSE(mutex.try_lock());
+  mutex.unlock();
+  EXPECT_TRUE(mutex.try_lock_shared());
+  mutex.unlock_shared();
+}
+
+TEST(SharedMutexTest, QueuedWriterBlocksNewReaders) {
+  coro::SharedMutex mutex {};
+  std::vector<char> order {};
+  std::coroutine_handle<> parked {};
+  auto reader = [](coro::SharedMutex &mutex, std::vector<char> &order,
+                   std::coroutine_handle<> &parked) -> coro::Task<void> {
+    auto lock = co_await mutex.scoped_lock_shared();
+    order.emplace_back('r');
+    if (!parked) { co_await Park {parked}; }
+  };
+  auto writer = [](coro::SharedMutex &mutex, std::vector<char> &order) -> coro::Task<void> {
+    auto lock = co_await mutex.scoped_lock();
+    order.emplace_back('w');
+  };
+
+  // The first reader keeps the lock until it is resumed.
+  auto first = reader(mutex, order, parked);
+  first.resume();
+  ASSERT_TRUE(parked);
+
+  auto queuedWriter = writer(mutex, order);
+  queuedWriter.resume();
+  std::vector<coro::Task<void>> lateReaders {};
+  for (int i = 0; i < 3; ++i) {
+    lateReaders.emplace_back(reader(mutex, order, parked));
+    lateReaders.back().resume();
+  }
+  EXPECT_FALSE(mutex.try_lock_shared());
+  EXPECT_EQ(order, (std::vector<char> {'r'}));
+
+  // The writer goes first, then the readers queued behind it share the lock.
+  parked.resume();
+  EXPECT_EQ(order, (std::vector<char> {'r', 'w', 'r', 'r', 'r'}));
+  EXPECT_TRUE(first.is_ready());
+  EXPECT_TRUE(queuedWriter.is_ready());
+  for (auto &task : lateReaders) { EXPECT_TRUE(task.is_ready()); }
+  EXPECT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+TEST(SharedMutexTest, LongChainOfInlineWritersDoesNotNest) {
+  constexpr std::size_t waiterCount = 200'000;
+  coro::SharedMutex mutex {};
+  std::size_t counter {0};
+  auto writer = [](coro::SharedMutex &mutex, std::size_t &counter) -> coro::Task<void> {
+    auto lock = co_await mutex.scoped_lock();
+    ++counter;
+  };
+
+  ASSERT_TRUE(mutex.try_lock());
+  std::vector<coro::Task<void>> writers {};
+  writers.reserve(waiterCount);
+  for (std::size_t i = 0; i < waiterCount; ++i) {
+    writers.emplace_back(writer(mutex, counter));
+    writers.back().resume();
+  }
+
+  mutex.unlock();
+  EXPECT_EQ(counter, waiterCount);
+  EXPECT_TRUE(writers.back().is_ready());
+  EXPECT_TRUE(mutex.try_lock_shared());
+  mutex.unlock_shared();
+}
+
+TEST(SharedMutexTest, ReadersAndWritersOnThreadPool) {
+  constexpr std::size_t taskCount      = 32;
+  constexpr std::size_t iterationCount = 200;
+  auto tp                              = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 4});
+  coro::SharedMutex mutex {*tp};
+
+  std::size_t value {0};
+  std::atomic<int> readers {0};
+  std::atomic<bool> overlap {false};
+  auto writer = [](coro::ThreadPool &tp, coro::SharedMutex &mutex, std::size_t &value,
+                   std::atomic<int> &readers, std::atomic<bool> &overlap) -> coro::Task<void> {
+    co_await tp.schedule();
+    for (std::size_t i = 0; i < iterationCount; ++i) {
+      auto lock = co_await mutex.scoped_lock();
+      if (readers.load() != 0) { overlap = true; }
+      ++value;
+    }
+  };
+  auto reader = [](coro::ThreadPool &tp, coro::SharedMutex &mutex, std::size_t &value,
+                   std::atomic<int> &readers) -> coro::Task<void> {
+    co_await tp.schedule();
+    std::size_t last {0};
+    for (std::size_t i = 0; i < iterationCount; ++i) {
+      auto lock = co_await mutex.scoped_lock_shared();
+      ++readers;
+      EXPECT_GE(value, last);
+      last = value;
+      --readers;
+    }
+  };
+
+  std::vector<coro::Task<void>> tasks {};
+  for (std::size_t i = 0; i < taskCount; ++i) {
+    tasks.emplace_back(writer(*tp, mutex, value, readers, overlap));
+    tasks.emplace_back(reader(*tp, mutex, value, readers));
+  }
+  coro::sync_wait(coro::when_all(std::move(tasks)));
+  EXPECT_EQ(value, taskCount * iterationCount);
+  EXPECT_FALSE(overlap.load());
+  tp->shutdown();
+}
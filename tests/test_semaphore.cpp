@@ -0,0 +1,99 @@
+#include <coro/semaphore.hpp>
+#include <coro/sync_wait.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/when_all.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(SemaphoreTest, TryAcquireCountsUnits) {
+  coro::Semaphore semaphore {2};
+  EXPECT_TRUE(semaphore.try_acquire());
+  EXPECT_TRUE(semaphore.try_acquire());
+  EXPECT_FALSE(semaphore.try_acquire());
+  EXPECT_EQ(semaphore.available(), 0);
+
+  semaphore.release(3);
+  EXPECT_EQ(semaphore.available(), 3);
+}
+
+TEST(SemaphoreTest, ReleaseHandsUnitsToOldestWaiters) {
+  coro::Semaphore semaphore {0};
+  std::vector<int> order {};
+  auto task = [](coro::Semaphore &semaphore, std::vector<int> &order, int id) -> coro::Task<void> {
+    co_await semaphore.acquire();
+    order.emplace_back(id);
+  };
+
+  std::vector<coro::Task<void>> waiters {};
+  for (int i = 0; i < 3; ++i) {
+    waiters.emplace_back(task(semaphore, order, i));
+    waiters.back().resume();
+  }
+  EXPECT_TRUE(order.empty());
+
+  semaphore.release(2);
+  EXPECT_EQ(order, (std::vector<int> {0, 1}));
+  EXPECT_EQ(semaphore.available(), 0);
+  semaphore.release(2);
+  EXPECT_EQ(order, (std::vector<int> {0, 1, 2}));
+  EXPECT_EQ(semaphore.available(), 1);
+}
+
+TEST(SemaphoreTest, LongChainOfInlineReleasesDoesNotNest) {
+  constexpr std::size_t waiterCount = 200'000;
+  coro::Semaphore semaphore {0};
+  std::size_t counter {0};
+  auto task = [](coro::Semaphore &semaphore, std::size_t &counter) -> coro::Task<void> {
+    co_await semaphore.acquire();
+    ++counter;
+    semaphore.release();
+  };
+
+  std::vector<coro::Task<void>> waiters {};
+  waiters.reserve(waiterCount);
+  for (std::size_t i = 0; i < waiterCount; ++i) {
+    waiters.emplace_back(task(semaphore, counter));
+    waiters.back().resume();
+  }
+
+  // Every waiter releases the unit to the next one, nested that would overflow the stack.
+  semaphore.release();
+  EXPECT_EQ(counter, waiterCount);
+  EXPECT_TRUE(waiters.back().is_ready());
+  EXPECT_EQ(semaphore.available(), 1);
+}
+
+TEST(SemaphoreTest, LimitsConcurrencyOnThreadPool) {
+  constexpr std::size_t taskCount = 128;
+  constexpr std::ptrdiff_t limit  = 3;
+  auto tp                         = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 4});
+  coro::Semaphore semaphore {*tp, limit};
+
+  std::atomic<std::ptrdiff_t> active {0};
+  std::atomic<std::ptrdiff_t> peak {0};
+  auto task = [](coro::ThreadPool &tp, coro::Semaphore &semaphore, std::atomic<std::ptrdiff_t> &active,
+                 std::atomic<std::ptrdiff_t> &peak) -> coro::Task<void> {
+    co_await tp.schedule();
+    for (int i = 0; i < 10; ++i) {
+      co_await semaphore.acquire();
+      auto current = active.fetch_add(1) + 1;
+      auto seen    = peak.load();
+      while (current > seen && !peak.compare_exchange_weak(seen, current)) {}
+      co_await tp.yield();
+      active.fetch_sub(1);
+      semaphore.release();
+    }
+  };
+
+  std::vector<coro::Task<void>> tasks {};
+  for (std::size_t i = 0; i < taskCount; ++i) { tasks.emplace_back(task(*tp, semaphore, active, peak)); }
+  coro::sync_wait(coro::when_all(std::move(tasks)));
+  EXPECT_LE(peak.load(), limit);
+  EXPECT_EQ(semaphore.available(), limit);
+  tp->shutdown();
+}
@@ -0,0 +1,148 @@
+#include <coro/strand.hpp>
+#include <coro/sync_wait.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/detail/mpsc_queue.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <latch>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+struct TestNode {
+  std::atomic<TestNode *> next_ {nullptr};
+  std::size_t producer_ {0};
+  std::size_t sequence_ {0};
+};
+}  // namespace
+
+TEST(IntrusiveMpscQueueTest, FifoThroughTheNodes) {
+  coro::detail::IntrusiveMpscQueue<TestNode> queue {};
+  std::array<TestNode, 3> nodes {};
+  EXPECT_EQ(queue.pop(), nullptr);
+
+  for (auto &node : nodes) { queue.push(node); }
+  EXPECT_EQ(queue.pop(), &nodes[0]);
+  queue.push(nodes[0]);
+  EXPECT_EQ(queue.pop(), &nodes[1]);
+  EXPECT_EQ(queue.pop(), &nodes[2]);
+  EXPECT_EQ(queue.pop(), &nodes[0]);
+  EXPECT_EQ(queue.pop(), nullptr);
+
+  queue.push(nodes[1]);
+  EXPECT_EQ(queue.pop(), &nodes[1]);
+  EXPECT_EQ(queue.pop(), nullptr);
+}
+
+TEST(IntrusiveMpscQueueTest, ConcurrentProducersKeepTheirOrder) {
+  constexpr std::size_t producerCount = 4;
+  constexpr std::size_t nodeCount     = 20000;
+  coro::detail::IntrusiveMpscQueue<TestNode> queue {};
+  std::vector<std::vector<TestNode>> nodes {};
+  for (std::size_t p = 0; p < producerCount; ++p) { nodes.emplace_back(nodeCount); }
+
+  std::vector<std::thread> producers {};
+  for (std::size_t p = 0; p < producerCount; ++p) {
+    producers.emplace_back([&, p] {
+      for (std::size_t i = 0; i < nodeCount; ++i) {
+        nodes[p][i].producer_ = p;
+        nodes[p][i].sequence_ = i;
+        queue.push(nodes[p][i]);
+      }
+    });
+  }
+
+  std::array<std::size_t, producerCount> expected {};
+  std::size_t popped {0};
+  while (popped < producerCount * nodeCount) {
+    auto *node = queue.pop();
+    if (node == nullptr) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(node->sequence_, expected[node->producer_]);
+    ++expected[node->producer_];
+    ++popped;
+  }
+  for (auto &producer : producers) { producer.join(); }
+  EXPECT_EQ(queue.pop(), nullptr);
+}
+
+TEST(StrandTest, RunsInScheduleOrder) {
+  constexpr std::size_t taskCount = 500;
+  auto tp                         = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 4});
+  coro::Strand strand {*tp, 16};
+
+  // Only touched on the strand.
+  std::vector<std::size_t> order {};
+  std::latch done {taskCount};
+  auto task = [](coro::Strand &strand, std::vector<std::size_t> &order, std::size_t id,
+                  std::latch &done) -> coro::Task<void> {
+    co_await strand.schedule();
+    EXPECT_TRUE(strand.running_in_this_thread());
+    order.emplace_back(id);
+    done.count_down();
+  };
+
+  std::vector<coro::Task<void>> tasks {};
+  for (std::size_t i = 0; i < taskCount; ++i) { tasks.emplace_back(task(strand, order, i, done)); }
+  for (auto &t : tasks) { t.resume(); }
+  done.wait();
+  EXPECT_FALSE(strand.running_in_this_thread());
+
+  ASSERT_EQ(order.size(), taskCount);
+  for (std::size_t i = 0; i < taskCount; ++i) { EXPECT_EQ(order[i], i); }
+  tp->shutdown();
+}
+
+TEST(StrandTest, MutualExclusionAcrossExecutors) {
+  constexpr std::size_t taskCount = 64;
+  constexpr std::size_t hopCount  = 50;
+  for (uint32_t drainBatch : {1u, 64u}) {
+    auto tp = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 4});
+    coro::Strand strand {*tp, drainBatch};
+
+    std::atomic<bool> inside {false};
+    std::size_t counter {0};
+    std::latch done {taskCount};
+    auto task = [](coro::ThreadPool &tp, coro::Strand &strand, std::atomic<bool> &inside, std::size_t &counter,
+                    std::latch &done) -> coro::Task<void> {
+      co_await tp.schedule();
+      for (std::size_t i = 0; i < hopCount; ++i) {
+        co_await strand.schedule();
+        EXPECT_FALSE(inside.exchange(true, std::memory_order::relaxed));
+        ++counter;
+        inside.store(false, std::memory_order::relaxed);
+        // Leaves the strand, the next coroutine on it may run meanwhile.
+        co_await tp.schedule();
+      }
+      done.count_down();
+    };
+
+    std::vector<coro::Task<void>> tasks {};
+    for (std::size_t i = 0; i < taskCount; ++i) { tasks.emplace_back(task(*tp, strand, inside, counter, done)); }
+    for (auto &t : tasks) { t.resume(); }
+    done.wait();
+    tp->shutdown();
+    EXPECT_EQ(counter, taskCount * hopCount) << "drain batch " << drainBatch;
+  }
+}
+
+TEST(StrandTest, RunsInlineOnceThePoolShutDown) {
+  auto tp = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 1});
+  coro::Strand strand {*tp};
+  tp->shutdown();
+
+  auto task = [](coro::Strand &strand) -> coro::Task<std::thread::id> {
+    co_await strand.schedule();
+    EXPECT_TRUE(strand.running_in_this_thread());
+    co_return std::this_thread::get_id();
+  };
+  EXPECT_EQ(coro::sync_wait(task(strand)), std::this_thread::get_id());
+  EXPECT_EQ(coro::sync_wait(task(strand)), std::this_thread::get_id());
+}
@@ -0,0 +1,59 @@
+#include <coro/sync_wait.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+TEST(SyncWaitTest, ReturnsValue) {
+  auto make_task = []() -> coro::Task<int> { co_return 42; };
+  EXPECT_EQ(coro::sync_wait(make_task()), 42);
+}
+
+TEST(SyncWaitTest, WaitsOnVoidTask) {
+  bool ran       = false;
+  auto make_task = [&ran]() -> coro::Task<void> {
+    ran = true;
+    co_return;
+  };
+  coro::sync_wait(make_task());
+  EXPECT_TRUE(ran);
+}
+
+TEST(SyncWaitTest, WaitsOnLvalueTask) {
+  auto make_task = []() -> coro::Task<std::string> { co_return "hello"; };
+  auto task      = make_task();
+  EXPECT_EQ(coro::sync_wait(task), "hello");
+}
+
+TEST(SyncWaitTest, NestedTasks) {
+  auto inner = [](int i) -> coro::Task<int> { co_return i * 2; };
+  auto outer = [&inner]() -> coro::Task<int> {
+    auto a = co_await inner(1);
+    auto b = co_await inner(2);
+    co_return a + b;
+  };
+  EXPECT_EQ(coro::sync_wait(outer()), 6);
+}
+
+TEST(SyncWaitTest, RethrowsException) {
+  auto make_task = []() -> coro::Task<int> {
+    throw std::runtime_error("boom");
+    co_return 0;
+  };
+  EXPECT_THROW(coro::sync_wait(make_task()), std::runtime_error);
+}
+
+TEST(SyncWaitTest, WaitsOnThreadPool) {
+  auto tp        = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 2});
+  auto make_task = [&tp]() -> coro::Task<std::thread::id> {
+    co_await tp->schedule();
+    co_return std::this_thread::get_id();
+  };
+
+  for (int i = 0; i < 100; ++i) { EXPECT_NE(coro::sync_wait(make_task()), std::this_thread::get_id()); }
+  tp->shutdown();
+}
@@ -1,22 +1,23 @@
 #include <coro/task.hpp>
+#include <coro/sync_wait.hpp>
 
 #include <chrono>
 #include <iostream>
+#include <memory_resource>
+#include <stop_token>
 #include <thread>
 
 #include <gtest/gtest.h>
 
 using namespace std::chrono_literals;
 
+struct move_construct_only;
+struct copy_construct_only;
+struct move_copy_construct_only;
+
 class TaskTest : public ::testing::Test {
-  // protected:
-  //   void SetUp() override {
-  //     // Reset static counters before each test
-  //     move_construct_only::move_count      = 0;
-  //     copy_construct_only::copy_count      = 0;
-  //     move_copy_construct_only::move_count = 0;
-  //     move_copy_construct_only::copy_count = 0;
-  //   }
+protected:
+  void SetUp() override;
 };
 
 TEST_F(TaskTest, StringTask) {
@@ -272,7 +273,6 @@ TEST_F(TaskTest, MutableTaskReturnsReference) {
   static_assert(std::is_same_v<decltype(task.promise().result()), type &>);
 }
 
-#if 0
 TEST_F(TaskTest, NoDefaultConstructorRequired) {
   struct A {
     A(int value) : m_value(value) {}
@@ -286,7 +286,7 @@ TEST_F(TaskTest, NoDefaultConstructorRequired) {
 
 TEST_F(TaskTest, SupportsRvalueReference) {
   int i          = 42;
-  auto make_task = [](int &i) -> coro::task<int &&> { co_return std::move(i); };
+  auto make_task = [](int &i) -> coro::Task<int &&> { co_return std::move(i); };
 
   int ret = coro::sync_wait(make_task(i));
   EXPECT_EQ(ret, 42);
@@ -333,35 +333,43 @@ struct move_copy_construct_only {
 int move_copy_construct_only::move_count = 0;
 int move_copy_construct_only::copy_count = 0;
 
+void TaskTest::SetUp() {
+  // Reset static counters before each test
+  move_construct_only::move_count      = 0;
+  copy_construct_only::copy_count      = 0;
+  move_copy_construct_only::move_count = 0;
+  move_copy_construct_only::copy_count = 0;
+}
+
 TEST_F(TaskTest, SupportsNonAssignableTypes) {
   int i = 42;
 
   // Test move_construct_only
-  auto move_task = [&i]() -> coro::task<move_construct_only> { co_return move_construct_only(i); };
+  auto move_task = [&i]() -> coro::Task<move_construct_only> { co_return move_construct_only(i); };
   auto move_ret  = coro::sync_wait(move_task());
   EXPECT_EQ(std::addressof(move_ret.i), std::addressof(i));
   EXPECT_EQ(move_construct_only::move_count, 2);
 
   move_construct_only::move_count = 0;
-  auto move_task2                 = [&i]() -> coro::task<move_construct_only> { co_return i; };
+  auto move_task2                 = [&i]() -> coro::Task<move_construct_only> { co_return i; };
   auto move_ret2                  = coro::sync_wait(move_task2());
   EXPECT_EQ(std::addressof(move_ret2.i), std::addressof(i));
   EXPECT_EQ(move_construct_only::move_count, 1);
 
   // Test copy_construct_only
-  auto copy_task = [&i]() -> coro::task<copy_construct_only> { co_return copy_construct_only(i); };
+  auto copy_task = [&i]() -> coro::Task<copy_construct_only> { co_return copy_construct_only(i); };
   auto copy_ret  = coro::sync_wait(copy_task());
   EXPECT_EQ(copy_ret.i, 42);
   EXPECT_EQ(copy_construct_only::copy_count, 2);
 
   copy_construct_only::copy_count = 0;
-  auto copy_task2                 = [&i]() -> coro::task<copy_construct_only> { co_return i; };
+  auto copy_task2                 = [&i]() -> coro::Task<copy_construct_only> { co_return i; };
   auto copy_ret2                  = coro::sync_wait(copy_task2());
   EXPECT_EQ(copy_ret2.i, 42);
   EXPECT_EQ(copy_construct_only::copy_count, 1);
 
   // Test move_copy_construct_only
-  auto move_copy_task = [&i]() -> coro::task<move_copy_construct_only> { co_return move_copy_construct_only(i); };
+  auto move_copy_task = [&i]() -> coro::Task<move_copy_construct_only> { co_return move_copy_construct_only(i); };
   auto task           = move_copy_task();
   auto move_copy_ret1 = coro::sync_wait(task);
   auto move_copy_ret2 = coro::sync_wait(std::move(task));
@@ -371,29 +379,177 @@ TEST_F(TaskTest, SupportsNonAssignableTypes) {
   EXPECT_EQ(move_copy_construct_only::copy_count, 1);
 
   // Test tuple return
-  auto make_tuple_task = [](int i) -> coro::task<tuple<int, int>> { co_return make_tuple(i, i * 2); };
+  auto make_tuple_task = [](int i) -> coro::Task<std::tuple<int, int>> { co_return std::make_tuple(i, i * 2); };
   auto tuple_ret       = coro::sync_wait(make_tuple_task(i));
-  EXPECT_EQ(get<0>(tuple_ret), 42);
-  EXPECT_EQ(get<1>(tuple_ret), 84);
+  EXPECT_EQ(std::get<0>(tuple_ret), 42);
+  EXPECT_EQ(std::get<1>(tuple_ret), 84);
 
   // Test reference return
-  auto make_ref_task = [&i]() -> coro::task<int &> { co_return std::ref(i); };
+  auto make_ref_task = [&i]() -> coro::Task<int &> { co_return std::ref(i); };
   auto &ref_ret      = coro::sync_wait(make_ref_task());
   EXPECT_EQ(std::addressof(ref_ret), std::addressof(i));
 }
-#endif
 
 TEST_F(TaskTest, PromiseSizeCheck) {
-  EXPECT_GE(sizeof(coro::detail::Promise<void>), sizeof(std::coroutine_handle<>) + sizeof(std::exception_ptr));
+  // The continuation plus the inherited cancellation state: a stop token and a deadline.
+  constexpr auto baseSize =
+      sizeof(std::coroutine_handle<>) + sizeof(std::stop_token) + sizeof(std::chrono::steady_clock::time_point);
 
-  EXPECT_EQ(sizeof(coro::detail::Promise<int32_t>),
-      sizeof(std::coroutine_handle<>) + sizeof(std::variant<int32_t, std::exception_ptr>));
+  EXPECT_GE(sizeof(coro::detail::Promise<void>), baseSize + sizeof(std::exception_ptr));
 
-  EXPECT_GE(sizeof(coro::detail::Promise<int64_t>),
-      sizeof(std::coroutine_handle<>) + sizeof(std::variant<int64_t, std::exception_ptr>));
+  EXPECT_EQ(sizeof(coro::detail::Promise<int32_t>), baseSize + sizeof(std::variant<int32_t, std::exception_ptr>));
+
+  EXPECT_GE(sizeof(coro::detail::Promise<int64_t>), baseSize + sizeof(std::variant<int64_t, std::exception_ptr>));
 
   EXPECT_GE(sizeof(coro::detail::Promise<std::vector<int64_t>>),
-      sizeof(std::coroutine_handle<>) + sizeof(std::variant<std::vector<int64_t>, std::exception_ptr>));
+      baseSize + sizeof(std::variant<std::vector<int64_t>, std::exception_ptr>));
+}
+
+TEST_F(TaskTest, StopTokenIsInheritedByAwaitedTasks) {
+  auto leaf = []() -> coro::Task<bool> { co_return co_await coro::this_task::stop_requested(); };
+  auto root = [&leaf]() -> coro::Task<std::pair<bool, bool>> {
+    auto before = co_await leaf();
+    auto token  = co_await coro::this_task::stop_token();
+    co_return std::pair {before, token.stop_possible()};
+  };
+
+  std::stop_source stopSource {};
+  auto task = root();
+  task.promise().stop_token(stopSource.get_token());
+  auto [before, possible] = coro::sync_wait(task);
+  EXPECT_FALSE(before);
+  EXPECT_TRUE(possible);
+
+  stopSource.request_stop();
+  auto stopped = leaf();
+  auto outer   = [&stopped]() -> coro::Task<bool> { co_return co_await std::move(stopped); };
+  auto parent  = outer();
+  parent.promise().stop_token(stopSource.get_token());
+  EXPECT_TRUE(coro::sync_wait(parent));
+}
+
+TEST_F(TaskTest, OwnStopTokenIsKept) {
+  auto leaf   = []() -> coro::Task<bool> { co_return co_await coro::this_task::stop_requested(); };
+  auto child  = leaf();
+  auto parent = [&child]() -> coro::Task<bool> { co_return co_await std::move(child); };
+
+  std::stop_source childSource {};
+  std::stop_source parentSource {};
+  child.promise().stop_token(childSource.get_token());
+  parentSource.request_stop();
+
+  auto task = parent();
+  task.promise().stop_token(parentSource.get_token());
+  EXPECT_FALSE(coro::sync_wait(task));
+}
+
+TEST_F(TaskTest, DeadlineIsInheritedAndTightened) {
+  auto leaf = []() -> coro::Task<std::chrono::steady_clock::time_point> {
+    co_return co_await coro::this_task::deadline();
+  };
+
+  auto near = std::chrono::steady_clock::now() + 1h;
+  auto far  = near + 1h;
+
+  auto child = leaf();
+  child.promise().deadline(far);
+  auto parent = [&child]() -> coro::Task<std::chrono::steady_clock::time_point> {
+    co_return co_await std::move(child);
+  };
+  auto task   = parent();
+  task.promise().deadline(near);
+  EXPECT_EQ(coro::sync_wait(task), near);
+
+  auto make_expired = [&leaf]() -> coro::Task<bool> {
+    co_await leaf();
+    co_return co_await coro::this_task::stop_requested();
+  };
+  auto expired = make_expired();
+  expired.promise().deadline(std::chrono::steady_clock::now() - 1ms);
+  EXPECT_TRUE(coro::sync_wait(expired));
+
+  auto none = leaf();
+  EXPECT_EQ(coro::sync_wait(none), coro::detail::PromiseBase::noDeadline);
+}
+
+namespace {
+/// Counts what goes through it, forwards to the default resource.
+class CountingResource : public std::pmr::memory_resource {
+public:
+  std::size_t allocations_ {0};
+  std::size_t deallocations_ {0};
+
+private:
+  auto do_allocate(std::size_t bytes, std::size_t alignment) -> void * override {
+    ++allocations_;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  auto do_deallocate(void *p, std::size_t bytes, std::size_t alignment) -> void override {
+    ++deallocations_;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  auto do_is_equal(const std::pmr::memory_resource &other) const noexcept -> bool override { return this == &other; }
+};
+
+/// Stateful allocator that counts the blocks it hands out.
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+
+  explicit CountingAllocator(int &live) : live_(&live) {}
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U> &other) : live_(other.live_) {}
+
+  auto allocate(std::size_t n) -> T * {
+    ++*live_;
+    return std::allocator<T> {}.allocate(n);
+  }
+  auto deallocate(T *p, std::size_t n) -> void {
+    --*live_;
+    std::allocator<T> {}.deallocate(p, n);
+  }
+
+  int *live_;
+};
+
+auto arenaLeaf(std::allocator_arg_t, std::pmr::polymorphic_allocator<> allocator, int value) -> coro::Task<int> {
+  co_return value;
+}
+
+auto arenaRoot(std::allocator_arg_t, std::pmr::polymorphic_allocator<> allocator) -> coro::Task<int> {
+  auto a = co_await arenaLeaf(std::allocator_arg, allocator, 1);
+  auto b = co_await arenaLeaf(std::allocator_arg, allocator, 2);
+  co_return a + b;
+}
+}  // namespace
+
+TEST_F(TaskTest, FramesFromMemoryResource) {
+  CountingResource upstream;
+  {
+    std::pmr::monotonic_buffer_resource arena {&upstream};
+    auto task = arenaRoot(std::allocator_arg, &arena);
+    task.resume();
+    ASSERT_TRUE(task.is_ready());
+    EXPECT_EQ(task.promise().result(), 3);
+
+    // All three frames fit into the arena's first buffer.
+    EXPECT_EQ(upstream.allocations_, 1);
+  }
+  EXPECT_EQ(upstream.deallocations_, upstream.allocations_);
+}
+
+TEST_F(TaskTest, FramesFromAllocator) {
+  int live = 0;
+  {
+    auto task = [](std::allocator_arg_t, CountingAllocator<int> allocator, int value) -> coro::Task<int> {
+      co_return value * 2;
+    }(std::allocator_arg, CountingAllocator<int> {live}, 21);
+    EXPECT_EQ(live, 1);
+
+    task.resume();
+    EXPECT_EQ(task.promise().result(), 42);
+  }
+  EXPECT_EQ(live, 0);
 }
 
 TEST_F(TaskTest, TaskDestructor) {
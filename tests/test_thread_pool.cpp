@@ -0,0 +1,662 @@
+#include <coro/thread_pool.hpp>
+#include <coro/sync_wait.hpp>
+#include <coro/detail/cpu_topology.hpp>
+#include <coro/detail/intrusive_queue.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <latch>
+#include <memory_resource>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+class ThreadPoolTest : public ::testing::TestWithParam<coro::ThreadPool::SchedulePolicy> {
+protected:
+  auto makePool(uint32_t threadCount) -> std::shared_ptr<coro::ThreadPool> {
+    return coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = threadCount, .policy_ = GetParam()});
+  }
+};
+
+TEST(CpuTopologyTest, ParseCpuList) {
+  using coro::detail::CpuTopology;
+  EXPECT_EQ(CpuTopology::parseCpuList("0-3,8,10-11\n"), (std::vector<uint32_t> {0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(CpuTopology::parseCpuList("5"), (std::vector<uint32_t> {5}));
+  EXPECT_EQ(CpuTopology::parseCpuList("1,x,3-2,4-,6"), (std::vector<uint32_t> {1, 6}));
+  EXPECT_TRUE(CpuTopology::parseCpuList("").empty());
+  EXPECT_EQ(CpuTopology::parseCpuList("4294967294-4294967295,2,4294967295,1-100000"), (std::vector<uint32_t> {2}));
+}
+
+TEST(CpuTopologyTest, DetectFindsTheCallingCpu) {
+  auto topology = coro::detail::CpuTopology::detect();
+  ASSERT_FALSE(topology.nodes_.empty());
+  for (const auto &cpus : topology.nodes_) { EXPECT_FALSE(cpus.empty()); }
+
+  auto cpu = coro::detail::currentCpu();
+  ASSERT_GE(cpu, 0);
+  EXPECT_LT(topology.nodeOf(static_cast<uint32_t>(cpu)), topology.nodes_.size());
+  EXPECT_EQ(topology.nodeOf(~0u), topology.nodes_.size());
+}
+
+TEST(IntrusiveQueueTest, FifoThroughTheNodes) {
+  coro::detail::IntrusiveQueue<coro::detail::ReadyNode> queue {};
+  std::array<coro::detail::ReadyNode, 3> nodes {};
+  EXPECT_EQ(queue.pop_front(), nullptr);
+
+  for (auto &node : nodes) { queue.push_back(node); }
+  EXPECT_EQ(queue.size(), 3);
+  EXPECT_EQ(queue.pop_front(), &nodes[0]);
+  queue.push_back(nodes[0]);
+  EXPECT_EQ(queue.pop_front(), &nodes[1]);
+  EXPECT_EQ(queue.pop_front(), &nodes[2]);
+  EXPECT_EQ(queue.pop_front(), &nodes[0]);
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.size(), 0);
+}
+
+TEST_P(ThreadPoolTest, SpawnRunsTask) {
+  auto tp = makePool(2);
+
+  std::latch done {1};
+  auto task = [](std::latch &done) -> coro::Task<void> {
+    done.count_down();
+    co_return;
+  };
+
+  ASSERT_TRUE(tp->spawn(task(done)));
+  done.wait();
+  tp->shutdown();
+  EXPECT_TRUE(tp->empty());
+}
+
+TEST_P(ThreadPoolTest, ScheduleMovesToExecutorThread) {
+  auto tp = makePool(2);
+
+  std::atomic<std::thread::id> ranOn {};
+  std::latch done {1};
+  auto task = [](coro::ThreadPool &tp, std::atomic<std::thread::id> &ranOn, std::latch &done) -> coro::Task<void> {
+    co_await tp.schedule();
+    ranOn = std::this_thread::get_id();
+    done.count_down();
+  }(*tp, ranOn, done);
+
+  task.resume();
+  done.wait();
+  tp->shutdown();
+  EXPECT_NE(ranOn.load(), std::this_thread::get_id());
+}
+
+TEST_P(ThreadPoolTest, ManyYieldingTasksComplete) {
+  constexpr std::size_t taskCount  = 1000;
+  constexpr std::size_t yieldCount = 10;
+  auto tp                          = makePool(4);
+
+  std::atomic<std::size_t> counter {0};
+  std::latch done {taskCount};
+  auto task = [](coro::ThreadPool &tp, std::atomic<std::size_t> &counter, std::latch &done) -> coro::Task<void> {
+    for (std::size_t i = 0; i < yieldCount; ++i) {
+      co_await tp.yield();
+      counter.fetch_add(1, std::memory_order::relaxed);
+    }
+    done.count_down();
+  };
+
+  for (std::size_t i = 0; i < taskCount; ++i) { ASSERT_TRUE(tp->spawn(task(*tp, counter, done))); }
+  done.wait();
+  EXPECT_EQ(counter.load(), taskCount * yieldCount);
+}
+
+TEST_P(ThreadPoolTest, NestedSpawnsFromExecutorThreads) {
+  constexpr std::size_t fanOut = 64;
+  auto tp                      = makePool(4);
+
+  std::latch done {fanOut * fanOut};
+  std::mutex threadsMutex;
+  std::set<std::thread::id> threads;
+
+  auto leaf = [](std::latch &done, std::mutex &threadsMutex, std::set<std::thread::id> &threads) -> coro::Task<void> {
+    {
+      std::scoped_lock lk {threadsMutex};
+      threads.insert(std::this_thread::get_id());
+    }
+    std::this_thread::sleep_for(100us);
+    done.count_down();
+    co_return;
+  };
+  auto parent = [&](coro::ThreadPool &tp) -> coro::Task<void> {
+    for (std::size_t i = 0; i < fanOut; ++i) { tp.spawn(leaf(done, threadsMutex, threads)); }
+    co_return;
+  };
+
+  for (std::size_t i = 0; i < fanOut; ++i) { ASSERT_TRUE(tp->spawn(parent(*tp))); }
+  done.wait();
+  tp->shutdown();
+  EXPECT_TRUE(tp->empty());
+  EXPECT_GE(threads.size(), 1);
+}
+
+TEST_P(ThreadPoolTest, ResumeRangeSchedulesAllHandles) {
+  constexpr std::size_t taskCount = 100;
+  auto tp                         = makePool(3);
+
+  std::atomic<std::size_t> counter {0};
+  std::latch done {taskCount};
+  auto task = [](std::atomic<std::size_t> &counter, std::latch &done) -> coro::Task<void> {
+    counter.fetch_add(1, std::memory_order::relaxed);
+    done.count_down();
+    co_return;
+  };
+
+  std::vector<coro::Task<void>> tasks;
+  std::vector<std::coroutine_handle<>> handles;
+  for (std::size_t i = 0; i < taskCount; ++i) {
+    handles.emplace_back(tasks.emplace_back(task(counter, done)).handle());
+  }
+  handles.emplace_back(nullptr);
+
+  EXPECT_EQ(tp->resume(handles), taskCount);
+  done.wait();
+  tp->shutdown();
+  EXPECT_EQ(counter.load(), taskCount);
+}
+
+TEST_P(ThreadPoolTest, SpawnRangeRunsAllTasks) {
+  constexpr std::size_t taskCount = 1000;
+  auto tp                         = makePool(3);
+
+  std::atomic<std::size_t> counter {0};
+  std::latch done {taskCount};
+  auto task = [](std::atomic<std::size_t> &counter, std::latch &done) -> coro::Task<void> {
+    counter.fetch_add(1, std::memory_order::relaxed);
+    done.count_down();
+    co_return;
+  };
+
+  std::vector<coro::Task<void>> tasks {};
+  for (std::size_t i = 0; i < taskCount; ++i) { tasks.emplace_back(task(counter, done)); }
+
+  EXPECT_EQ(tp->spawn(tasks), taskCount);
+  done.wait();
+  tp->shutdown();
+  EXPECT_EQ(counter.load(), taskCount);
+  EXPECT_TRUE(tp->empty());
+  EXPECT_EQ(tp->spawn(std::vector<coro::Task<void>> {}), 0);
+}
+
+TEST_P(ThreadPoolTest, BatchesRespectFullSubmissionQueue) {
+  auto tp = coro::ThreadPool::makeShared(
+      coro::ThreadPool::Options {.threadCount_ = 1, .policy_ = GetParam(), .submissionQueueCapacity_ = 4});
+
+  std::latch started {1};
+  std::latch gate {1};
+  auto blocker = [](std::latch &started, std::latch &gate) -> coro::Task<void> {
+    started.count_down();
+    gate.wait();
+    co_return;
+  };
+  std::atomic<std::size_t> counter {0};
+  auto task = [](std::atomic<std::size_t> &counter) -> coro::Task<void> {
+    counter.fetch_add(1, std::memory_order::relaxed);
+    co_return;
+  };
+
+  ASSERT_TRUE(tp->spawn(blocker(started, gate)));
+  started.wait();
+
+  std::vector<coro::Task<void>> resumed {};
+  std::vector<std::coroutine_handle<>> handles {};
+  for (std::size_t i = 0; i < 3; ++i) { handles.emplace_back(resumed.emplace_back(task(counter)).handle()); }
+  EXPECT_EQ(tp->resume(handles), 3);
+
+  std::vector<coro::Task<void>> spawned {};
+  for (std::size_t i = 0; i < 3; ++i) { spawned.emplace_back(task(counter)); }
+  EXPECT_EQ(tp->spawn(spawned), 1);
+  EXPECT_EQ(tp->queue_size(), 4);
+
+  gate.count_down();
+  tp->shutdown();
+  EXPECT_EQ(counter.load(), 4);
+  EXPECT_TRUE(tp->empty());
+}
+
+TEST_P(ThreadPoolTest, ExecutorBatchesOverflowFullQueue) {
+  constexpr std::size_t taskCount = 600;
+  auto tp                         = coro::ThreadPool::makeShared(
+      coro::ThreadPool::Options {.threadCount_ = 2, .policy_ = GetParam(), .submissionQueueCapacity_ = 8});
+
+  std::atomic<std::size_t> counter {0};
+  std::latch done {taskCount};
+  auto leaf   = [](std::atomic<std::size_t> &counter, std::latch &done) -> coro::Task<void> {
+    counter.fetch_add(1, std::memory_order::relaxed);
+    done.count_down();
+    co_return;
+  };
+  auto parent = [&](coro::ThreadPool &tp) -> coro::Task<void> {
+    std::vector<coro::Task<void>> tasks {};
+    for (std::size_t i = 0; i < taskCount; ++i) { tasks.emplace_back(leaf(counter, done)); }
+    EXPECT_EQ(tp.spawn(tasks), taskCount);
+    co_return;
+  };
+
+  ASSERT_TRUE(tp->spawn(parent(*tp)));
+  done.wait();
+  tp->shutdown();
+  EXPECT_EQ(counter.load(), taskCount);
+  EXPECT_TRUE(tp->empty());
+}
+
+TEST_P(ThreadPoolTest, ShutdownCompletesQueuedTasks) {
+  constexpr std::size_t taskCount = 200;
+  auto tp                         = makePool(2);
+
+  std::atomic<std::size_t> counter {0};
+  auto task = [](std::atomic<std::size_t> &counter) -> coro::Task<void> {
+    counter.fetch_add(1, std::memory_order::relaxed);
+    co_return;
+  };
+
+  for (std::size_t i = 0; i < taskCount; ++i) { ASSERT_TRUE(tp->spawn(task(counter))); }
+  tp->shutdown();
+
+  EXPECT_EQ(counter.load(), taskCount);
+  EXPECT_TRUE(tp->empty());
+  EXPECT_FALSE(tp->spawn(task(counter)));
+  EXPECT_THROW(static_cast<void>(tp->schedule()), std::runtime_error);
+}
+
+TEST_P(ThreadPoolTest, FullSubmissionQueueRejectsExternalSubmissions) {
+  auto tp = coro::ThreadPool::makeShared(
+      coro::ThreadPool::Options {.threadCount_ = 1, .policy_ = GetParam(), .submissionQueueCapacity_ = 2});
+
+  std::latch started {1};
+  std::latch gate {1};
+  auto blocker = [](std::latch &started, std::latch &gate) -> coro::Task<void> {
+    started.count_down();
+    gate.wait();
+    co_return;
+  };
+  auto noop = []() -> coro::Task<void> { co_return; };
+
+  ASSERT_TRUE(tp->spawn(blocker(started, gate)));
+  started.wait();
+
+  EXPECT_TRUE(tp->spawn(noop()));
+  EXPECT_TRUE(tp->spawn(noop()));
+  EXPECT_FALSE(tp->spawn(noop()));
+  EXPECT_EQ(tp->queue_size(), 2);
+
+  auto scheduled = [](coro::ThreadPool &tp) -> coro::Task<void> { co_await tp.schedule(); }(*tp);
+  scheduled.resume();
+  ASSERT_TRUE(scheduled.is_ready());
+  EXPECT_THROW(scheduled.promise().result(), std::runtime_error);
+
+  gate.count_down();
+  tp->shutdown();
+  EXPECT_TRUE(tp->empty());
+}
+
+TEST_P(ThreadPoolTest, ExecutorSubmissionsOverflowFullQueue) {
+  constexpr std::size_t taskCount = 100;
+  auto tp                         = coro::ThreadPool::makeShared(coro::ThreadPool::Options {
+                              .threadCount_ = 2, .policy_ = GetParam(), .localQueueCapacity_ = 4, .submissionQueueCapacity_ = 4});
+
+  std::latch done {taskCount};
+  auto leaf   = [](std::latch &done) -> coro::Task<void> {
+    done.count_down();
+    co_return;
+  };
+  auto parent = [&](coro::ThreadPool &tp) -> coro::Task<void> {
+    for (std::size_t i = 0; i < taskCount; ++i) { EXPECT_TRUE(tp.spawn(leaf(done))); }
+    co_return;
+  };
+
+  ASSERT_TRUE(tp->spawn(parent(*tp)));
+  done.wait();
+  tp->shutdown();
+  EXPECT_TRUE(tp->empty());
+}
+
+TEST_P(ThreadPoolTest, ExecutorYieldsOverflowFullQueue) {
+  constexpr std::size_t taskCount = 200;
+  auto tp                         = coro::ThreadPool::makeShared(coro::ThreadPool::Options {
+                              .threadCount_ = 2, .policy_ = GetParam(), .localQueueCapacity_ = 2, .submissionQueueCapacity_ = 2});
+
+  std::atomic<std::size_t> counter {0};
+  std::latch done {taskCount};
+  auto leaf   = [](coro::ThreadPool &tp, std::atomic<std::size_t> &counter, std::latch &done) -> coro::Task<void> {
+    using Priority = coro::ThreadPool::Priority;
+    for (int i = 0; i < 5; ++i) { co_await tp.yield(i % 2 == 0 ? Priority::Low : Priority::Normal); }
+    counter.fetch_add(1, std::memory_order::relaxed);
+    done.count_down();
+  };
+  auto parent = [&](coro::ThreadPool &tp) -> coro::Task<void> {
+    for (std::size_t i = 0; i < taskCount; ++i) { EXPECT_TRUE(tp.spawn(leaf(tp, counter, done))); }
+    co_return;
+  };
+
+  ASSERT_TRUE(tp->spawn(parent(*tp)));
+  done.wait();
+  tp->shutdown();
+  EXPECT_EQ(counter.load(), taskCount);
+  EXPECT_TRUE(tp->empty());
+}
+
+TEST_P(ThreadPoolTest, IdleStrategiesDoNotLoseWakeups) {
+  constexpr std::size_t rounds = 200;
+
+  for (auto [spins, yields] : {std::pair {0u, 0u}, std::pair {0u, 4u}, std::pair {4096u, 0u}}) {
+    auto tp = coro::ThreadPool::makeShared(coro::ThreadPool::Options {
+        .threadCount_ = 3, .policy_ = GetParam(), .idleSpinCount_ = spins, .idleYieldCount_ = yields});
+
+    // Each round is submitted from outside once the pool went idle again, so every round has to
+    // either be picked up by a spinning executor or wake a parked one.
+    for (std::size_t i = 0; i < rounds; ++i) {
+      std::latch done {1};
+      auto task = [](std::latch &done) -> coro::Task<void> {
+        done.count_down();
+        co_return;
+      };
+      ASSERT_TRUE(tp->spawn(task(done)));
+      done.wait();
+    }
+
+    tp->shutdown();
+    EXPECT_TRUE(tp->empty());
+  }
+}
+
+TEST_P(ThreadPoolTest, SpawnWithAllocator) {
+  constexpr std::size_t taskCount = 16;
+  auto tp                         = makePool(2);
+
+  std::pmr::synchronized_pool_resource arena;
+  std::latch done {taskCount};
+  auto task = [](std::allocator_arg_t, std::pmr::polymorphic_allocator<>, std::latch &done) -> coro::Task<void> {
+    done.count_down();
+    co_return;
+  };
+
+  for (std::size_t i = 0; i < taskCount; ++i) {
+    ASSERT_TRUE(tp->spawn(std::allocator_arg, &arena, task(std::allocator_arg, &arena, done)));
+  }
+  done.wait();
+  tp->shutdown();
+  EXPECT_TRUE(tp->empty());
+}
+
+TEST_P(ThreadPoolTest, HigherPriorityRunsFirst) {
+  using Priority = coro::ThreadPool::Priority;
+  auto tp        = coro::ThreadPool::makeShared(
+      coro::ThreadPool::Options {.threadCount_ = 1, .policy_ = GetParam(), .agingInterval_ = 0});
+
+  std::latch started {1};
+  std::latch gate {1};
+  auto blocker = [](std::latch &started, std::latch &gate) -> coro::Task<void> {
+    started.count_down();
+    gate.wait();
+    co_return;
+  };
+  std::vector<Priority> order {};
+  auto record = [](std::vector<Priority> &order, Priority priority) -> coro::Task<void> {
+    order.emplace_back(priority);
+    co_return;
+  };
+
+  ASSERT_TRUE(tp->spawn(blocker(started, gate)));
+  started.wait();
+
+  // Only touched by the single executor once the gate opens.
+  for (auto priority : {Priority::Low, Priority::Normal, Priority::High, Priority::Normal, Priority::High}) {
+    ASSERT_TRUE(tp->spawn(record(order, priority), priority));
+  }
+  EXPECT_EQ(tp->queue_size(), 5);
+  EXPECT_EQ(tp->queue_size(Priority::High), 2);
+  EXPECT_EQ(tp->queue_size(Priority::Normal), 2);
+  EXPECT_EQ(tp->queue_size(Priority::Low), 1);
+
+  gate.count_down();
+  tp->shutdown();
+  EXPECT_EQ(order,
+      (std::vector<Priority> {Priority::High, Priority::High, Priority::Normal, Priority::Normal, Priority::Low}));
+  EXPECT_EQ(tp->queue_size(Priority::High), 0);
+  EXPECT_EQ(tp->queue_size(Priority::Low), 0);
+}
+
+TEST_P(ThreadPoolTest, AgingServesLowerPriorities) {
+  using Priority                  = coro::ThreadPool::Priority;
+  constexpr std::size_t highCount = 64;
+  auto tp                         = coro::ThreadPool::makeShared(
+      coro::ThreadPool::Options {.threadCount_ = 1, .policy_ = GetParam(), .agingInterval_ = 4});
+
+  std::latch started {1};
+  std::latch gate {1};
+  auto blocker = [](std::latch &started, std::latch &gate) -> coro::Task<void> {
+    started.count_down();
+    gate.wait();
+    co_return;
+  };
+  std::size_t highsBeforeLow {0};
+  std::size_t highsRun {0};
+  auto high = [](std::size_t &highsRun) -> coro::Task<void> {
+    ++highsRun;
+    co_return;
+  };
+  auto low = [](std::size_t &highsRun, std::size_t &highsBeforeLow) -> coro::Task<void> {
+    highsBeforeLow = highsRun;
+    co_return;
+  };
+
+  ASSERT_TRUE(tp->spawn(blocker(started, gate)));
+  started.wait();
+  ASSERT_TRUE(tp->spawn(low(highsRun, highsBeforeLow), Priority::Low));
+  for (std::size_t i = 0; i < highCount; ++i) { ASSERT_TRUE(tp->spawn(high(highsRun), Priority::High)); }
+
+  gate.count_down();
+  tp->shutdown();
+  EXPECT_EQ(highsRun, highCount);
+  EXPECT_LT(highsBeforeLow, 4);
+}
+
+TEST_P(ThreadPoolTest, SchedulePriorities) {
+  using Priority                  = coro::ThreadPool::Priority;
+  constexpr std::size_t taskCount = 300;
+  auto tp                         = makePool(4);
+
+  std::atomic<std::size_t> counter {0};
+  std::latch done {taskCount};
+  auto task = [](coro::ThreadPool &tp, Priority priority, std::atomic<std::size_t> &counter,
+                  std::latch &done) -> coro::Task<void> {
+    co_await tp.schedule(priority);
+    co_await tp.yield(priority);
+    counter++;
+    done.count_down();
+  };
+
+  std::vector<coro::Task<void>> tasks {};
+  for (std::size_t i = 0; i < taskCount; ++i) {
+    tasks.emplace_back(task(*tp, static_cast<Priority>(i % coro::ThreadPool::priorityCount), counter, done));
+  }
+  for (auto &t : tasks) { t.resume(); }
+  done.wait();
+  tp->shutdown();
+  EXPECT_EQ(counter.load(), taskCount);
+  EXPECT_TRUE(tp->empty());
+}
+
+TEST_P(ThreadPoolTest, NextSlotRunsBeforeTheQueue) {
+  for (uint32_t budget : {0u, 3u}) {
+    auto tp = coro::ThreadPool::makeShared(
+        coro::ThreadPool::Options {.threadCount_ = 1, .policy_ = GetParam(), .nextSlotBudget_ = budget});
+
+    std::latch started {1};
+    std::latch gate {1};
+    auto blocker = [](std::latch &started, std::latch &gate) -> coro::Task<void> {
+      started.count_down();
+      gate.wait();
+      co_return;
+    };
+    std::vector<int> order {};
+    std::latch done {2};
+    auto local = [](coro::ThreadPool &tp, std::vector<int> &order, std::latch &done) -> coro::Task<void> {
+      for (int i = 1; i <= 5; ++i) {
+        co_await tp.schedule_local();
+        order.emplace_back(i);
+      }
+      done.count_down();
+    };
+    auto queued = [](std::vector<int> &order, std::latch &done) -> coro::Task<void> {
+      order.emplace_back(0);
+      done.count_down();
+      co_return;
+    };
+
+    ASSERT_TRUE(tp->spawn(blocker(started, gate)));
+    started.wait();
+    ASSERT_TRUE(tp->spawn(local(*tp, order, done)));
+    ASSERT_TRUE(tp->spawn(queued(order, done)));
+
+    gate.count_down();
+    done.wait();
+    tp->shutdown();
+    // The queued task gets its turn once the budget ran out, without the slot work stealing executors
+    // still serve their local queue before the shared one.
+    auto expected = budget != 0                                           ? std::vector<int> {1, 2, 3, 0, 4, 5}
+                    : GetParam() == coro::ThreadPool::SchedulePolicy::Fifo ? std::vector<int> {0, 1, 2, 3, 4, 5}
+                                                                           : std::vector<int> {1, 2, 3, 4, 5, 0};
+    EXPECT_EQ(order, expected) << "budget " << budget;
+    EXPECT_TRUE(tp->empty());
+  }
+}
+
+TEST_P(ThreadPoolTest, ScheduleLocalAndResumeComplete) {
+  constexpr std::size_t taskCount = 200;
+  auto tp                         = makePool(4);
+
+  std::atomic<std::size_t> counter {0};
+  std::latch done {taskCount};
+  auto task = [](coro::ThreadPool &tp, std::atomic<std::size_t> &counter, std::latch &done) -> coro::Task<void> {
+    co_await tp.schedule();
+    for (int i = 0; i < 10; ++i) { co_await tp.schedule_local(); }
+    counter++;
+    done.count_down();
+  };
+  // Resumed from an executor, the tasks displace each other from its next slot.
+  auto resumer = [](coro::ThreadPool &tp, std::vector<coro::Task<void>> &tasks) -> coro::Task<void> {
+    co_await tp.schedule();
+    for (auto &t : tasks) { EXPECT_TRUE(tp.resume(t.handle())); }
+  };
+
+  std::vector<coro::Task<void>> tasks {};
+  for (std::size_t i = 0; i < taskCount; ++i) { tasks.emplace_back(task(*tp, counter, done)); }
+  coro::sync_wait(resumer(*tp, tasks));
+  done.wait();
+  tp->shutdown();
+  EXPECT_EQ(counter.load(), taskCount);
+  EXPECT_TRUE(tp->empty());
+}
+
+TEST_P(ThreadPoolTest, PinnedExecutorsRunOnTheirCpu) {
+  using AffinityPolicy = coro::ThreadPool::AffinityPolicy;
+  auto cpu             = static_cast<uint32_t>(coro::detail::CpuTopology::detect().nodes_.front().front());
+
+  for (auto options : {coro::ThreadPool::Options {.threadCount_ = 2, .policy_ = GetParam(), .cpus_ = {cpu}},
+           coro::ThreadPool::Options {.threadCount_ = 2, .policy_ = GetParam(), .affinity_ = AffinityPolicy::Compact,
+               .nodeCpus_ = {{cpu}}}}) {
+    auto tp = coro::ThreadPool::makeShared(std::move(options));
+
+    std::atomic<int> ranOn {-1};
+    auto task = [](coro::ThreadPool &tp, std::atomic<int> &ranOn) -> coro::Task<void> {
+      co_await tp.schedule();
+      ranOn = coro::detail::currentCpu();
+    };
+    coro::sync_wait(task(*tp, ranOn));
+    tp->shutdown();
+    EXPECT_EQ(ranOn.load(), static_cast<int>(cpu));
+  }
+}
+
+TEST_P(ThreadPoolTest, NumaAwareNodesShareWork) {
+  using AffinityPolicy            = coro::ThreadPool::AffinityPolicy;
+  constexpr std::size_t taskCount = 2000;
+  auto cpu = static_cast<uint32_t>(coro::detail::CpuTopology::detect().nodes_.front().front());
+
+  for (auto affinity : {AffinityPolicy::Compact, AffinityPolicy::Scatter}) {
+    // Two fake nodes on the same cpu, every node gets executors and its own queues.
+    auto tp = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 4,
+        .policy_                                                               = GetParam(),
+        .affinity_                                                             = affinity,
+        .numaAware_                                                            = true,
+        .nodeCpus_                                                             = {{cpu}, {cpu}}});
+
+    std::atomic<std::size_t> counter {0};
+    std::latch done {taskCount};
+    auto task = [](coro::ThreadPool &tp, std::atomic<std::size_t> &counter, std::latch &done) -> coro::Task<void> {
+      co_await tp.yield();
+      counter++;
+      done.count_down();
+    };
+    auto spawner = [](coro::ThreadPool &tp, auto task, std::atomic<std::size_t> &counter,
+                       std::latch &done) -> coro::Task<void> {
+      for (std::size_t i = 0; i < taskCount / 2; ++i) { tp.spawn(task(tp, counter, done)); }
+      co_return;
+    };
+
+    for (std::size_t i = 0; i < taskCount / 2; ++i) { ASSERT_TRUE(tp->spawn(task(*tp, counter, done))); }
+    ASSERT_TRUE(tp->spawn(spawner(*tp, task, counter, done)));
+    done.wait();
+    tp->shutdown();
+    EXPECT_EQ(counter.load(), taskCount);
+    EXPECT_TRUE(tp->empty());
+  }
+}
+
+TEST_P(ThreadPoolTest, MetricsSnapshot) {
+  constexpr std::size_t taskCount = 1000;
+  auto tp                         = makePool(2);
+
+  std::latch done {taskCount};
+  auto task = [](coro::ThreadPool &tp, std::latch &done) -> coro::Task<void> {
+    co_await tp.yield();
+    done.count_down();
+  };
+  for (std::size_t i = 0; i < taskCount; ++i) { ASSERT_TRUE(tp->spawn(task(*tp, done))); }
+  done.wait();
+
+  // Taken while the executors keep running, then once they are gone.
+  auto running = tp->metrics();
+  tp->shutdown();
+  auto metrics = tp->metrics();
+  ASSERT_EQ(running.workers_.size(), 2);
+  ASSERT_EQ(metrics.workers_.size(), 2);
+
+  auto total = metrics.total();
+  if constexpr (!coro::ThreadPool::metricsEnabled) {
+    EXPECT_EQ(total.executed_, 0);
+    EXPECT_EQ(metrics.runTime_.count(), 0);
+    return;
+  }
+
+  // Every task is resumed once from spawn() and once from its yield().
+  EXPECT_EQ(total.executed_, 2 * taskCount);
+  EXPECT_LE(running.total().executed_, total.executed_);
+  EXPECT_EQ(metrics.runTime_.count(), total.executed_);
+  EXPECT_LE(metrics.queueWait_.count(), total.executed_);
+  EXPECT_GT(metrics.queueWait_.count(), 0);
+  EXPECT_GT(total.busy_.count(), 0);
+  EXPECT_GE(total.parks_, total.wakeups_);
+  if (GetParam() == coro::ThreadPool::SchedulePolicy::Fifo) {
+    EXPECT_EQ(total.steals_, 0);
+    EXPECT_EQ(metrics.queueWait_.count(), total.executed_);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Policies, ThreadPoolTest,
+    ::testing::Values(coro::ThreadPool::SchedulePolicy::Fifo, coro::ThreadPool::SchedulePolicy::WorkStealing),
+    [](const auto &info) {
+      return info.param == coro::ThreadPool::SchedulePolicy::Fifo ? std::string {"Fifo"} : std::string {"WorkStealing"};
+    });
@@ -0,0 +1,89 @@
+#include <coro/sync_wait.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/trace.hpp>
+
+#include <cstddef>
+#include <latch>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace {
+auto occurrences(const std::string &text, const std::string &pattern) -> std::size_t {
+  std::size_t count {0};
+  for (auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) { ++count; }
+  return count;
+}
+}  // namespace
+
+TEST(TraceTest, WritesChromeTraceOfThreadPoolWork) {
+  constexpr std::size_t taskCount = 100;
+  // Drops what earlier tests recorded.
+  std::ostringstream earlier {};
+  coro::trace::write_chrome_trace(earlier);
+
+  {
+    auto tp = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 2});
+    std::latch done {taskCount};
+    auto leaf = []() -> coro::Task<int> { co_return 1; };
+    auto task = [](coro::ThreadPool &tp, auto leaf, std::latch &done) -> coro::Task<void> {
+      co_await tp.schedule();
+      co_await leaf();
+      done.count_down();
+    };
+    for (std::size_t i = 0; i < taskCount; ++i) { ASSERT_TRUE(tp->spawn(task(*tp, leaf, done))); }
+    done.wait();
+    tp->shutdown();
+  }
+
+  std::ostringstream out {};
+  auto written = coro::trace::write_chrome_trace(out);
+  auto trace   = out.str();
+  EXPECT_TRUE(trace.starts_with(R"({"displayTimeUnit":"ns","traceEvents":[)"));
+  EXPECT_TRUE(trace.ends_with("}}\n"));
+  if constexpr (!coro::trace::enabled) {
+    EXPECT_EQ(written, 0);
+    return;
+  }
+
+  // Spawned, then rescheduled by the schedule() inside the task, the executors ran both.
+  EXPECT_EQ(occurrences(trace, R"("name":"spawn")"), taskCount);
+  EXPECT_EQ(occurrences(trace, R"("name":"self delete")"), taskCount);
+  EXPECT_EQ(occurrences(trace, R"("name":"schedule")"), 2 * taskCount);
+  EXPECT_EQ(occurrences(trace, R"("name":"resume","ph":"B")"), 2 * taskCount);
+  EXPECT_EQ(occurrences(trace, R"("ph":"E")"), 2 * taskCount);
+  // Awaiting leaf() and the task itself from the wrapper, each continued once they completed.
+  EXPECT_EQ(occurrences(trace, R"("name":"suspend")"), 2 * taskCount);
+  EXPECT_EQ(occurrences(trace, R"("name":"continuation")"), 2 * taskCount);
+  // An executor that recorded nothing is freed, name included, as soon as it exits.
+  auto named = occurrences(trace, R"("args":{"name":"coro::ThreadPool executor )");
+  EXPECT_GE(named, 1);
+  EXPECT_LE(named, 2);
+
+  // Consumed by the flush.
+  std::ostringstream again {};
+  EXPECT_EQ(coro::trace::write_chrome_trace(again), 0);
+}
+
+#if defined(CORO_TRACING)
+TEST(TraceTest, KeepsTheEventsOfABoundedNumberOfExitedThreads) {
+  constexpr auto kept = coro::detail::TraceBuffer::maxRetired_;
+  std::ostringstream earlier {};
+  coro::trace::write_chrome_trace(earlier);
+
+  // Nothing left to flush, the buffer is freed as the thread exits.
+  std::thread {[]() { coro::trace::set_thread_name("idle"); }}.join();
+  for (std::size_t i = 0; i < kept + 4; ++i) {
+    std::thread {[]() { coro::detail::trace(coro::detail::TraceEvent::Spawn, nullptr); }}.join();
+  }
+
+  std::ostringstream out {};
+  EXPECT_EQ(coro::trace::write_chrome_trace(out), kept);
+  auto trace = out.str();
+  EXPECT_EQ(occurrences(trace, "idle"), 0);
+  EXPECT_TRUE(trace.ends_with(R"("lostEvents":4}})" "\n"));
+}
+#endif
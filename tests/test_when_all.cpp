@@ -0,0 +1,140 @@
+#include <coro/sync_wait.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/when_all.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(WhenAllTest, TupleOfMixedResults) {
+  auto make_int    = []() -> coro::Task<int> { co_return 1; };
+  auto make_string = []() -> coro::Task<std::string> { co_return "two"; };
+  auto make_void   = []() -> coro::Task<void> { co_return; };
+
+  auto [i, s, v] = coro::sync_wait(coro::when_all(make_int(), make_string(), make_void()));
+  EXPECT_EQ(i, 1);
+  EXPECT_EQ(s, "two");
+  EXPECT_EQ(v, std::monostate {});
+}
+
+TEST(WhenAllTest, EmptyTupleAndRange) {
+  coro::sync_wait(coro::when_all());
+  auto results = coro::sync_wait(coro::when_all(std::vector<coro::Task<int>> {}));
+  EXPECT_TRUE(results.empty());
+}
+
+TEST(WhenAllTest, RangeKeepsOrder) {
+  auto make_task = [](int i) -> coro::Task<int> { co_return i * 2; };
+
+  std::vector<coro::Task<int>> tasks {};
+  for (int i = 0; i < 100; ++i) { tasks.emplace_back(make_task(i)); }
+
+  auto results = coro::sync_wait(coro::when_all(std::move(tasks)));
+  ASSERT_EQ(results.size(), 100);
+  for (int i = 0; i < 100; ++i) { EXPECT_EQ(results[i], i * 2); }
+}
+
+TEST(WhenAllTest, RangeOfReferencesAndVoid) {
+  int values[3] {1, 2, 3};
+  auto make_ref = [](int &value) -> coro::Task<int &> { co_return value; };
+
+  std::list<coro::Task<int &>> refs {};
+  for (auto &value : values) { refs.emplace_back(make_ref(value)); }
+  auto results = coro::sync_wait(coro::when_all(refs));
+  ASSERT_EQ(results.size(), 3);
+  for (std::size_t i = 0; i < 3; ++i) { EXPECT_EQ(std::addressof(results[i].get()), &values[i]); }
+
+  int counter {0};
+  auto make_void = [&counter]() -> coro::Task<void> {
+    ++counter;
+    co_return;
+  };
+  std::vector<coro::Task<void>> voids {};
+  for (int i = 0; i < 5; ++i) { voids.emplace_back(make_void()); }
+  coro::sync_wait(coro::when_all(std::move(voids)));
+  EXPECT_EQ(counter, 5);
+}
+
+TEST(WhenAllTest, RethrowsAfterAllChildrenCompleted) {
+  std::atomic<int> completed {0};
+  auto make_task = [&completed](bool fail) -> coro::Task<int> {
+    completed++;
+    if (fail) { throw std::runtime_error("boom"); }
+    co_return 1;
+  };
+
+  EXPECT_THROW(coro::sync_wait(coro::when_all(make_task(false), make_task(true), make_task(false))),
+      std::runtime_error);
+  EXPECT_EQ(completed, 3);
+}
+
+TEST(WhenAllTest, ChildrenScheduleThemselvesOntoThreadPool) {
+  auto tp        = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 4});
+  auto make_task = [&tp](int i) -> coro::Task<int> {
+    co_await tp->schedule();
+    co_return i;
+  };
+
+  std::vector<coro::Task<int>> tasks {};
+  for (int i = 0; i < 1000; ++i) { tasks.emplace_back(make_task(i)); }
+  auto results = coro::sync_wait(coro::when_all(std::move(tasks)));
+
+  ASSERT_EQ(results.size(), 1000);
+  for (int i = 0; i < 1000; ++i) { EXPECT_EQ(results[i], i); }
+  tp->shutdown();
+}
+
+TEST(WhenAllTest, BatchedOnThreadPool) {
+  auto tp = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 4});
+  auto caller    = std::this_thread::get_id();
+  auto make_task = [caller](int i) -> coro::Task<int> {
+    EXPECT_NE(std::this_thread::get_id(), caller);
+    co_return i;
+  };
+
+  std::vector<coro::Task<int>> tasks {};
+  for (int i = 0; i < 1000; ++i) { tasks.emplace_back(make_task(i)); }
+  auto results = coro::sync_wait(coro::when_all(*tp, std::move(tasks)));
+  ASSERT_EQ(results.size(), 1000);
+  for (int i = 0; i < 1000; ++i) { EXPECT_EQ(results[i], i); }
+
+  auto [a, b] = coro::sync_wait(coro::when_all(*tp, make_task(1), make_task(2)));
+  EXPECT_EQ(a + b, 3);
+  tp->shutdown();
+}
+
+TEST(WhenAllTest, RejectedChildrenRunInline) {
+  auto tp        = coro::ThreadPool::makeShared(coro::ThreadPool::Options {
+             .threadCount_ = 1, .submissionQueueCapacity_ = 8});
+  auto make_task = [](int i) -> coro::Task<int> { co_return i; };
+
+  std::vector<coro::Task<int>> tasks {};
+  for (int i = 0; i < 100; ++i) { tasks.emplace_back(make_task(i)); }
+  auto results = coro::sync_wait(coro::when_all(*tp, std::move(tasks)));
+  ASSERT_EQ(results.size(), 100);
+  for (int i = 0; i < 100; ++i) { EXPECT_EQ(results[i], i); }
+  tp->shutdown();
+}
+
+TEST(WhenAllTest, ChildrenInheritStopToken) {
+  auto child  = []() -> coro::Task<bool> { co_return co_await coro::this_task::stop_requested(); };
+  auto parent = [&child]() -> coro::Task<int> {
+    std::vector<coro::Task<bool>> tasks {};
+    for (int i = 0; i < 3; ++i) { tasks.emplace_back(child()); }
+    auto results = co_await coro::when_all(std::move(tasks));
+    auto [single] = co_await coro::when_all(child());
+    co_return static_cast<int>(std::ranges::count(results, true)) + (single ? 1 : 0);
+  };
+
+  std::stop_source stopSource {};
+  stopSource.request_stop();
+  auto task = parent();
+  task.promise().stop_token(stopSource.get_token());
+  EXPECT_EQ(coro::sync_wait(task), 4);
+}
@@ -0,0 +1,116 @@
+#include <coro/sync_wait.hpp>
+#include <coro/task.hpp>
+#include <coro/thread_pool.hpp>
+#include <coro/when_any.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <stop_token>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(WhenAnyTest, FirstToCompleteWinsAndStopsTheRest) {
+  auto tp = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 4});
+  std::stop_source stopSource {};
+  std::atomic<int> stopped {0};
+
+  auto make_task = [&](int value, std::stop_token token, bool slow) -> coro::Task<int> {
+    if (slow) {
+      while (!token.stop_requested()) { co_await tp->yield(); }
+      stopped++;
+    }
+    co_return value;
+  };
+
+  auto [index, value] = coro::sync_wait(coro::when_any(*tp, stopSource, make_task(1, stopSource.get_token(), true),
+      make_task(2, stopSource.get_token(), false), make_task(3, stopSource.get_token(), true)));
+  EXPECT_EQ(index, 1);
+  EXPECT_EQ(value, 2);
+  EXPECT_TRUE(stopSource.stop_requested());
+
+  tp->shutdown();
+  EXPECT_EQ(stopped, 2);
+}
+
+TEST(WhenAnyTest, RangeOfVoidTasks) {
+  auto tp = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 2});
+  std::stop_source stopSource {};
+
+  auto make_task = [&tp](std::stop_token token, bool winner) -> coro::Task<void> {
+    if (!winner) {
+      while (!token.stop_requested()) { co_await tp->yield(); }
+    }
+    co_return;
+  };
+
+  std::vector<coro::Task<void>> tasks {};
+  for (int i = 0; i < 4; ++i) { tasks.emplace_back(make_task(stopSource.get_token(), i == 2)); }
+  EXPECT_EQ(coro::sync_wait(coro::when_any(*tp, stopSource, std::move(tasks))), 2);
+  tp->shutdown();
+}
+
+TEST(WhenAnyTest, RethrowsWinnersException) {
+  auto tp = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 2});
+  std::stop_source stopSource {};
+
+  auto make_task = [&tp](std::stop_token token, bool fail) -> coro::Task<int> {
+    if (fail) { throw std::runtime_error("boom"); }
+    while (!token.stop_requested()) { co_await tp->yield(); }
+    co_return 0;
+  };
+
+  EXPECT_THROW(coro::sync_wait(coro::when_any(
+                   *tp, stopSource, make_task(stopSource.get_token(), false), make_task(stopSource.get_token(), true))),
+      std::runtime_error);
+  tp->shutdown();
+}
+
+TEST(WhenAnyTest, ManyRacesHaveExactlyOneWinner) {
+  auto tp = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 4});
+  auto make_task = [](int i) -> coro::Task<int> { co_return i; };
+
+  for (int round = 0; round < 200; ++round) {
+    std::vector<coro::Task<int>> tasks {};
+    for (int i = 0; i < 8; ++i) { tasks.emplace_back(make_task(i)); }
+    auto [index, value] = coro::sync_wait(coro::when_any(*tp, std::stop_source {}, std::move(tasks)));
+    EXPECT_EQ(static_cast<int>(index), value);
+  }
+  tp->shutdown();
+}
+
+TEST(WhenAnyTest, FailsWhenNothingCanBeSpawned) {
+  auto tp = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 1});
+  tp->shutdown();
+  auto make_task = []() -> coro::Task<int> { co_return 1; };
+  EXPECT_THROW(coro::sync_wait(coro::when_any(*tp, std::stop_source {}, make_task())), std::runtime_error);
+
+  std::vector<coro::Task<int>> none {};
+  EXPECT_THROW(coro::sync_wait(coro::when_any(*tp, std::stop_source {}, std::move(none))), std::invalid_argument);
+}
+
+TEST(WhenAnyTest, TasksObserveTheRaceAndTheAwaitingTask) {
+  auto tp = coro::ThreadPool::makeShared(coro::ThreadPool::Options {.threadCount_ = 2});
+
+  // The loser is not handed a token, it observes the race through this_task::stop_requested().
+  auto make_task = [&tp](bool winner) -> coro::Task<bool> {
+    if (winner) { co_return true; }
+    while (!co_await coro::this_task::stop_requested()) { co_await tp->yield(); }
+    co_return false;
+  };
+  auto [index, value] = coro::sync_wait(coro::when_any(*tp, std::stop_source {}, make_task(false), make_task(true)));
+  EXPECT_EQ(index, 1);
+  EXPECT_TRUE(value);
+
+  // Stopping the awaiting task stops the whole race, the first task to notice wins.
+  std::stop_source parentSource {};
+  auto parent = [&]() -> coro::Task<bool> {
+    auto [index, value] = co_await coro::when_any(*tp, std::stop_source {}, make_task(false), make_task(false));
+    co_return value;
+  };
+  auto task = parent();
+  task.promise().stop_token(parentSource.get_token());
+  parentSource.request_stop();
+  EXPECT_FALSE(coro::sync_wait(task));
+  tp->shutdown();
+}